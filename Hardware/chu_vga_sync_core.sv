@@ -1,3 +1,20 @@
+/*======================================================================
+-- Description: vga sync core (video slot #0)
+-- Design:
+--   * line buffer plus vga sync controller
+--   * read-only status register (word 0) on the display raster:
+--       bit 10..0  : vcount (0..524; 480 and above is vertical blanking)
+--       bit 11     : vblank
+--       bit 31..16 : frame count, incremented when vblank starts
+--   * the raster status only changes at the start of a line, so it is
+--     captured once per line in the clk_25M domain and a toggle flags
+--     the new word; the toggle crosses to clk_sys through a 2-ff
+--     synchronizer (ASYNC_REG) and its edge loads the clk_sys status
+--     register; the captured word is then stable for a whole line
+--     (800 pixel clocks), so no bit of the bus is sampled while it
+--     changes; the word is readable 1 pixel clock + 3 sys clocks after
+--     the line starts
+--====================================================================*/
 module chu_vga_sync_core 
    #(parameter CD = 12)
    (
@@ -9,6 +26,7 @@ module chu_vga_sync_core
     input  logic write,  
     input  logic [13:0] addr,    
     input  logic [31:0] wr_data,
+    output logic [31:0] rd_data,
     // 
     input  logic [CD:0] si_data,
     input  logic si_valid,
@@ -18,9 +36,18 @@ module chu_vga_sync_core
     output logic[CD-1:0] rgb
    );
 
+   // constant declaration
+   localparam VD = 480;  // vertical display area
    // signal delaration
    logic line_so_valid, vga_si_ready;
    logic [CD:0] line_so_data;
+   logic [10:0] hcount, vcount;
+   logic [15:0] frame_cnt_reg, frame_cnt_next;
+   logic [31:0] line_status_reg;
+   logic line_tgl_reg;
+   (* ASYNC_REG = "TRUE" *) logic [1:0] tgl_sync_reg;
+   logic tgl_last_reg;
+   logic [31:0] status_reg;
 
    // body
    // instantiate line buffer
@@ -44,6 +71,38 @@ module chu_vga_sync_core
     .vga_si_ready(vga_si_ready),
     .hsync(hsync),
     .vsync(vsync),
-    .rgb(rgb)
+    .rgb(rgb),
+    .hcount(hcount),
+    .vcount(vcount)
    );
+   // raster status in the pixel clock domain, captured at the start
+   // of every line (vcount already holds the new line)
+   assign frame_cnt_next = (vcount == VD) ? frame_cnt_reg + 1 : frame_cnt_reg;
+   always_ff @(posedge clk_25M, posedge reset)
+      if (reset) begin
+         frame_cnt_reg <= 0;
+         line_status_reg <= 0;
+         line_tgl_reg <= 0;
+      end
+      else if (hcount == 0) begin
+         frame_cnt_reg <= frame_cnt_next;
+         line_status_reg <= {frame_cnt_next, 4'b0000, (vcount >= VD), vcount};
+         line_tgl_reg <= ~line_tgl_reg;
+      end
+   // status register in the system clock domain: 2-ff synchronizer of
+   // the toggle, load the stable line word on its edge
+   always_ff @(posedge clk_sys, posedge reset)
+      if (reset) begin
+         tgl_sync_reg <= 0;
+         tgl_last_reg <= 0;
+         status_reg <= 0;
+      end
+      else begin
+         tgl_sync_reg <= {tgl_sync_reg[0], line_tgl_reg};
+         tgl_last_reg <= tgl_sync_reg[1];
+         if (tgl_sync_reg[1] != tgl_last_reg)
+            status_reg <= line_status_reg;
+      end
+   // read data (only the status register; address ignored)
+   assign rd_data = status_reg;
 endmodule
\ No newline at end of file
@@ -9,20 +9,21 @@ module chu_video_controller (
    output logic [19:0] frame_addr,
    output logic [31:0] frame_wr_data,
    // MM video core slot interface
-   output logic [7:0] slot_cs_array,     
-   output logic [7:0] slot_mem_wr_array, 
-   output logic [13:0] slot_reg_addr_array [7:0],
-   output logic [31:0] slot_wr_data_array [7:0]
+   output logic [15:0] slot_cs_array,     
+   output logic [15:0] slot_mem_wr_array, 
+   output logic [13:0] slot_reg_addr_array [15:0],
+   output logic [31:0] slot_wr_data_array [15:0]
 );
 
    // signal declaration
-   logic [2:0] slot_addr;
+   logic [3:0] slot_addr;
    logic [13:0] reg_addr;
-   logic [7:0] slot_cs_tmp;
+   logic [15:0] slot_cs_tmp;
    logic [31:0] slot_rd_data_array [63:0];
 
    // body
-   assign slot_addr = video_addr[16:14];
+   // 16 slots: V8_POWERUP and up need bit 17
+   assign slot_addr = video_addr[17:14];
    assign reg_addr = video_addr[13:0];
    assign frame_cs = video_cs & video_addr[20];
    assign slot_cs = video_cs & ~video_addr[20];
@@ -42,7 +43,7 @@ module chu_video_controller (
    // broadcast to all video slots 
    generate
       genvar i;
-      for (i=0; i<8; i=i+1) begin
+      for (i=0; i<16; i=i+1) begin
          assign slot_mem_wr_array[i] = video_wr;
          assign slot_wr_data_array[i] = video_wr_data;
          assign slot_reg_addr_array[i] = reg_addr;
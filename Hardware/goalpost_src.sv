@@ -15,8 +15,8 @@ module goalpost_src #(
   localparam H_SIZE = 8, V_SIZE = 80;
 
   // compute position within the square
-  logic signed [11:0] xr = x - x0, yr = y - y0;
-  logic in_region = xr>=0 && xr<H_SIZE && yr>=0 && yr<V_SIZE;
+  wire signed [11:0] xr = x - x0, yr = y - y0;
+  wire in_region = xr>=0 && xr<H_SIZE && yr>=0 && yr<V_SIZE;
 
   // --- address for 88 RAM: 3 bits of Y, 3 bits of X ---
   logic [ADDR-1:0] addr_r;
@@ -43,7 +43,7 @@ module goalpost_src #(
   end
 
   // only draw inside the 648 square
-  logic [11:0] out_rgb = in_region ? full_rgb : KEY_COLOR;
+  wire [11:0] out_rgb = in_region ? full_rgb : KEY_COLOR;
   always_ff @(posedge clk) sprite_rgb <= out_rgb;
 
 endmodule
\ No newline at end of file
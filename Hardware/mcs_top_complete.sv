@@ -61,6 +61,7 @@ module mcs_top_complete
    logic [31:0] fp_wr_data;    
    logic [31:0] fp_rd_data;    
    logic fp_video_cs; 
+   logic [31:0] mmio_rd_data, video_rd_data;
    // pwm 
    logic [7:0] pwm; 
    // ddfs/audio pdm 
@@ -129,6 +130,9 @@ module mcs_top_complete
     .fp_rd_data(fp_rd_data)
     );   
     
+   // read data: video subsystem (sync status) or mmio subsystem
+   assign fp_rd_data = fp_video_cs ? video_rd_data : mmio_rd_data;
+
    // instantiated i/o subsystem
    mmio_sys_sampler #(.N_SW(16),.N_LED(16)) mmio_unit (
     .clk(clk_100M),
@@ -138,7 +142,7 @@ module mcs_top_complete
     .mmio_rd(fp_rd),
     .mmio_addr(fp_addr), 
     .mmio_wr_data(fp_wr_data),
-    .mmio_rd_data(fp_rd_data),
+    .mmio_rd_data(mmio_rd_data),
     .acl_ss(acl_ss_n),          
     .*  
    );   
@@ -152,6 +156,7 @@ module mcs_top_complete
      .video_wr(fp_wr),
      .video_addr(fp_addr),
      .video_wr_data(fp_wr_data),
+     .video_rd_data(video_rd_data),
      .vsync(vsync),
      .hsync(hsync),
      .rgb(rgb)
@@ -50,7 +50,7 @@ module player2_src
 
   // build the 10-bit base index within a single 3232 frame
   // (yr << 5) + xr = yr*32 + xr
-  logic [ADDR-2:0] base_idx = {yr[4:0], xr[4:0]};
+  wire [ADDR-2:0] base_idx = {yr[4:0], xr[4:0]};
 
   // prepend sel as the MSB to pick frame 0 or frame 1
   // addr_r = sel1024 + base_idx
@@ -17,9 +17,9 @@ module powerup_src #(
   localparam V_SIZE = 16;
 
   // compute relative position
-  logic signed [11:0] xr = x - x0;
-  logic signed [11:0] yr = y - y0;
-  logic in_region = (xr >= 0 && xr < H_SIZE && yr >= 0 && yr < V_SIZE);
+  wire signed [11:0] xr = x - x0;
+  wire signed [11:0] yr = y - y0;
+  wire in_region = (xr >= 0 && xr < H_SIZE && yr >= 0 && yr < V_SIZE);
 
   // build 8-bit read address: 4 bits of Y (yr), 4 bits of X (xr)
   logic [ADDR-1:0] addr_r;
@@ -52,7 +52,7 @@ module powerup_src #(
   end
 
   // final output: inside region
-  logic [CD-1:0] out_rgb = in_region ? full_rgb : KEY_COLOR;
+  wire [CD-1:0] out_rgb = in_region ? full_rgb : KEY_COLOR;
   always_ff @(posedge clk) sprite_rgb <= out_rgb;
 
 endmodule
@@ -15,12 +15,12 @@ module vga_sprite_goalpost_core
    );
 
    // decode writes
-   logic wr_en    = write & cs;
-   logic wr_ram   = ~addr[13] & wr_en;
-   logic wr_reg   =  addr[13] & wr_en;
-   logic wr_bypass= wr_reg && (addr[1:0]==2'b00);
-   logic wr_x0    = wr_reg && (addr[1:0]==2'b01);
-   logic wr_y0    = wr_reg && (addr[1:0]==2'b10);
+   wire wr_en    = write & cs;
+   wire wr_ram   = ~addr[13] & wr_en;
+   wire wr_reg   =  addr[13] & wr_en;
+   wire wr_bypass= wr_reg && (addr[1:0]==2'b00);
+   wire wr_x0    = wr_reg && (addr[1:0]==2'b01);
+   wire wr_y0    = wr_reg && (addr[1:0]==2'b10);
 
    // regs for sprite origin & bypass
    logic [10:0] x0_reg, y0_reg;
@@ -56,7 +56,7 @@ module vga_sprite_goalpost_core
    );
 
    // chroma-key/blend with background
-   logic [CD-1:0] chrom_rgb = (goalpost_rgb != KEY_COLOR) ? goalpost_rgb : si_rgb;
+   wire [CD-1:0] chrom_rgb = (goalpost_rgb != KEY_COLOR) ? goalpost_rgb : si_rgb;
    assign so_rgb = bypass_reg ? si_rgb : chrom_rgb;
 
 endmodule
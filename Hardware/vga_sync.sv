@@ -15,7 +15,9 @@ module vga_sync
     output logic vga_si_ready,
     // to vga monitor
     output logic hsync, vsync,
-    output logic[CD-1:0] rgb
+    output logic[CD-1:0] rgb,
+    // raster position (for the sync core status register)
+    output logic[10:0] hcount, vcount
    );
 
    // localparam declaration
@@ -115,4 +117,6 @@ module vga_sync
    assign vsync = vsync_reg;
    assign rgb = rgb_reg;
    assign vga_si_ready = vga_si_ready_i;   
+   assign hcount = x;
+   assign vcount = y;
 endmodule
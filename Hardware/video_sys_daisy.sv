@@ -14,6 +14,9 @@
 --    * 1_000 0000 xxxx xxxx xxxx xx00 (video slot #0, vga sync)
 --    * 1_000 0001 xxxx xxxx xxxx xx00 (video slot #1, mouse)
 --    * 1_000 0011 xxxx xxxx xxxx xx00 (video slot #3, bar)
+--    ** read back: video_rd_data returns the vga sync core status
+--       register (slot #0, held in the clk_sys domain by the core);
+--       other video addresses are write-only
 */
 
 `include "chu_io_map.svh"
@@ -31,6 +34,7 @@ module video_sys_daisy
    input logic video_wr,
    input logic [20:0] video_addr, 
    input logic [31:0] video_wr_data,
+   output logic [31:0] video_rd_data,
    // to vga monitor  
    output logic vsync, hsync,
    output logic [11:0] rgb 
@@ -53,10 +57,11 @@ module video_sys_daisy
    logic [19:0] frame_addr;
    logic [31:0] frame_wr_data;
    // video core slot interface 
-   logic [7:0] slot_cs_array;
-   logic [7:0] slot_mem_wr_array;
-   logic [13:0] slot_reg_addr_array [7:0];
-   logic [31:0] slot_wr_data_array [7:0];
+   logic [15:0] slot_cs_array;
+   logic [15:0] slot_mem_wr_array;
+   logic [13:0] slot_reg_addr_array [15:0];
+   logic [31:0] slot_wr_data_array [15:0];
+   logic [31:0] sync_rd_data;
    
    // 2-stage delay line for start signal
    always_ff @(posedge clk_sys) begin
@@ -223,6 +228,8 @@ v21_powerup_unit (
       .so_rgb(osd_rgb0)
    );
 
+   // read back: only the vga sync core (slot #0) has readable registers
+   assign video_rd_data = sync_rd_data;
    // merge start signal to rgb data stream
    assign line_data_in = {osd_rgb0, frame_start_d2_reg};
    // instantiate sync_core
@@ -234,6 +241,7 @@ v21_powerup_unit (
       .write(slot_mem_wr_array[`V0_SYNC]),
       .addr(slot_reg_addr_array[`V0_SYNC]),
       .wr_data(slot_wr_data_array[`V0_SYNC]),
+      .rd_data(sync_rd_data),
       .si_data(line_data_in),
       .si_valid(inc_d2_reg),
       .si_ready(inc),
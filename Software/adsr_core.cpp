@@ -9,9 +9,13 @@
 
 #include "adsr_core.h"
 
-AdsrCore::AdsrCore(uint32_t adsr_base_addr, DdfsCore *ddfs) {
+AdsrCore::AdsrCore(uint32_t adsr_base_addr, DdfsCore *ddfs) :
+      env_cache(0, 0, 0, 0, 0.0) {
    base_addr = adsr_base_addr;
    _ddfs = ddfs;
+   reg_valid = 0;
+   env_key[0] = env_key[1] = env_key[2] = -2;   // no cached envelope
+   env_key_level = -1.0;
    init();
    select_env(1);
 }
@@ -45,14 +49,14 @@ void AdsrCore::start() {
 void AdsrCore::abort() {
    // write 0 to attack register
    // ams = STOP_PATTERN;
-   io_write(base_addr, ATK_REG, (uint32_t )STOP_PATTERN);
+   wr_reg(ATK_REG, (uint32_t )STOP_PATTERN);
    //write_adsr_reg();
 }
 
 
 void AdsrCore::bypass() {
    ams = BYPASS_PATTERN;
-   io_write(base_addr, ATK_REG, (uint32_t )BYPASS_PATTERN);
+   wr_reg(ATK_REG, (uint32_t )BYPASS_PATTERN);
    // write_adsr_reg();
 }
 
@@ -66,16 +70,36 @@ void AdsrCore::set_env(int attack_ms, int decay_ms, int sustain_ms, int release_
 }
 
 
+void AdsrCore::set_env(const AdsrEnv &env) {
+   if (env.special) {
+      wr_reg(ATK_REG, env.atk);
+      return;
+   }
+   wr_reg(SUS_LEVEL_REG, env.level);
+   wr_reg(ATK_REG, env.atk);
+   wr_reg(DCY_REG, env.dcy);
+   wr_reg(SUS_REG, env.sus);
+   wr_reg(REL_REG, env.rel);
+}
+
 void AdsrCore::select_env(int n) {
+   // predefined envelopes are converted at compile time
+   static constexpr AdsrEnv env1(100, 50, 100, 50, 0.9);
+   static constexpr AdsrEnv env2(10, 50, 100, 100, 0.9);
+   static constexpr AdsrEnv env3(10, 200, 100, 100, 0.1);
+
    switch (n) {
    case 1:
-      set_env(100, 50, 100, 50, 0.9);
+      ams = 100; dms = 50; sms = 100; rms = 50; slevel = 0.9;
+      set_env(env1);
       break;
    case 2:
-      set_env(10, 50, 100, 100, 0.9);
+      ams = 10; dms = 50; sms = 100; rms = 100; slevel = 0.9;
+      set_env(env2);
       break;
    default:
-      set_env(10, 200, 100, 100, 0.1);
+      ams = 10; dms = 200; sms = 100; rms = 100; slevel = 0.1;
+      set_env(env3);
       break;
    }
    return;
@@ -83,10 +107,8 @@ void AdsrCore::select_env(int n) {
 
 void AdsrCore::play_note(int note, int oct, int dur) {
    int sus_tmp;
-   int freq;
 
-   freq = calc_note_freq(oct, note);
-   _ddfs->set_carrier_freq(freq);
+   _ddfs->set_carrier_fcw(calc_note_fcw(oct, note));
 
    sus_tmp = dur - (ams + dms + rms);
    if (sus_tmp <= 0) {
@@ -96,71 +118,59 @@ void AdsrCore::play_note(int note, int oct, int dur) {
    set_env(ams, dms, sus_tmp, rms, slevel);
    // start envelope
    //wait_pwm_0_crossing();
-   io_write(base_addr, START_REG, 0);
+   start();
 }
 
 
 int AdsrCore::calc_note_freq(int oct, int ni) {
-   // frequency table for octave 0
-   const float NOTES[] = { 16.3516,   //  0 C
-         17.3239,   //  1 C#
-         18.3541,   //  2 D
-         19.4454,   //  3 D#
-         20.6017,   //  4 E
-         21.8268,   //  5 F
-         23.1247,   //  6 F#
-         24.4997,   //  7 G
-         25.9565,   //  8 G#
-         27.5000,   //  9 A
-         29.1352,   // 10 A#
-         30.8677    // 11 B
+   // frequency table for octave 0 in 1/1024 Hz
+   const uint32_t NOTES[] = { 16744,   //  0 C  16.3516
+         17740,   //  1 C#  17.3239
+         18795,   //  2 D   18.3541
+         19912,   //  3 D#  19.4454
+         21096,   //  4 E   20.6017
+         22351,   //  5 F   21.8268
+         23680,   //  6 F#  23.1247
+         25088,   //  7 G   24.4997
+         26579,   //  8 G#  25.9565
+         28160,   //  9 A   27.5000
+         29834,   // 10 A#  29.1352
+         31609    // 11 B   30.8677
          };
    int freq;
 
-   // frequency in octave i: (f in oct 0)*2^i
-   freq = (unsigned int) NOTES[ni] * (1 << oct);
+   // frequency in octave i: (f in oct 0)*2^i, rounded after the scaling
+   freq = (int) (((NOTES[ni] << oct) + 512) >> 10);
    return (freq);
 }
 
+uint32_t AdsrCore::calc_note_fcw(int oct, int ni) {
+   return (NOTE_FCW[oct * NOTE_PER_OCTAVE + ni]);
+}
+
 void AdsrCore::write_adsr_reg() {
-   uint32_t nc, step, sus_abs;
    //# clocks per ms = 0.001 / (1/(SYS_CLK_FREQ*1000000))
    const uint32_t clks = SYS_CLK_FREQ * 1000;
 
-   if (ams == BYPASS_PATTERN) {
-      io_write(base_addr, ATK_REG, (uint32_t )BYPASS_PATTERN);
-      return;
-   }
-   if (ams == STOP_PATTERN) {
-      io_write(base_addr, ATK_REG, (uint32_t )STOP_PATTERN);
-      return;
+   // step words only depend on attack/decay/release/level; reuse the
+   // previous conversion when they match (sustain is a multiply)
+   if (ams != env_key[0] || dms != env_key[1] || rms != env_key[2] ||
+         slevel != env_key_level) {
+      env_cache = AdsrEnv(ams, dms, sms, rms, slevel);
+      env_key[0] = ams;
+      env_key[1] = dms;
+      env_key[2] = rms;
+      env_key_level = slevel;
+      debug("adsr set - sus_level/atk_step: ", env_cache.level, env_cache.atk);
    }
-
-   // convert sustain level in absolute value
-   sus_abs = (unsigned int) MAX * slevel;
-   io_write(base_addr, SUS_LEVEL_REG, (uint32_t )sus_abs);
-   // convert attack time (in ms) into envelope increment step
-   nc = ams * clks;
-   step = MAX / nc;              // increment step
-   if (step == 0)
-      step = 1;
-   io_write(base_addr, ATK_REG, (uint32_t )step);
-   debug("adsr set - sus_level/atk_step: ", sus_abs, step);
-   // convert decay time (in ms) into envelope decrement step
-   nc = dms * clks;
-   step = (MAX - sus_abs) / nc;
-   if (step == 0)
-      step = 1;
-   io_write(base_addr, DCY_REG, (uint32_t )step);
-   // convert sustain time (in ms) into #clocks
-   nc = sms * clks;
-   io_write(base_addr, SUS_REG, (uint32_t )nc);
-   debug("adsr set - sus_time/dcy_step: ", nc, step);
-   // convert release time (in ms) into envelope decrement step
-   nc = rms * clks;
-   step = sus_abs / nc;
-   if (step == 0)
-      step = 1;
-   io_write(base_addr, REL_REG, (uint32_t )step);
+   env_cache.sus = (uint32_t) sms * clks;
+   set_env(env_cache);
 }
 
+void AdsrCore::wr_reg(int reg, uint32_t data) {
+   if (bit_read(reg_valid, reg) && reg_cache[reg] == data)
+      return;
+   io_write(base_addr, reg, data);
+   reg_cache[reg] = data;
+   bit_set(reg_valid, reg);
+}
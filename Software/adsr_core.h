@@ -12,12 +12,52 @@
 
 #include "chu_init.h"
 #include "ddfs_core.h"
+#include "note_table.h"
+
+/**
+ * adsr register words for one envelope
+ *  - conversion (ms/level to step/clock counts) done in constructor
+ *  - constructor is constexpr: a constant envelope costs no
+ *    divisions at run time
+ *  - attack_ms 0 (stop) / -1 (bypass) only affect the attack register
+ */
+struct AdsrEnv {
+   enum {
+      AMAX = 0x7fffffff,              /**< max amplitude level */
+      CLKS_PER_MS = SYS_CLK_FREQ * 1000
+   };
+   uint32_t atk, dcy, sus, rel, level;  // ATK/DCY/SUS/REL/SUS_LEVEL words
+   bool special;                        // stop/bypass pattern
+
+   constexpr AdsrEnv(int attack_ms, int decay_ms, int sustain_ms, int release_ms,
+         float sus_level) :
+         atk(attack_ms == 0 ? 0u :
+             attack_ms == -1 ? 0xffffffffu : step(AMAX, attack_ms)),
+         dcy(step(AMAX - level_word(sus_level), decay_ms)),
+         sus((uint32_t) sustain_ms * CLKS_PER_MS),
+         rel(step(level_word(sus_level), release_ms)),
+         level(level_word(sus_level)),
+         special(attack_ms == 0 || attack_ms == -1) {}
+
+   /* sustain level in absolute value */
+   static constexpr uint32_t level_word(float sus_level) {
+      return (uint32_t) ((float) AMAX * sus_level);
+   }
+
+   /* envelope increment/decrement per clock to cover span in ms */
+   static constexpr uint32_t step(uint32_t span, int ms) {
+      return (ms <= 0) ? span :
+             (span / ((uint32_t) ms * CLKS_PER_MS) == 0) ? 1 :
+             span / ((uint32_t) ms * CLKS_PER_MS);
+   }
+};
 
 /**
  * adsr core driver:
  *  - configure and control MMIO adsr core.
  *  - play a music note.
  *  - an adsr core must be connected to a ddfs core in hardware.
+ *  - register writes are cached; unchanged registers are not rewritten
  */
 class AdsrCore {
 public:
@@ -96,6 +136,15 @@ public:
     */
    void set_env(int attack_ms, int decay_ms, int sustain_ms, int release_ms, float sus_level);
 
+   /**
+    * set a precomputed adsr envelope
+    *
+    * @param env envelope register words
+    *
+    * @note only registers that differ from the last written values are written
+    */
+   void set_env(const AdsrEnv &env);
+
    /**
     * select a predefined envelope
     *
@@ -115,6 +164,16 @@ public:
     */
    int calc_note_freq(int oct, int ni);
 
+   /**
+    * look up the ddfs frequency control word of a music note
+    *
+    * @param oct octave # (0 to 8)
+    * @param ni note (0 to 11 for C, C#, D, ..., B)
+    *
+    * @return fcw of the note (from the compile-time table)
+    */
+   uint32_t calc_note_fcw(int oct, int ni);
+
    /**
     * play a music note for dur millisecond
     *
@@ -135,8 +194,16 @@ private:
    float slevel;
    /* DDFS instance */
    DdfsCore *_ddfs;
+   /* last written register values (bit n of reg_valid: reg n known) */
+   uint32_t reg_cache[SUS_LEVEL_REG + 1];
+   uint32_t reg_valid;
+   /* last converted envelope, reused while attack/decay/release/level match */
+   AdsrEnv env_cache;
+   int env_key[3];
+   float env_key_level;
    /* method */
    void write_adsr_reg();
+   void wr_reg(int reg, uint32_t data);
 };
 #endif  // _ADSR_H_INCLUDED
 
@@ -1,93 +1,219 @@
 // audio_manager.cpp
 #include "audio_manager.h"
-#include "chu_init.h"       // for sleep_ms
-#include <cmath>            // for fabs
+#include "chu_init.h"       // for now_ms
 
 // ========== Static Core Pointers ==========
 static DdfsCore* ddfs = nullptr;
 static AdsrCore* adsr = nullptr;
 
+// ========== Voice Allocation ==========
+// The DDFS/ADSR pair is a single voice shared by three channels; a higher
+// channel index preempts a lower one:
+//   CH_MUSIC  async song (start_song)
+//   CH_SEQ    queued notes (play_note: countdown, goal tune, themes)
+//   CH_SFX    one-shot effects (kick, collision)
+// A preempted channel is ducked: its note clock stops, and when the voice
+// frees up the note is retriggered for the time it had left, so music
+// resumes in step instead of mid-note.
+enum { CH_MUSIC = 0, CH_SEQ, CH_SFX, NUM_CHANNELS };
+enum { NO_OWNER = -1 };
+static const unsigned long MIN_RESUME_MS = 40;  // shorter leftovers stay silent
+
+struct Channel {
+    NoteCmd note;            // current note
+    unsigned long left_ms;   // time left on the current note
+    bool active;             // channel has a current note
+};
+static Channel chan[NUM_CHANNELS];
+static int voice_owner = NO_OWNER;
+static int sfx_prio = 0;     // priority of the sounding effect
+static unsigned long last_tick_ms = 0;
+
+// ========== Sequencer State ==========
+// Ring of pending notes for CH_SEQ
+static NoteCmd note_queue[NOTE_QUEUE_LEN];
+static int queue_head = 0;
+static int queue_count = 0;
+
+// ========== Song Playback State ==========
+static Song* current_song = nullptr;
+static int current_song_len = 0;
+static int song_index = 0;
+static bool song_done = true;
+static bool song_loop = false;
+
 // ========== Initialization ==========
 void init_audio(DdfsCore* ddfs_core, AdsrCore* adsr_core) {
     ddfs = ddfs_core;
     adsr = adsr_core;
+    last_tick_ms = now_ms();
 }
 
-// ========== Basic Note Playback ==========
-void play_note(double freq, int duration_ms, int attack, int decay, int sustain, int release, float level) {
-    ddfs->set_carrier_freq((int)freq);
-    int sustain_time = (sustain == -1) ? (duration_ms - (attack + decay + release)) : sustain;
-    if (sustain_time < 0) sustain_time = 0;
-    adsr->set_env(attack, decay, sustain_time, release, level);
+// Program the voice with a channel's note; a resumed note keeps its
+// envelope shape but only sustains for the time it has left
+static void voice_play(int ch) {
+    const NoteCmd& n = chan[ch].note;
+    int sustain = n.sustain;
+
+    if (n.fcw == REST)
+        return;
+    if (chan[ch].left_ms < (unsigned long)n.duration) {
+        sustain = (int)chan[ch].left_ms - (n.attack + n.decay + n.release);
+        if (sustain < 0) sustain = 0;
+    }
+    ddfs->set_carrier_fcw(n.fcw);
+    adsr->set_env(n.attack, n.decay, sustain, n.release, n.level);
     adsr->start();
-    sleep_ms(duration_ms);
 }
 
-void play_smash_note(double freq, int duration_ms) {
-    if (freq == REST) {
-        sleep_ms(duration_ms);
+// Give the free voice to the highest active channel
+static void voice_reassign() {
+    voice_owner = NO_OWNER;
+    for (int ch = NUM_CHANNELS - 1; ch >= 0; ch--) {
+        if (!chan[ch].active)
+            continue;
+        voice_owner = ch;
+        if (chan[ch].left_ms >= MIN_RESUME_MS)
+            voice_play(ch);
+        return;
+    }
+}
+
+static void channel_start(int ch, const NoteCmd& n) {
+    chan[ch].note = n;
+    chan[ch].left_ms = n.duration;
+    chan[ch].active = true;
+    if (voice_owner > ch)
+        return;                 // ducked until the higher channel is done
+    voice_owner = ch;
+    voice_play(ch);
+}
+
+static void channel_stop(int ch) {
+    chan[ch].active = false;
+    if (voice_owner == ch)
+        voice_reassign();
+}
+
+static NoteCmd song_note(int i) {
+    int dur = current_song[i].duration;
+    int sustain_time = (dur - 30 > 0) ? dur - 30 : 5;
+    NoteCmd n = { current_song[i].fcw, dur, 5, 10, sustain_time, 20, 0.8f };
+    return n;
+}
+
+// Load the channel's next note once the current one has run out
+static void channel_next(int ch) {
+    switch (ch) {
+    case CH_SEQ:
+        if (queue_count == 0) {
+            channel_stop(ch);
+            return;
+        }
+        channel_start(ch, note_queue[queue_head]);
+        queue_head = (queue_head + 1) % NOTE_QUEUE_LEN;
+        queue_count--;
+        return;
+    case CH_MUSIC:
+        song_index++;
+        if (song_index >= current_song_len) {
+            if (!song_loop) {
+                song_done = true;
+                channel_stop(ch);
+                return;
+            }
+            song_index = 0;
+        }
+        channel_start(ch, song_note(song_index));
+        return;
+    default:
+        channel_stop(ch);
+        return;
+    }
+}
+
+// Run a channel's note clock; ducked channels are frozen. Returns the
+// part of dt_ms left after the channel ran out of notes
+static unsigned long channel_advance(int ch, unsigned long dt_ms) {
+    while (chan[ch].active) {
+        if (voice_owner > ch)
+            return 0;
+        if (dt_ms < chan[ch].left_ms) {
+            chan[ch].left_ms -= dt_ms;
+            return 0;
+        }
+        dt_ms -= chan[ch].left_ms;   // overshoot carries into the next note
+        chan[ch].left_ms = 0;
+        channel_next(ch);
+    }
+    return dt_ms;
+}
+
+// ========== Basic Note Playback ==========
+static void enqueue_note(const NoteCmd& cmd) {
+    if (!chan[CH_SEQ].active) {
+        channel_start(CH_SEQ, cmd);
         return;
     }
+    if (queue_count == NOTE_QUEUE_LEN)
+        return;                          // full: drop rather than block
+    note_queue[(queue_head + queue_count) % NOTE_QUEUE_LEN] = cmd;
+    queue_count++;
+}
+
+void play_note(uint32_t fcw, int duration_ms, int attack, int decay, int sustain, int release, float level) {
+    int sustain_time = (sustain == -1) ? (duration_ms - (attack + decay + release)) : sustain;
+    if (sustain_time < 0) sustain_time = 0;
+    NoteCmd cmd = { fcw, duration_ms, attack, decay, sustain_time, release, level };
+    enqueue_note(cmd);
+}
+
+void play_smash_note(uint32_t fcw, int duration_ms) {
     int attack = 2, decay = 2, release = 10;
     int sustain = duration_ms - (attack + decay + release);
     if (sustain < 0) sustain = 0;
-    ddfs->set_carrier_freq((int)freq);
-    adsr->set_env(attack, decay, sustain, release, 0.9);
-    adsr->start();
-    while (!adsr->idle()) sleep_ms(1);
+    NoteCmd cmd = { fcw, duration_ms, attack, decay, sustain, release, 0.9f };
+    enqueue_note(cmd);
 }
 
-// ========== Song Playback State ==========
-static Song* current_song = nullptr;
-static int current_song_len = 0;
-static int song_index = 0;
-static unsigned long note_start_time = 0;
-static bool note_playing = false;
-static bool song_done = true;
-static bool song_loop = false;
+// ========== Sequencer ==========
+void audio_update(unsigned long dt_ms) {
+    // highest channel first, so a voice freed this update is handed down;
+    // a channel it ducked only runs for the part of dt_ms after that
+    for (int ch = NUM_CHANNELS - 1; ch >= 0; ch--)
+        dt_ms = channel_advance(ch, dt_ms);
+}
 
+void audio_tick() {
+    unsigned long now = now_ms();
+    audio_update(now - last_tick_ms);
+    last_tick_ms = now;
+}
+
+bool audio_busy() {
+    return chan[CH_SEQ].active || queue_count > 0;
+}
+
+void audio_clear() {
+    queue_head = queue_count = 0;
+    channel_stop(CH_SEQ);
+}
+
+// ========== Async Song Playback ==========
 void start_song(Song* song_array, int song_length, bool loop) {
     current_song = song_array;
     current_song_len = song_length;
     song_index = 0;
-    note_playing = false;
-    song_done = false;
     song_loop = loop;
+    song_done = (song_array == nullptr || song_length <= 0);
+    if (song_done)
+        channel_stop(CH_MUSIC);
+    else
+        channel_start(CH_MUSIC, song_note(0));
 }
 
 void play_song_tick() {
-    if (song_done || current_song == nullptr || current_song_len <= 0)
-        return;
-
-    unsigned long now = now_ms();
-
-    if (!note_playing) {
-        int freq = current_song[song_index].freq;
-        int dur  = current_song[song_index].duration;
-
-        if (freq != REST) {
-            int sustain_time = (dur - 30 > 0) ? dur - 30 : 5;
-            ddfs->set_carrier_freq(freq);
-            adsr->set_env(5, 10, sustain_time, 20, 0.8);
-            adsr->start();
-        }
-
-        note_start_time = now;
-        note_playing = true;
-    } else {
-        int dur = current_song[song_index].duration;
-        if ((now - note_start_time) >= (unsigned long)dur) {
-            song_index++;
-            note_playing = false;
-
-            if (song_index >= current_song_len) {
-                if (song_loop)
-                    song_index = 0;
-                else
-                    song_done = true;
-            }
-        }
-    }
+    audio_tick();
 }
 
 bool is_song_done() {
@@ -95,16 +221,22 @@ bool is_song_done() {
 }
 
 // ========== Sound Effects ==========
+// An effect preempts music and queued notes; a new effect retriggers the
+// voice unless a higher-priority effect is still sounding
+static void play_sfx(int prio, uint32_t fcw, int attack, int decay, int release) {
+    if (chan[CH_SFX].active && prio < sfx_prio)
+        return;
+    sfx_prio = prio;
+    NoteCmd n = { fcw, attack + decay + release, attack, decay, 0, release, 1.0f };
+    channel_start(CH_SFX, n);
+}
+
 void play_collision_sound() {
-    ddfs->set_carrier_freq(NOTE_C4);
-    adsr->set_env(5, 10, 0, 50, 1.0);
-    adsr->start();
+    play_sfx(SFX_PRIO_COLLISION, NOTE_C4, 5, 10, 50);
 }
 
 void play_kick_sound() {
-    ddfs->set_carrier_freq(NOTE_C5);
-    adsr->set_env(5, 15, 0, 60, 1.0);
-    adsr->start();
+    play_sfx(SFX_PRIO_KICK, NOTE_C5, 5, 15, 60);
 }
 
 void play_countdown_beep(int n) {
@@ -4,50 +4,53 @@
 #include "chu_init.h"
 #include "ddfs_core.h"
 #include "adsr_core.h"
+#include "note_table.h"
 
 // ========== 3 Octave Chromatic Range (C3 to D6) ==========
-#define NOTE_C3   131
-#define NOTE_CS3  139
-#define NOTE_D3   147
-#define NOTE_DS3  156
-#define NOTE_E3   165
-#define NOTE_F3   175
-#define NOTE_FS3  185
-#define NOTE_G3   196
-#define NOTE_GS3  208
-#define NOTE_A3   220
-#define NOTE_AS3  233
-#define NOTE_B3   247
-
-#define NOTE_C4   262
-#define NOTE_CS4  277
-#define NOTE_D4   294
-#define NOTE_DS4  311
-#define NOTE_E4   330
-#define NOTE_F4   349
-#define NOTE_FS4  370
-#define NOTE_G4   392
-#define NOTE_GS4  415
-#define NOTE_A4   440
-#define NOTE_AS4  466
-#define NOTE_B4   494
-
-#define NOTE_C5   523
-#define NOTE_CS5  554
-#define NOTE_D5   587
-#define NOTE_DS5  622
-#define NOTE_E5   659
-#define NOTE_F5   698
-#define NOTE_FS5  740
-#define NOTE_G5   784
-#define NOTE_GS5  831
-#define NOTE_A5   880
-#define NOTE_AS5  932
-#define NOTE_B5   988
-
-#define NOTE_C6   1047
-#define NOTE_CS6  1109
-#define NOTE_D6   1175
+// DDFS frequency control words; constexpr, so they are compile-time
+// constants at any optimization level (note_table.h)
+constexpr uint32_t NOTE_C3  = note_fcw(3,  0);
+constexpr uint32_t NOTE_CS3 = note_fcw(3,  1);
+constexpr uint32_t NOTE_D3  = note_fcw(3,  2);
+constexpr uint32_t NOTE_DS3 = note_fcw(3,  3);
+constexpr uint32_t NOTE_E3  = note_fcw(3,  4);
+constexpr uint32_t NOTE_F3  = note_fcw(3,  5);
+constexpr uint32_t NOTE_FS3 = note_fcw(3,  6);
+constexpr uint32_t NOTE_G3  = note_fcw(3,  7);
+constexpr uint32_t NOTE_GS3 = note_fcw(3,  8);
+constexpr uint32_t NOTE_A3  = note_fcw(3,  9);
+constexpr uint32_t NOTE_AS3 = note_fcw(3, 10);
+constexpr uint32_t NOTE_B3  = note_fcw(3, 11);
+
+constexpr uint32_t NOTE_C4  = note_fcw(4,  0);
+constexpr uint32_t NOTE_CS4 = note_fcw(4,  1);
+constexpr uint32_t NOTE_D4  = note_fcw(4,  2);
+constexpr uint32_t NOTE_DS4 = note_fcw(4,  3);
+constexpr uint32_t NOTE_E4  = note_fcw(4,  4);
+constexpr uint32_t NOTE_F4  = note_fcw(4,  5);
+constexpr uint32_t NOTE_FS4 = note_fcw(4,  6);
+constexpr uint32_t NOTE_G4  = note_fcw(4,  7);
+constexpr uint32_t NOTE_GS4 = note_fcw(4,  8);
+constexpr uint32_t NOTE_A4  = note_fcw(4,  9);
+constexpr uint32_t NOTE_AS4 = note_fcw(4, 10);
+constexpr uint32_t NOTE_B4  = note_fcw(4, 11);
+
+constexpr uint32_t NOTE_C5  = note_fcw(5,  0);
+constexpr uint32_t NOTE_CS5 = note_fcw(5,  1);
+constexpr uint32_t NOTE_D5  = note_fcw(5,  2);
+constexpr uint32_t NOTE_DS5 = note_fcw(5,  3);
+constexpr uint32_t NOTE_E5  = note_fcw(5,  4);
+constexpr uint32_t NOTE_F5  = note_fcw(5,  5);
+constexpr uint32_t NOTE_FS5 = note_fcw(5,  6);
+constexpr uint32_t NOTE_G5  = note_fcw(5,  7);
+constexpr uint32_t NOTE_GS5 = note_fcw(5,  8);
+constexpr uint32_t NOTE_A5  = note_fcw(5,  9);
+constexpr uint32_t NOTE_AS5 = note_fcw(5, 10);
+constexpr uint32_t NOTE_B5  = note_fcw(5, 11);
+
+constexpr uint32_t NOTE_C6  = note_fcw(6,  0);
+constexpr uint32_t NOTE_CS6 = note_fcw(6,  1);
+constexpr uint32_t NOTE_D6  = note_fcw(6,  2);
 
 #define REST      0
 
@@ -60,16 +63,40 @@
 
 #define ARRAY_LEN(x) (sizeof(x) / sizeof((x)[0]))
 
+#define NOTE_QUEUE_LEN 16   // notes the sequencer can hold
+
+// ========== Effect Priorities ==========
+// a sounding effect is only cut off by one of equal or higher priority
+#define SFX_PRIO_COLLISION 1
+#define SFX_PRIO_KICK      2
+
 // ========== Song Struct ==========
+// fcw: NOTE_* frequency control word (REST for silence); duration in ms
 struct Song {
-    int freq;
+    uint32_t fcw;
     int duration;
 };
 
+// ========== Sequencer Command ==========
+// One queued note: envelope parameters plus how long it owns the voice
+struct NoteCmd {
+    uint32_t fcw;                      // NOTE_* fcw, REST for silence
+    int duration;                      // ms until the next queued note
+    int attack, decay, sustain, release;
+    float level;
+};
+
 // ========== Audio Control ==========
 void init_audio(DdfsCore* ddfs_core, AdsrCore* adsr_core);
-void play_note(double freq, int duration_ms, int attack = 10, int decay = 10, int sustain = -1, int release = 100, float level = 0.8);
-void play_smash_note(double freq, int duration_ms);
+// play_note()/play_smash_note() queue the note and return immediately
+void play_note(uint32_t fcw, int duration_ms, int attack = 10, int decay = 10, int sustain = -1, int release = 100, float level = 0.8);
+void play_smash_note(uint32_t fcw, int duration_ms);
+
+// ========== Sequencer ==========
+void audio_update(unsigned long dt_ms);  // advance queued notes and song by dt_ms
+void audio_tick();                       // audio_update() with the time since the last call
+bool audio_busy();                       // a queued note is still sounding/pending
+void audio_clear();                      // drop all queued notes
 
 // ========== Sound Effects ==========
 void play_kick_sound();
@@ -78,8 +105,9 @@ void play_goal_tune();
 void play_countdown_beep(int n);
 
 // ========== Async Song Playback ==========
+// music yields the voice to queued notes and effects, then resumes in step
 void start_song(Song* song_array, int song_length, bool should_loop);
-void play_song_tick();  // Call repeatedly inside main loop
+void play_song_tick();  // same as audio_tick()
 bool is_song_done();
 
 // ========== Song Data ==========
@@ -11,6 +11,7 @@
 
 
 #include "chu_init.h"
+#include "tick_div.h"
 
 /**********************************************************************
  * basic uart and timer functions
@@ -24,14 +25,24 @@
 TimerCore _sys_timer(get_slot_addr(BRIDGE_BASE, TIMER_SLOT));
 UartCore uart(get_slot_addr(BRIDGE_BASE, UART_SLOT));
 
+// current system time in clocks
+uint64_t now_tick() {
+   return (_sys_timer.read_tick());
+}
+
+// current system time in clocks (lower 32 bits)
+uint32_t now_tick32() {
+   return (_sys_timer.read_tick32());
+}
+
 // current system time in microsecond
 unsigned long now_us() {
    return ((unsigned long) _sys_timer.read_time());
 }
 
-// current system time in ms
+// current system time in ms (us count is below 2^42: no 64-bit divide)
 unsigned long now_ms() {
-   return ((unsigned long) _sys_timer.read_time() / 1000);
+   return ((unsigned long) UsToMs::div64(_sys_timer.read_time()));
 }
 
 // idle for t microseconds
@@ -45,6 +45,18 @@ extern "C" {
 #define TIMER_SLOT 0
 #define UART_SLOT 1
 
+/**
+ * Current system "up time" in system clocks.
+ */
+uint64_t now_tick();
+
+/**
+ * Lower 32 bits of the system "up time" in system clocks.
+ * @note single bus read; wraps every 2^32 clocks, so use only for
+ *  differences ((uint32_t) (t1 - t0) is wrap-safe)
+ */
+uint32_t now_tick32();
+
 /**
  * Current system "up time" in microsecond.
  */
@@ -96,9 +108,13 @@ void debug_on(const char *str, int n1, int n2);
 
 #ifndef _DEBUG
 #define debug(str, n1, n2) debug_off()
-#endif // not _DEBUG#ifdef _DEBUG
+#endif // not _DEBUG
+
+#ifdef _DEBUG
 #define debug(str, n1, n2) debug_on((str), (n1), (n2))
-#endif // not _DEBUG#ifdef __cplusplus
+#endif // not _DEBUG
+
+#ifdef __cplusplus
 } // extern "C"
 #endif
 
@@ -45,6 +45,69 @@ extern "C" {
    (*(volatile uint32_t *)((base_addr) + 4*(offset)) = (data))
 
 #endif  // _VENDOR_IO_ACCESS_USED
+
+/**********************************************************************
+ * block write access
+ *  - write n consecutive 32-bit words starting at offset
+ *  - byte address computed once; 4-way unrolled inner loop
+ *  - falls back to io_write() when vendor macros are used
+ *********************************************************************/
+
+/**
+ * write a block of consecutive io words
+ * @param base_addr base address of an io core
+ * @param offset word offset of the first word
+ * @param data source buffer
+ * @param n number of words
+ */
+static inline void io_write_block(uint32_t base_addr, uint32_t offset,
+                                  const uint32_t *data, int n) {
+#ifndef _VENDOR_IO_ACCESS_USED
+   volatile uint32_t *p = (volatile uint32_t *)(base_addr + 4*offset);
+
+   for (; n >= 4; n -= 4, p += 4, data += 4) {
+      p[0] = data[0];
+      p[1] = data[1];
+      p[2] = data[2];
+      p[3] = data[3];
+   }
+   for (; n > 0; n--)
+      *p++ = *data++;
+#else
+   int i;
+
+   for (i = 0; i < n; i++)
+      io_write(base_addr, offset + i, data[i]);
+#endif
+}
+
+/**
+ * fill a block of consecutive io words with one value
+ * @param base_addr base address of an io core
+ * @param offset word offset of the first word
+ * @param data value to be written
+ * @param n number of words
+ */
+static inline void io_fill_block(uint32_t base_addr, uint32_t offset,
+                                 uint32_t data, int n) {
+#ifndef _VENDOR_IO_ACCESS_USED
+   volatile uint32_t *p = (volatile uint32_t *)(base_addr + 4*offset);
+
+   for (; n >= 4; n -= 4, p += 4) {
+      p[0] = data;
+      p[1] = data;
+      p[2] = data;
+      p[3] = data;
+   }
+   for (; n > 0; n--)
+      *p++ = data;
+#else
+   int i;
+
+   for (i = 0; i < n; i++)
+      io_write(base_addr, offset + i, data);
+#endif
+}
 /**
  * calculate base address of a memory mapped io slot.
  * @param base base-address of FPro system.
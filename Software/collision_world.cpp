@@ -0,0 +1,279 @@
+/*****************************************************************//**
+ * @file collision_world.cpp
+ *
+ * @brief implementation of the collision world
+ *
+ ********************************************************************/
+
+#include "collision_world.h"
+
+static const phys_t ZERO(0);
+static const phys_t ONE(1);
+
+static inline phys_t sign_of(phys_t d) {
+   return (d >= ZERO) ? ONE : -ONE;
+}
+
+static inline phys_t clamp(phys_t v, phys_t lo, phys_t hi) {
+   return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+/**********************************************************************
+ * narrowphase (normal from the first shape to the second)
+ *********************************************************************/
+static bool circle_circle(phys_t ax, phys_t ay, phys_t ar, phys_t bx,
+      phys_t by, phys_t br, CollisionWorld::Contact *c) {
+   phys_t dx = bx - ax;
+   phys_t dy = by - ay;
+   phys_t rs = ar + br;
+   phys_t d2, dist;
+
+   // far apart on either axis (also keeps dx*dx in Q16.16 range)
+   if (fx_abs(dx) >= rs || fx_abs(dy) >= rs)
+      return (false);
+   d2 = dx * dx + dy * dy;
+   if (d2 >= rs * rs)
+      return (false);
+   dist = fx_sqrt(d2);
+   if (dist > ZERO) {
+      fx_unit(dx, dy, dist, c->nx, c->ny);
+   } else {
+      c->nx = ONE;
+      c->ny = ZERO;
+   }
+   c->depth = rs - dist;
+   return (true);
+}
+
+static bool box_circle(phys_t bx, phys_t by, phys_t bw, phys_t bh,
+      phys_t ccx, phys_t ccy, phys_t r, CollisionWorld::Contact *c) {
+   phys_t dx = ccx - clamp(ccx, bx - bw, bx + bw);
+   phys_t dy = ccy - clamp(ccy, by - bh, by + bh);
+   phys_t d2, dist, ox, oy;
+
+   if (fx_abs(dx) >= r || fx_abs(dy) >= r)
+      return (false);
+   d2 = dx * dx + dy * dy;
+   if (d2 >= r * r)
+      return (false);
+   dist = fx_sqrt(d2);
+   if (dist > ZERO) {
+      fx_unit(dx, dy, dist, c->nx, c->ny);
+      c->depth = r - dist;
+      return (true);
+   }
+   // center inside the box: push out along the shallower axis
+   ox = bw + r - fx_abs(ccx - bx);
+   oy = bh + r - fx_abs(ccy - by);
+   if (ox < oy) {
+      c->nx = sign_of(ccx - bx);
+      c->ny = ZERO;
+      c->depth = ox;
+   } else {
+      c->nx = ZERO;
+      c->ny = sign_of(ccy - by);
+      c->depth = oy;
+   }
+   return (true);
+}
+
+static bool box_box(phys_t ax, phys_t ay, phys_t aw, phys_t ah, phys_t bx,
+      phys_t by, phys_t bw, phys_t bh, CollisionWorld::Contact *c) {
+   phys_t dx = bx - ax;
+   phys_t dy = by - ay;
+   phys_t ox = aw + bw - fx_abs(dx);
+   phys_t oy = ah + bh - fx_abs(dy);
+
+   if (ox <= ZERO || oy <= ZERO)
+      return (false);
+   if (ox < oy) {
+      c->nx = sign_of(dx);
+      c->ny = ZERO;
+      c->depth = ox;
+   } else {
+      c->nx = ZERO;
+      c->ny = sign_of(dy);
+      c->depth = oy;
+   }
+   return (true);
+}
+
+/**********************************************************************
+ * CollisionWorld
+ *********************************************************************/
+CollisionWorld::CollisionWorld() {
+   clear();
+}
+
+CollisionWorld::~CollisionWorld() {
+}
+
+void CollisionWorld::clear() {
+   n_entities = 0;
+   n_contacts = 0;
+   n_tested = 0;
+}
+
+int CollisionWorld::add(phys_t x, phys_t y, phys_t w, phys_t h, int s,
+      int f, int m, uint32_t l, uint32_t k) {
+   int id = n_entities;
+
+   if (id == MAX_ENTITIES)
+      return (-1);
+   cx[id] = x;
+   cy[id] = y;
+   hw[id] = w;
+   hh[id] = h;
+   shape[id] = (uint8_t) s;
+   flags[id] = (uint8_t) (f | COLL_ACTIVE);
+   mass[id] = (uint8_t) m;
+   layer[id] = l;
+   mask[id] = k;
+   order[id] = (uint16_t) id;
+   n_entities++;
+   return (id);
+}
+
+int CollisionWorld::add_circle(phys_t x, phys_t y, phys_t r, int f, int m,
+      uint32_t l, uint32_t k) {
+   return (add(x, y, r, r, SHAPE_CIRCLE, f, m, l, k));
+}
+
+int CollisionWorld::add_box(phys_t x, phys_t y, phys_t w, phys_t h, int f,
+      int m, uint32_t l, uint32_t k) {
+   return (add(x, y, w, h, SHAPE_BOX, f, m, l, k));
+}
+
+void CollisionWorld::set_active(int id, bool on) {
+   if (on)
+      flags[id] |= COLL_ACTIVE;
+   else
+      flags[id] &= ~COLL_ACTIVE;
+}
+
+// insertion sort by left edge, ties by id; nearly sorted from the
+// previous step.  The tie rule makes the order (and so the resolution
+// order) a function of the positions alone, not of earlier calls:
+// a rolled-back state re-simulates exactly.
+void CollisionWorld::sort_axis() {
+   int i, j;
+   uint16_t id, p;
+   phys_t key, pkey;
+
+   for (i = 1; i < n_entities; i++) {
+      id = order[i];
+      key = cx[id] - hw[id];
+      for (j = i; j > 0; j--) {
+         p = order[j - 1];
+         pkey = cx[p] - hw[p];
+         if (pkey < key || (pkey == key && p < id))
+            break;
+         order[j] = p;
+      }
+      order[j] = id;
+   }
+}
+
+bool CollisionWorld::overlap(int a, int b, Contact *c) const {
+   bool hit;
+
+   if (shape[a] == SHAPE_CIRCLE && shape[b] == SHAPE_CIRCLE)
+      return (circle_circle(cx[a], cy[a], hw[a], cx[b], cy[b], hw[b], c));
+   if (shape[a] == SHAPE_BOX && shape[b] == SHAPE_BOX)
+      return (box_box(cx[a], cy[a], hw[a], hh[a], cx[b], cy[b], hw[b], hh[b], c));
+   if (shape[a] == SHAPE_BOX)
+      return (box_circle(cx[a], cy[a], hw[a], hh[a], cx[b], cy[b], hw[b], c));
+   // circle a, box b: the normal comes out from b
+   hit = box_circle(cx[b], cy[b], hw[b], hh[b], cx[a], cy[a], hw[a], c);
+   c->nx = -c->nx;
+   c->ny = -c->ny;
+   return (hit);
+}
+
+void CollisionWorld::resolve(const Contact &c) {
+   int a = c.a, b = c.b;
+   bool sa = (flags[a] & COLL_STATIC) != 0;
+   bool sb = (flags[b] & COLL_STATIC) != 0;
+   bool move_a, move_b;
+   phys_t push = c.depth;
+
+   if ((flags[a] | flags[b]) & COLL_SENSOR)
+      return;
+   if (sa || (!sb && mass[a] > mass[b])) {
+      move_a = false;         // b is pushed out fully
+      move_b = true;
+   } else if (sb || mass[b] > mass[a]) {
+      move_a = true;
+      move_b = false;
+   } else {
+      move_a = move_b = true;
+      push = c.depth / 2;
+   }
+   if (move_a) {
+      cx[a] -= c.nx * push;
+      cy[a] -= c.ny * push;
+   }
+   if (move_b) {
+      cx[b] += c.nx * push;
+      cy[b] += c.ny * push;
+   }
+}
+
+int CollisionWorld::probe(int id) const {
+   int j;
+   Contact c;
+
+   for (j = 0; j < n_entities; j++) {
+      if (j == id || !(flags[j] & COLL_ACTIVE) || (flags[j] & COLL_SENSOR))
+         continue;
+      if (!(layer[id] & mask[j]) || !(layer[j] & mask[id]))
+         continue;
+      if (fx_abs(cx[j] - cx[id]) >= hw[id] + hw[j]
+            || fx_abs(cy[j] - cy[id]) >= hh[id] + hh[j])
+         continue;
+      if (overlap(id, j, &c))
+         return (j);
+   }
+   return (-1);
+}
+
+int CollisionWorld::collide() {
+   int i, j, a, b, total = 0;
+   phys_t right;
+   Contact c;
+
+   sort_axis();
+   n_contacts = 0;
+   n_tested = 0;
+   for (i = 0; i < n_entities; i++) {
+      a = order[i];
+      if (!(flags[a] & COLL_ACTIVE))
+         continue;
+      right = cx[a] + hw[a];
+      for (j = i + 1; j < n_entities; j++) {
+         b = order[j];
+         // sweep ends at the first entity starting right of a
+         if (cx[b] - hw[b] > right)
+            break;
+         if (!(flags[b] & COLL_ACTIVE))
+            continue;
+         if (!(layer[a] & mask[b]) || !(layer[b] & mask[a]))
+            continue;
+         if (flags[a] & flags[b] & COLL_STATIC)
+            continue;
+         if (fx_abs(cy[b] - cy[a]) >= hh[a] + hh[b])
+            continue;
+         n_tested++;
+         // lower id first, so callers see a stable pair order
+         c.a = (uint16_t) ((a < b) ? a : b);
+         c.b = (uint16_t) ((a < b) ? b : a);
+         if (!overlap(c.a, c.b, &c))
+            continue;
+         total++;
+         if (n_contacts < MAX_CONTACTS)
+            list[n_contacts++] = c;
+         resolve(c);
+      }
+   }
+   return (total);
+}
@@ -0,0 +1,186 @@
+/*****************************************************************//**
+ * @file collision_world.h
+ *
+ * @brief multi-body collision detection and positional resolution
+ *
+ * Description:
+ *  - entities live in a fixed table stored as a structure of arrays
+ *    (center, half extents, shape, flags, layer/mask); no heap
+ *  - shapes: circle (half width = radius) and axis-aligned box
+ *  - broadphase: sort and sweep on the x axis; the order from the
+ *    previous call is re-sorted by insertion sort, which is close to
+ *    linear when entities move little between steps; equal edges sort
+ *    by id, so results do not depend on the call history
+ *  - narrowphase: circle/circle, circle/box and box/box
+ *  - cost of a contact with a circle: fx_sqrt() (shifts and adds)
+ *    and fx_unit() for the normal (one 32-bit divide, two multiplies);
+ *    no 64-bit divide, box/box contacts take no divide at all
+ *  - a pair is tested only if each layer is in the other's mask
+ *  - resolution: overlapping entities are pushed apart along the
+ *    contact normal; a static entity never moves, a heavier mass
+ *    class pushes a lighter one out fully, equal classes share the
+ *    push; sensors only report the overlap
+ *  - velocity response is left to the caller (contact list)
+ *  - scalar is phys_t (Q16.16 by default), same as game_physics
+ *  - COLL_MAX_ENTITIES/COLL_MAX_CONTACTS size the tables; the host
+ *    benchmark (sim/bench_collision.cpp) builds with larger values
+ *
+ ********************************************************************/
+
+#ifndef _COLLISION_WORLD_H_INCLUDED
+#define _COLLISION_WORLD_H_INCLUDED
+
+#include "game_physics.h"
+
+#ifndef COLL_MAX_ENTITIES
+#define COLL_MAX_ENTITIES 16
+#endif
+#ifndef COLL_MAX_CONTACTS
+#define COLL_MAX_CONTACTS 32
+#endif
+
+/**
+ * collision world:
+ *  - add entities once, then each step: set_pos(), collide(),
+ *    read back pos_x()/pos_y() and the contact list
+ */
+class CollisionWorld {
+public:
+   /**
+    * symbolic constants
+    */
+   enum {
+      MAX_ENTITIES = COLL_MAX_ENTITIES,
+      MAX_CONTACTS = COLL_MAX_CONTACTS
+   };
+   /**
+    * shapes
+    */
+   enum {
+      SHAPE_CIRCLE = 0,
+      SHAPE_BOX = 1
+   };
+   /**
+    * entity flags
+    */
+   enum {
+      COLL_ACTIVE = 0x01,   /**< takes part in collide() */
+      COLL_STATIC = 0x02,   /**< never moved by a contact */
+      COLL_SENSOR = 0x04    /**< overlap reported, not resolved */
+   };
+
+   /**
+    * one resolved (or sensed) overlap
+    *  - normal points from a to b; depth is the overlap before the push
+    */
+   struct Contact {
+      uint16_t a, b;
+      phys_t nx, ny;
+      phys_t depth;
+   };
+
+   CollisionWorld();
+   ~CollisionWorld();                  // not used
+
+   /**
+    * remove all entities
+    */
+   void clear();
+
+   /**
+    * add a circle
+    * @param cx x-coordinate of the center
+    * @param cy y-coordinate of the center
+    * @param r radius
+    * @param flags COLL_* flags (COLL_ACTIVE is added)
+    * @param mass mass class (heavier pushes lighter)
+    * @param layer layer bits of this entity
+    * @param mask layers this entity collides with
+    * @return entity id; -1 if the table is full
+    */
+   int add_circle(phys_t cx, phys_t cy, phys_t r, int flags, int mass,
+         uint32_t layer, uint32_t mask);
+
+   /**
+    * add an axis-aligned box
+    * @param cx x-coordinate of the center
+    * @param cy y-coordinate of the center
+    * @param hw half width
+    * @param hh half height
+    * (other parameters as add_circle())
+    * @return entity id; -1 if the table is full
+    */
+   int add_box(phys_t cx, phys_t cy, phys_t hw, phys_t hh, int flags,
+         int mass, uint32_t layer, uint32_t mask);
+
+   /**
+    * include/exclude an entity from collide()
+    */
+   void set_active(int id, bool on);
+
+   /**
+    * move an entity (center)
+    */
+   void set_pos(int id, phys_t x, phys_t y) {
+      cx[id] = x;
+      cy[id] = y;
+   }
+
+   /* entity center */
+   phys_t pos_x(int id) const { return cx[id]; }
+   phys_t pos_y(int id) const { return cy[id]; }
+
+   /**
+    * run broadphase, narrowphase and positional resolution
+    * @return number of contacts (sensor overlaps included)
+    *
+    * @note contacts past MAX_CONTACTS are resolved but not listed
+    */
+   int collide();
+
+   /**
+    * find an entity overlapping the given one (no resolution)
+    * @param id entity id
+    * @return id of the first solid (non-sensor) entity that overlaps;
+    *         -1 if none
+    *
+    * @note linear in the entity count; meant for continuous collision
+    *  substeps of a single fast entity
+    */
+   int probe(int id) const;
+
+   /* contact list of the last collide() */
+   int contacts() const { return n_contacts; }
+   const Contact &contact(int i) const { return list[i]; }
+
+   /* statistics of the last collide() */
+   int pairs_tested() const { return n_tested; }   /**< broadphase pairs */
+   int entities() const { return n_entities; }
+
+private:
+   /* entity state, structure of arrays */
+   phys_t cx[MAX_ENTITIES];
+   phys_t cy[MAX_ENTITIES];
+   phys_t hw[MAX_ENTITIES];        // radius for circles
+   phys_t hh[MAX_ENTITIES];
+   uint32_t layer[MAX_ENTITIES];
+   uint32_t mask[MAX_ENTITIES];
+   uint8_t shape[MAX_ENTITIES];
+   uint8_t flags[MAX_ENTITIES];
+   uint8_t mass[MAX_ENTITIES];
+   /* entity ids sorted by left edge (kept between calls) */
+   uint16_t order[MAX_ENTITIES];
+   int n_entities;
+   /* contacts */
+   Contact list[MAX_CONTACTS];
+   int n_contacts;
+   int n_tested;
+
+   int add(phys_t x, phys_t y, phys_t w, phys_t h, int s, int f, int m,
+         uint32_t l, uint32_t k);
+   void sort_axis();
+   bool overlap(int a, int b, Contact *c) const;
+   void resolve(const Contact &c);
+};
+
+#endif  // _COLLISION_WORLD_H_INCLUDED
@@ -37,6 +37,10 @@ void DdfsCore::set_carrier_freq(int freq) {
    p2n = 1 << PHA_WIDTH;  //2^PHA_WIDTH
    tmp = ((float) p2n) / float(SYS_CLK_FREQ * 1000000);
    fcw = uint32_t(freq * tmp);
+   set_carrier_fcw(fcw);
+}
+
+void DdfsCore::set_carrier_fcw(uint32_t fcw) {
    io_write(base_addr, FCW_REG, fcw);
 }
 
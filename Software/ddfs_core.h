@@ -66,6 +66,15 @@ public:
 	 */
 	void set_carrier_freq(int freq);
 
+	/**
+	 * set ddfs carrier frequency control word
+	 *
+	 * @param fcw frequency control word (f * 2^PHA_WIDTH / system clock)
+	 *
+	 * @note no conversion; use with note_fcw()/hz_to_fcw() constants
+	 */
+	void set_carrier_fcw(uint32_t fcw);
+
 	/**
 	 * set ddfs offset (delta) freq
 	 *
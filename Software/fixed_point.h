@@ -0,0 +1,198 @@
+/*****************************************************************//**
+ * @file fixed_point.h
+ *
+ * @brief signed fixed-point scalar for FPU-less MicroBlaze MCS
+ *
+ * Description:
+ *  - Fixed<F> stores a value as a 32-bit integer scaled by 2^F
+ *  - Q16_16 (F=16) covers +/-32767 with a 1/65536 resolution
+ *  - constructors from double are constexpr; use them only with
+ *    constant arguments so no soft-float code is generated
+ *  - conversion to int truncates toward zero (same as a float cast)
+ *  - fx_unit() scales a vector by 1/length with one 32-bit divide
+ *  - fx_sqrt()/fx_abs()/fx_to_int()/fx_half()/fx_unit() are overloaded
+ *    for float so code written against a scalar typedef builds with
+ *    either type
+ *
+ * Tolerance against float:
+ *  - +, -, compare are exact; *, / truncate to 1/65536
+ *  - fx_sqrt() is exact to 1 LSB (integer square root)
+ *  - fx_unit() is within 3 LSB of x / len (operator/)
+ *  - positions are integers, so a trajectory differs from the float
+ *    build only when an accumulated error crosses a pixel boundary;
+ *    expect at most 1 px per axis at any frame
+ *
+ ********************************************************************/
+
+#ifndef _FIXED_POINT_H_INCLUDED
+#define _FIXED_POINT_H_INCLUDED
+
+#include <inttypes.h>
+#include <cmath>
+
+/**
+ * integer square root.
+ * @param v radicand
+ * @return floor(sqrt(v))
+ * @note bit-by-bit method; shifts and adds only
+ */
+static inline uint32_t isqrt64(uint64_t v) {
+   uint64_t res = 0;
+   uint64_t bit = (uint64_t) 1 << 62;
+
+   while (bit > v)
+      bit >>= 2;
+   while (bit != 0) {
+      if (v >= res + bit) {
+         v -= res + bit;
+         res = (res >> 1) + bit;
+      } else {
+         res >>= 1;
+      }
+      bit >>= 2;
+   }
+   return ((uint32_t) res);
+}
+
+/**
+ * signed fixed-point number with F fractional bits
+ *
+ */
+template<int F>
+class Fixed {
+public:
+   enum {
+      FRAC_BITS = F,          /**< # fractional bits */
+      ONE = 1 << F            /**< raw value of 1.0 */
+   };
+
+   constexpr Fixed() : raw(0) {}
+   constexpr explicit Fixed(int v) : raw((int32_t) (v * ONE)) {}
+   constexpr explicit Fixed(double v) :
+         raw((int32_t) (v * ONE + (v >= 0 ? 0.5 : -0.5))) {}
+
+   /**
+    * build a value from its raw (scaled) representation
+    * @param r raw value
+    */
+   static constexpr Fixed from_raw(int32_t r) {
+      return Fixed(r, 0);
+   }
+
+   /* truncate toward zero, like (int) on a float */
+   explicit operator int() const {
+      return ((raw >= 0) ? (raw >> F) : -((-raw) >> F));
+   }
+
+   Fixed operator-() const { return from_raw(-raw); }
+   Fixed operator+(Fixed b) const { return from_raw(raw + b.raw); }
+   Fixed operator-(Fixed b) const { return from_raw(raw - b.raw); }
+   Fixed operator*(Fixed b) const {
+      return from_raw((int32_t) (((int64_t) raw * b.raw) >> F));
+   }
+   Fixed operator/(Fixed b) const {
+      return from_raw((int32_t) (((int64_t) raw << F) / b.raw));
+   }
+   Fixed operator*(int n) const { return from_raw(raw * n); }
+   Fixed operator/(int n) const { return from_raw(raw / n); }
+
+   Fixed &operator+=(Fixed b) { raw += b.raw; return *this; }
+   Fixed &operator-=(Fixed b) { raw -= b.raw; return *this; }
+   Fixed &operator*=(Fixed b) { *this = *this * b; return *this; }
+
+   bool operator<(Fixed b) const { return raw < b.raw; }
+   bool operator>(Fixed b) const { return raw > b.raw; }
+   bool operator<=(Fixed b) const { return raw <= b.raw; }
+   bool operator>=(Fixed b) const { return raw >= b.raw; }
+   bool operator==(Fixed b) const { return raw == b.raw; }
+   bool operator!=(Fixed b) const { return raw != b.raw; }
+
+   int32_t raw;   // value * 2^F
+
+private:
+   constexpr Fixed(int32_t r, int) : raw(r) {}
+};
+
+typedef Fixed<16> Q16_16;
+
+/**********************************************************************
+ * scalar helpers (float and fixed overloads)
+ *********************************************************************/
+template<int F>
+inline Fixed<F> fx_sqrt(Fixed<F> v) {
+   // sqrt(r/2^F)*2^F = sqrt(r*2^F)
+   if (v.raw <= 0)
+      return Fixed<F>();
+   return Fixed<F>::from_raw((int32_t) isqrt64((uint64_t) v.raw << F));
+}
+
+template<int F>
+inline Fixed<F> fx_abs(Fixed<F> v) {
+   return (v.raw < 0) ? -v : v;
+}
+
+template<int F>
+inline int fx_to_int(Fixed<F> v) {
+   return (int) v;
+}
+
+/* v / 2, rounded down (a shift) */
+template<int F>
+inline Fixed<F> fx_half(Fixed<F> v) {
+   return Fixed<F>::from_raw(v.raw >> 1);
+}
+
+// |x| / (2^(32-F+k) / r), sign of x
+template<int F>
+inline Fixed<F> fx_scale_recip(Fixed<F> x, uint32_t r, int k) {
+   int64_t m = ((int64_t) ((x.raw < 0) ? -x.raw : x.raw) * r) >> (32 - F + k);
+   return Fixed<F>::from_raw((int32_t) ((x.raw < 0) ? -m : m));
+}
+
+/**
+ * unit vector of (x, y).
+ * @param x, y vector; |x|, |y| at most len (a few LSB over is fine)
+ * @param len vector length (> 0)
+ * @param ux, uy x / len, y / len
+ * @note one 32-bit unsigned divide (__udivsi3 on the MCS) for the
+ *       reciprocal of len cut to 16 bits, then two multiplies; two
+ *       operator/ calls would cost two 64-bit divides (__divdi3)
+ */
+template<int F>
+inline void fx_unit(Fixed<F> x, Fixed<F> y, Fixed<F> len, Fixed<F> &ux,
+      Fixed<F> &uy) {
+   uint32_t d = (uint32_t) len.raw;
+   uint32_t r;
+   int k = 0;
+
+   while (d >= 0x10000u) {
+      d >>= 1;
+      k++;
+   }
+   r = 0xffffffffu / d;      // 2^32 / d, at least 2^16
+   ux = fx_scale_recip(x, r, k);
+   uy = fx_scale_recip(y, r, k);
+}
+
+inline float fx_sqrt(float v) {
+   return std::sqrt(v);
+}
+
+inline float fx_abs(float v) {
+   return (v < 0.0f) ? -v : v;
+}
+
+inline int fx_to_int(float v) {
+   return (int) v;
+}
+
+inline float fx_half(float v) {
+   return v * 0.5f;
+}
+
+inline void fx_unit(float x, float y, float len, float &ux, float &uy) {
+   ux = x / len;
+   uy = y / len;
+}
+
+#endif  // _FIXED_POINT_H_INCLUDED
@@ -1,6 +1,6 @@
 #include "game_physics.h"
-#include <cmath>
-#include <cstdlib>
+#include "collision_world.h"
+#include <cstring>
 
 const int SCREEN_W = 640;
 const int SCREEN_H = 480;
@@ -9,131 +9,449 @@ const int BALL_W   = 16, BALL_H   = 16;
 
 
 
-const float GRAVITY = 0.5;       // Pull down per frame
-const float BOUNCE_DAMPING = 0.7; // 70% of velocity kept on bounce
-const float FRICTION = 0.98;     // Slow down horizontal velocity
+const phys_t GRAVITY(0.5);        // Pull down per frame
+const phys_t BOUNCE_DAMPING(0.7); // 70% of velocity kept on bounce
+const phys_t FRICTION(0.98);      // Slow down horizontal velocity
+const phys_t JUMP_VELOCITY(-10.0 * 0.75);
+
+// soft bounce off a player's lower half
+static constexpr phys_t SOFT_BOUNCE_VY(-2.5);
+
+// Fixed physics step; every per-frame constant above is tuned for this
+const int PHYSICS_TICK_MS = 30;
+const int MATCH_DURATION_SEC = 10;
 
 // 40px above bottom is your “invisible line”
 const int GROUND_OFFSET    = 40;
 const int PLAYER_GROUND_Y  = SCREEN_H - GROUND_OFFSET - PLAYER_H;
 const int BALL_GROUND_Y    = SCREEN_H - GROUND_OFFSET - BALL_H;
 
-float p1_vy = 0, p2_vy = 0;
-bool  p1_on_ground = true, p2_on_ground = true;
-int   p1_x = 50, p1_y = PLAYER_GROUND_Y;
-int   p2_x = SCREEN_W - 50 - PLAYER_W, p2_y = PLAYER_GROUND_Y;
-int   ball_x = SCREEN_W/2 - BALL_W/2, ball_y = 0;
-float ball_vx = 0, ball_vy = 0;
-bool  key_state[128] = {false};
+// same geometry as the goalpost sprites drawn by main
+const int GOALPOST_W = 8, GOALPOST_H = 80;
+const int GOALPOST_INSET = 10;
+
+// a goal counts once the ball is fully past a post's inner edge
+static const int GOAL_LEFT_X  = GOALPOST_INSET + GOALPOST_W;
+static const int GOAL_RIGHT_X = SCREEN_W - GOALPOST_INSET - GOALPOST_W;
+
+static const int PLAYER_STEP = 5;     // px per tick while a move key is down
 
 
 extern void play_kick_sound();
 extern void play_collision_sound();
 
-void apply_gravity_and_ground() {
-    // gravity
-    p1_vy += GRAVITY;
-    p2_vy += GRAVITY;
-    p1_y += int(p1_vy);
-    p2_y += int(p2_vy);
-
-    // 40px above‐bottom line
-    if (p1_y >= PLAYER_GROUND_Y) {
-        p1_y = PLAYER_GROUND_Y;
-        p1_vy = 0;
-        p1_on_ground = true;
+// collision geometry (constant, so fixed-point builds fold it at compile time)
+static const phys_t HALF_PLAYER_W(PLAYER_W / 2.0);
+static const phys_t HALF_PLAYER_H(PLAYER_H / 2.0);
+static const phys_t HALF_BALL_W(BALL_W / 2.0);
+static const phys_t HALF_BALL_H(BALL_H / 2.0);
+static const phys_t PLAYER_RADIUS(PLAYER_W / 2.0 * 0.8);
+static const phys_t BALL_RADIUS(BALL_W / 2.0);
+static const phys_t HALF_POST_W(GOALPOST_W / 2.0);
+static const phys_t POWERUP_RADIUS(8.0);
+
+// per entity slot (ENT_*)
+static const int ENT_W[ENT_COUNT] = { PLAYER_W, PLAYER_W, BALL_W };
+static const phys_t HALF_W[ENT_COUNT] = { HALF_PLAYER_W, HALF_PLAYER_W, HALF_BALL_W };
+static const phys_t HALF_H[ENT_COUNT] = { HALF_PLAYER_H, HALF_PLAYER_H, HALF_BALL_H };
+
+// continuous collision: a ball moving more than CCD_STEP px per tick on
+// either axis is moved in substeps of at most CCD_STEP, under half the
+// thinnest solid (post top + ball = 24 px), so it cannot cross a player
+// or a post top between two tests; the first touching substep is then
+// refined by CCD_REFINE bisection steps (1/16 of a substep); the
+// substep count and the bisection take shifts, not divides
+static const int CCD_STEP_SHIFT = 3;
+static const phys_t CCD_STEP(1 << CCD_STEP_SHIFT);   // BALL_W / 2
+static const int CCD_REFINE = 4;
+
+static const uint32_t RNG_DEFAULT_SEED = 0x2545f491;
+
+// ===== Collision world =====
+// layers: posts only stop the ball; the power-up is a sensor
+enum {
+    LAYER_PLAYER  = 1,
+    LAYER_BALL    = 2,
+    LAYER_POST    = 4,
+    LAYER_POWERUP = 8
+};
+// mass classes: a player pushes the ball out, never the other way
+enum {
+    MASS_BALL   = 1,
+    MASS_PLAYER = 2
+};
+
+// scratch for physics_step(): positions are copied in from the state
+// every step, so the world holds nothing a snapshot would need
+static CollisionWorld world;
+static bool world_ready = false;
+static int ent_post1, ent_post2, ent_powerup;
+static int powerup_touch = 0;
+static bool sound_on = true;
+
+static void world_build() {
+    uint32_t player_mask = LAYER_PLAYER | LAYER_BALL | LAYER_POWERUP;
+    uint32_t ball_mask   = LAYER_PLAYER | LAYER_BALL | LAYER_POST | LAYER_POWERUP;
+    // solid top of each post (GOALPOST_W square); the ball passes
+    // below it into the goal
+    phys_t cap_y = phys_t(SCREEN_H - GROUND_OFFSET - GOALPOST_H) + HALF_POST_W;
+    phys_t zero(0);
+
+    // players and ball first, so world ids equal the ENT_* slots
+    world.clear();
+    world.add_circle(zero, zero, PLAYER_RADIUS, 0, MASS_PLAYER, LAYER_PLAYER, player_mask);
+    world.add_circle(zero, zero, PLAYER_RADIUS, 0, MASS_PLAYER, LAYER_PLAYER, player_mask);
+    world.add_circle(zero, zero, BALL_RADIUS, 0, MASS_BALL, LAYER_BALL, ball_mask);
+    ent_post1 = world.add_box(phys_t(GOALPOST_INSET) + HALF_POST_W, cap_y,
+                              HALF_POST_W, HALF_POST_W, CollisionWorld::COLL_STATIC, 0,
+                              LAYER_POST, LAYER_BALL);
+    ent_post2 = world.add_box(phys_t(SCREEN_W - GOALPOST_INSET - GOALPOST_W) + HALF_POST_W, cap_y,
+                              HALF_POST_W, HALF_POST_W, CollisionWorld::COLL_STATIC, 0,
+                              LAYER_POST, LAYER_BALL);
+    ent_powerup = world.add_circle(zero, zero, POWERUP_RADIUS,
+                                   CollisionWorld::COLL_STATIC | CollisionWorld::COLL_SENSOR, 0,
+                                   LAYER_POWERUP, LAYER_PLAYER | LAYER_BALL);
+    world.set_active(ent_powerup, false);
+    world_ready = true;
+}
+
+// copy sprite positions (top-left corners) in as centers
+static void world_sync_in(const GameState &s) {
+    for (int i = 0; i < ENT_COUNT; i++)
+        world.set_pos(i, phys_t(s.x[i]) + HALF_W[i], phys_t(s.y[i]) + HALF_H[i]);
+}
+
+static void world_sync_out(GameState &s) {
+    for (int i = 0; i < ENT_COUNT; i++) {
+        int x = fx_to_int(world.pos_x(i) - HALF_W[i]);
+
+        // a push (player/player, ball/post) must not leave the screen
+        if (x < 0) x = 0;
+        else if (x > SCREEN_W - ENT_W[i]) x = SCREEN_W - ENT_W[i];
+        s.x[i] = x;
+        s.y[i] = fx_to_int(world.pos_y(i) - HALF_H[i]);
+    }
+    // ... nor push a player into the ground
+    if (s.y[ENT_P1] > PLAYER_GROUND_Y) s.y[ENT_P1] = PLAYER_GROUND_Y;
+    if (s.y[ENT_P2] > PLAYER_GROUND_Y) s.y[ENT_P2] = PLAYER_GROUND_Y;
+}
+
+// contact between two entities in the last collide(), or 0
+static const CollisionWorld::Contact *find_contact(int a, int b) {
+    for (int i = 0; i < world.contacts(); i++) {
+        const CollisionWorld::Contact &c = world.contact(i);
+        if ((c.a == a && c.b == b) || (c.a == b && c.b == a))
+            return &c;
+    }
+    return nullptr;
+}
+
+// ===== Match =====
+void game_init(GameState &s, uint32_t seed) {
+    s = GameState();    // value-initialized: every field and pad zero
+    s.rng = seed ? seed : RNG_DEFAULT_SEED;   // xorshift must not hold 0
+    game_reset_positions(s, true);
+}
+
+void game_reset_positions(GameState &s, bool ball_on_ground) {
+    // ball back to center or floor
+    s.x[ENT_BALL] = SCREEN_W / 2 - BALL_W / 2;
+    s.y[ENT_BALL] = ball_on_ground ? BALL_GROUND_Y : (SCREEN_H / 2 - BALL_H / 2);
+    s.vx[ENT_BALL] = phys_t(0);
+    s.vy[ENT_BALL] = phys_t(ball_on_ground ? 0 : 5);
+
+    // players back on ground line
+    s.x[ENT_P1] = 50;
+    s.x[ENT_P2] = SCREEN_W - 50 - PLAYER_W;
+    for (int i = ENT_P1; i <= ENT_P2; i++) {
+        s.y[i] = PLAYER_GROUND_Y;
+        s.vx[i] = s.vy[i] = phys_t(0);
+        s.on_ground[i] = ball_on_ground;
+    }
+}
+
+// move/jump one player; x stays on screen
+static void apply_input(GameState &s, int p, uint8_t in) {
+    if (in & IN_LEFT)  s.x[p] -= PLAYER_STEP;
+    if (in & IN_RIGHT) s.x[p] += PLAYER_STEP;
+    if ((in & IN_JUMP) && s.on_ground[p]) {
+        s.vy[p] = JUMP_VELOCITY;
+        s.on_ground[p] = false;
+    }
+
+    if (s.x[p] < 0) s.x[p] = 0;
+    else if (s.x[p] > SCREEN_W - PLAYER_W) s.x[p] = SCREEN_W - PLAYER_W;
+}
+
+int game_step(GameState &s, uint8_t p1_in, uint8_t p2_in) {
+    int ev = 0;
+
+    apply_input(s, ENT_P1, p1_in);
+    apply_input(s, ENT_P2, p2_in);
+    physics_step(s, (p1_in & IN_KICK) != 0, (p2_in & IN_KICK) != 0);
+    s.match_ms += PHYSICS_TICK_MS;
+    s.tick++;
+
+    // left goal: ball's right edge fully past the left post's inner x;
+    // right goal: ball's left edge fully past the right post's inner x
+    if (s.x[ENT_BALL] + BALL_W < GOAL_LEFT_X) {
+        s.score[1]++;
+        ev = EV_GOAL_P2;
+    } else if (s.x[ENT_BALL] > GOAL_RIGHT_X) {
+        s.score[0]++;
+        ev = EV_GOAL_P1;
     }
-    if (p2_y >= PLAYER_GROUND_Y) {
-        p2_y = PLAYER_GROUND_Y;
-        p2_vy = 0;
-        p2_on_ground = true;
+    if (ev)
+        game_reset_positions(s, false);    // ball starts in air
+
+    // match length counted in ticks so a replay ends on the same one;
+    // a goal on the last tick still counts
+    if (s.match_ms >= (uint32_t)MATCH_DURATION_SEC * 1000)
+        ev |= EV_MATCH_OVER;
+    return ev;
+}
+
+// ===== Physics =====
+void apply_gravity_and_ground(GameState &s) {
+    for (int i = ENT_P1; i <= ENT_P2; i++) {
+        // gravity
+        s.vy[i] += GRAVITY;
+        s.y[i] += fx_to_int(s.vy[i]);
+
+        // 40px above‐bottom line
+        if (s.y[i] >= PLAYER_GROUND_Y) {
+            s.y[i] = PLAYER_GROUND_Y;
+            s.vy[i] = phys_t(0);
+            s.on_ground[i] = true;
+        }
     }
 }
 
 
-void update_ball_motion() {
-    ball_vy += GRAVITY;
-    ball_x += ball_vx;
-    ball_y += ball_vy;
+// ball pixel at position p; on a stop the pixel is rounded along the
+// motion so the contact survives truncation
+static int ball_px(phys_t p, phys_t v, bool stop) {
+    int i = fx_to_int(p);
+
+    if (stop && v > phys_t(0) && phys_t(i) < p)
+        i++;
+    return i;
+}
+
+#ifndef PHYSICS_NO_CCD
+static bool ball_touches(phys_t x, phys_t y) {
+    world.set_pos(ENT_BALL, x + HALF_BALL_W, y + HALF_BALL_H);
+    return world.probe(ENT_BALL) >= 0;
+}
+#endif
+
+// move the ball by one tick of velocity; a fast ball stops at the time
+// of impact with the first player or post top in its path (walls and
+// ground are clamped by the caller, which is exact for them)
+static void move_ball(GameState &s) {
+    phys_t x0(s.x[ENT_BALL]), y0(s.y[ENT_BALL]);
+    phys_t vx = s.vx[ENT_BALL], vy = s.vy[ENT_BALL];
+    phys_t speed = fx_abs(vx);
+
+    if (fx_abs(vy) > speed)
+        speed = fx_abs(vy);
+#ifndef PHYSICS_NO_CCD
+    if (speed > CCD_STEP) {
+        // speed / CCD_STEP + 1 substeps; one divide per axis for the
+        // substep, none per probe
+        int n = (fx_to_int(speed) >> CCD_STEP_SHIFT) + 1;
+        phys_t sx = vx / n, sy = vy / n;
+        phys_t lx = x0, ly = y0;
+
+        if (!world_ready)
+            world_build();
+        world_sync_in(s);    // players are already at their end positions
+        for (int k = 1; k <= n; k++) {
+            phys_t hx = (k == n) ? x0 + vx : lx + sx;
+            phys_t hy = (k == n) ? y0 + vy : ly + sy;
+            if (!ball_touches(hx, hy)) {
+                lx = hx;
+                ly = hy;
+                continue;
+            }
+            // halve the substep CCD_REFINE times
+            for (int r = 0; r < CCD_REFINE; r++) {
+                phys_t mx = fx_half(lx + hx), my = fx_half(ly + hy);
+                if (ball_touches(mx, my)) {
+                    hx = mx;
+                    hy = my;
+                } else {
+                    lx = mx;
+                    ly = my;
+                }
+            }
+            s.x[ENT_BALL] = ball_px(hx, vx, true);
+            s.y[ENT_BALL] = ball_px(hy, vy, true);
+            return;
+        }
+    }
+#endif
+    s.x[ENT_BALL] = ball_px(x0 + vx, vx, false);
+    s.y[ENT_BALL] = ball_px(y0 + vy, vy, false);
+}
+
+void update_ball_motion(GameState &s) {
+    s.vy[ENT_BALL] += GRAVITY;
+    move_ball(s);
 
     // bounce off your new ground line
-    if (ball_y >= BALL_GROUND_Y) {
-        ball_y = BALL_GROUND_Y;
-        ball_vy *= -BOUNCE_DAMPING;
-        if (std::fabs(ball_vy) < 1.0f) ball_vy = 0;
+    if (s.y[ENT_BALL] >= BALL_GROUND_Y) {
+        s.y[ENT_BALL] = BALL_GROUND_Y;
+        s.vy[ENT_BALL] *= -BOUNCE_DAMPING;
+        if (fx_abs(s.vy[ENT_BALL]) < phys_t(1)) s.vy[ENT_BALL] = phys_t(0);
     }
     // Wall bounce
-    if (ball_x <= 0) {
-        ball_x = 0;
-        ball_vx *= -BOUNCE_DAMPING;
-    } else if (ball_x + BALL_W >= 640) {
-        ball_x = 640 - BALL_W;
-        ball_vx *= -BOUNCE_DAMPING;
+    if (s.x[ENT_BALL] <= 0) {
+        s.x[ENT_BALL] = 0;
+        s.vx[ENT_BALL] *= -BOUNCE_DAMPING;
+    } else if (s.x[ENT_BALL] + BALL_W >= 640) {
+        s.x[ENT_BALL] = 640 - BALL_W;
+        s.vx[ENT_BALL] *= -BOUNCE_DAMPING;
     }
 
     // Friction
-    ball_vx *= FRICTION;
+    s.vx[ENT_BALL] *= FRICTION;
 }
 
-// in game_physics.cpp or wherever your collision lives:
-void handle_player_ball_collision(int p_x, int p_y, bool is_kicking,
-                                  unsigned long now, unsigned long& last_collision_time,
-                                  int player_id)
+// Ball/player contact response; the world has already pushed the ball
+// out along the normal (player -> ball)
+static void ball_player_response(GameState &s, const CollisionWorld::Contact &c,
+                                 int p, bool is_kicking)
 {
-    // --- 1) compute centers & radii (same as before) ---
-    float cx_p = p_x + PLAYER_W/2.0f;
-    float cy_p = p_y + PLAYER_H/2.0f;
-    float cx_b = ball_x + BALL_W/2.0f;
-    float cy_b = ball_y + BALL_H/2.0f;
-
-    float r_p = (PLAYER_W/2.0f) * 0.8f;
-    float r_b = BALL_W/2.0f;
-
-    float dx = cx_b - cx_p;
-    float dy = cy_b - cy_p;
-    float dist2 = dx*dx + dy*dy;
-    float radSum = r_p + r_b;
-
-    // --- 2) circle‐circle overlap test ---
-    if (dist2 < radSum*radSum) {
-        float dist = std::sqrt(dist2);
-        float nx = (dist > 0.0f ? dx/dist : 1.0f);
-        float ny = (dist > 0.0f ? dy/dist : 0.0f);
-
-        // --- 3) resolve penetration so ball can't tunnel through ---
-        float overlap = radSum - dist;
-        cx_b += nx * overlap;
-        cy_b += ny * overlap;
-        ball_x = int(cx_b - BALL_W/2.0f);
-        ball_y = int(cy_b - BALL_H/2.0f);
-
-        // --- 4) decide kick vs. bounce ---
-        float dir = (nx >= 0) ? 1.0f : -1.0f;
-
-        // only allow a kick if:
-        //  - key is down
-        //  - AND for P1: dx >= 0  (ball on their right)
-        //    for P2: dx <= 0  (ball on their left)
-        bool inner_hit = (player_id == 1 && dx >= 0) ||
-                         (player_id == 2 && dx <= 0);
-
-        if (is_kicking && inner_hit) {
-            // strong, inner‐side kick
-            ball_vx = 15.0f * dir + ((rand() % 3) - 1);
-            ball_vy = -6.0f;
-            play_kick_sound();
-        }
-        else if (now - last_collision_time > 200) {
-            // normal bounce when not a valid kick
-            if (ball_y < p_y + 5) {
-                ball_vx = 3.0f * dir;
-                ball_vy = -6.0f;
-            } else {
-                ball_vx = 2.0f * dir;
-                ball_vy = -2.5f;
-            }
-            play_collision_sound();
-            last_collision_time = now;
+    phys_t zero(0);
+    int dir = (c.nx >= zero) ? 1 : -1;
+
+    // only allow a kick if:
+    //  - key is down
+    //  - AND for P1: ball on their right
+    //    for P2: ball on their left
+    bool inner_hit = (p == ENT_P1 && c.nx >= zero) ||
+                     (p == ENT_P2 && c.nx <= zero);
+
+    if (is_kicking && inner_hit) {
+        // strong, inner‐side kick
+        s.vx[ENT_BALL] = phys_t(15 * dir + ((phys_rand(s) % 3) - 1));
+        s.vy[ENT_BALL] = phys_t(-6);
+        if (sound_on) play_kick_sound();
+    }
+    else if (s.match_ms - s.last_hit_ms[p] > 200) {
+        // normal bounce when not a valid kick
+        if (s.y[ENT_BALL] < s.y[p] + 5) {
+            s.vx[ENT_BALL] = phys_t(3 * dir);
+            s.vy[ENT_BALL] = phys_t(-6);
+        } else {
+            s.vx[ENT_BALL] = phys_t(2 * dir);
+            s.vy[ENT_BALL] = SOFT_BOUNCE_VY;
         }
+        if (sound_on) play_collision_sound();
+        s.last_hit_ms[p] = s.match_ms;
+    }
+}
+
+// Ball/post-top contact: reflect the velocity component into the post
+static void ball_post_response(GameState &s, const CollisionWorld::Contact &c)
+{
+    // normal points from the ball (lower id) to the post
+    phys_t vn = s.vx[ENT_BALL] * c.nx + s.vy[ENT_BALL] * c.ny;
+
+    if (vn > phys_t(0)) {
+        phys_t j = vn + vn * BOUNCE_DAMPING;
+        s.vx[ENT_BALL] -= c.nx * j;
+        s.vy[ENT_BALL] -= c.ny * j;
+        if (sound_on) play_collision_sound();
+    }
+}
+
+void physics_step(GameState &s, bool p1_kicking, bool p2_kicking)
+{
+    const CollisionWorld::Contact *c;
+
+    if (!world_ready)
+        world_build();
+    apply_gravity_and_ground(s);
+    update_ball_motion(s);
+
+    world_sync_in(s);
+    world.collide();
+    world_sync_out(s);
+
+    // player 1 first, as the ball may touch both in one step
+    if ((c = find_contact(ENT_P1, ENT_BALL)) != nullptr)
+        ball_player_response(s, *c, ENT_P1, p1_kicking);
+    if ((c = find_contact(ENT_P2, ENT_BALL)) != nullptr)
+        ball_player_response(s, *c, ENT_P2, p2_kicking);
+    if ((c = find_contact(ENT_BALL, ent_post1)) != nullptr)
+        ball_post_response(s, *c);
+    if ((c = find_contact(ENT_BALL, ent_post2)) != nullptr)
+        ball_post_response(s, *c);
+
+    powerup_touch = 0;
+    if (find_contact(ENT_P1, ent_powerup)) powerup_touch |= 1;
+    if (find_contact(ENT_P2, ent_powerup)) powerup_touch |= 2;
+    if (find_contact(ENT_BALL, ent_powerup)) powerup_touch |= 4;
+}
+
+void physics_powerup(bool on, int x, int y) {
+    if (!world_ready)
+        world_build();
+    world.set_pos(ent_powerup, phys_t(x) + POWERUP_RADIUS, phys_t(y) + POWERUP_RADIUS);
+    world.set_active(ent_powerup, on);
+}
+
+int physics_powerup_touch() {
+    return powerup_touch;
+}
+
+void physics_sound(bool on) {
+    sound_on = on;
+}
+
+// ===== Deterministic RNG (xorshift32) =====
+int phys_rand(GameState &s) {
+    uint32_t x = s.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s.rng = x;
+    return (int)(x >> 1);
+}
+
+// ===== State hash =====
+static inline uint32_t fnv_word(uint32_t h, uint32_t w) {
+    for (int i = 0; i < 4; i++) {
+        h ^= (w >> (8 * i)) & 0xff;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline uint32_t phys_bits(Q16_16 v) {
+    return (uint32_t)v.raw;
+}
+
+static inline uint32_t phys_bits(float v) {
+    uint32_t w;
+    memcpy(&w, &v, sizeof(w));
+    return w;
+}
+
+// same field order as before the state was gathered in GameState, so
+// traces stay comparable
+uint32_t physics_hash(const GameState &s, uint32_t h) {
+    for (int i = ENT_P1; i <= ENT_P2; i++) {
+        h = fnv_word(h, (uint32_t)s.x[i]);
+        h = fnv_word(h, (uint32_t)s.y[i]);
+        h = fnv_word(h, phys_bits(s.vy[i]));
     }
+    h = fnv_word(h, (uint32_t)s.x[ENT_BALL]);
+    h = fnv_word(h, (uint32_t)s.y[ENT_BALL]);
+    h = fnv_word(h, phys_bits(s.vx[ENT_BALL]));
+    h = fnv_word(h, phys_bits(s.vy[ENT_BALL]));
+    h = fnv_word(h, (s.on_ground[ENT_P1] ? 1u : 0u) | (s.on_ground[ENT_P2] ? 2u : 0u));
+    return fnv_word(h, s.rng);
 }
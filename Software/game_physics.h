@@ -3,7 +3,17 @@
 #define PHYSICS_H
 
 #include <cmath>
+#include <type_traits>
 #include "chu_init.h"
+#include "fixed_point.h"
+
+// Physics scalar: Q16.16 fixed point by default (the MCS has no FPU);
+// define PHYSICS_FLOAT to build the original float version
+#ifdef PHYSICS_FLOAT
+typedef float phys_t;
+#else
+typedef Q16_16 phys_t;
+#endif
 
 extern const int SCREEN_H;
 extern const int SCREEN_W;
@@ -11,27 +21,105 @@ extern const int PLAYER_H;
 extern const int PLAYER_W;
 extern const int BALL_W;
 extern const int BALL_H;
-extern const float GRAVITY;
-extern const float FRICTION;
-extern const float BOUNCE_DAMPING;
-extern const float GROUND_Y;
+extern const phys_t GRAVITY;
+extern const phys_t FRICTION;
+extern const phys_t BOUNCE_DAMPING;
+
+extern const int PHYSICS_TICK_MS;
 
 extern const int GROUND_OFFSET;
 extern const int PLAYER_GROUND_Y;
 extern const int BALL_GROUND_Y;
 
-extern int p1_y, p2_y;
-extern int p1_x, p2_x;
-extern float p1_vy, p2_vy;
-extern bool p1_on_ground, p2_on_ground;
+// goalposts stand on the ground line, GOALPOST_INSET px from each wall
+extern const int GOALPOST_W;
+extern const int GOALPOST_H;
+extern const int GOALPOST_INSET;
+
+// ===== Game state =====
+// entity slots of the GameState arrays
+enum {
+    ENT_P1    = 0,
+    ENT_P2    = 1,
+    ENT_BALL  = 2,
+    ENT_COUNT = 3
+};
+
+// input bits of one player for one tick
+enum {
+    IN_LEFT  = 0x01,
+    IN_RIGHT = 0x02,
+    IN_JUMP  = 0x04,
+    IN_KICK  = 0x08
+};
+
+// game_step() events
+enum {
+    EV_GOAL_P1    = 0x01,   // player 1 scored; positions are reset
+    EV_GOAL_P2    = 0x02,
+    EV_MATCH_OVER = 0x04
+};
+
+// Everything the simulation of a match reads or writes, in one fixed
+// block with no pointers: a snapshot or a restore is a memcpy (replay
+// checks, rollback). Entities are parallel arrays indexed by ENT_*.
+struct GameState {
+    phys_t   vx[ENT_COUNT];         // px per tick (players: always 0)
+    phys_t   vy[ENT_COUNT];
+    uint32_t tick;                  // physics ticks since game_init()
+    uint32_t match_ms;              // physics time, tick * PHYSICS_TICK_MS
+    uint32_t last_hit_ms[2];        // ball bounce cooldown per player
+    uint32_t rng;                   // xorshift32 state
+    int16_t  x[ENT_COUNT];          // sprite top-left corner, px
+    int16_t  y[ENT_COUNT];
+    uint8_t  on_ground[ENT_COUNT];  // players only
+    uint8_t  score[2];
+    uint8_t  pad[3];                // explicit, so copies are all data
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must copy by memcpy");
+static_assert(sizeof(GameState) == 64, "GameState is not packed");
+
+extern const int MATCH_DURATION_SEC;
+extern const phys_t JUMP_VELOCITY;
+
+// new match: scores, clock and cooldowns zeroed, rng seeded; positions
+// as game_reset_positions(s, true)
+void game_init(GameState &s, uint32_t seed);
+
+// kickoff positions; the ball drops from mid-screen unless on the ground
+void game_reset_positions(GameState &s, bool ball_on_ground);
+
+// one physics tick: controls (IN_* bits of each player), physics, the
+// match clock and goals; returns EV_* bits
+int game_step(GameState &s, uint8_t p1_in, uint8_t p2_in);
+
+void apply_gravity_and_ground(GameState &s);
+void update_ball_motion(GameState &s);
+
+// advance the bodies by exactly one PHYSICS_TICK_MS step;
+// s.match_ms is physics time (not wall-clock) so results don't depend
+// on frame load
+// collisions: ball/players, player/player and ball/goalpost tops run
+// through a CollisionWorld (collision_world.h); a ball faster than
+// half its width per tick is swept in substeps and stops at the first
+// contact, so kicks cannot tunnel (define PHYSICS_NO_CCD to compare)
+void physics_step(GameState &s, bool p1_kicking, bool p2_kicking);
+
+// power-up pickup zone (sensor for the V8_POWERUP sprite); off by default
+void physics_powerup(bool on, int x, int y);
+// what touched the power-up in the last step: bit 0 p1, bit 1 p2, bit 2 ball
+int physics_powerup_touch();
 
-extern int ball_x, ball_y;
-extern float ball_vx, ball_vy;
+// kick/bounce sounds on (default) or off; off while a rollback
+// re-simulates ticks that already played theirs
+void physics_sound(bool on);
 
-extern bool key_state[128];
+// deterministic random source for physics (replaces rand() so a seed
+// plus the input log reproduces a match); the state lives in s.rng
+int phys_rand(GameState &s);
 
-void apply_gravity_and_ground();
-void update_ball_motion();
-void handle_player_ball_collision(int p_x, int p_y, bool is_kicking, unsigned long now, unsigned long &last_collision_time, int player_id);
+// FNV-1a of the simulated bodies (positions, velocities, rng) folded into h
+uint32_t physics_hash(const GameState &s, uint32_t h);
 
 #endif
@@ -0,0 +1,199 @@
+/*****************************************************************//**
+ * @file key_input.cpp
+ *
+ * @brief implementation of KeyState and Ps2Input classes
+ *
+ ********************************************************************/
+
+#include "key_input.h"
+
+/**********************************************************************
+ * ps2 scan code set 2 decoder
+ *  - each byte is first mapped to a class, then the
+ *    (state, class) table gives the next state and an action
+ *  - make:            kk         ext make:  E0 kk
+ *  - break:        F0 kk         ext break: E0 F0 kk
+ *  - Pause:        E1 14 77 E1 F0 14 F0 77 (no break code)
+ *  - 00/FF (overrun), AA (self-test), FA/FE/EE (ack/resend/echo)
+ *    never appear inside a key sequence: resynchronize
+ *********************************************************************/
+namespace {
+
+enum {
+   DEC_IDLE = 0,     // waiting for a new sequence
+   DEC_BRK,          // got F0
+   DEC_EXT,          // got E0
+   DEC_EXT_BRK,      // got E0 F0
+   DEC_PAUSE,        // inside E1 sequence
+   DEC_NUM_STATES
+};
+
+enum {
+   BC_KEY = 0,       // ordinary key code
+   BC_F0,            // break prefix
+   BC_E0,            // extended prefix
+   BC_E1,            // pause prefix
+   BC_SYNC,          // status/error byte
+   BC_NUM_CLASSES
+};
+
+enum {
+   ACT_NONE = 0,     // prefix consumed
+   ACT_MAKE,         // key pressed
+   ACT_BREAK,        // key released
+   ACT_MAKE_EXT,     // extended key pressed
+   ACT_BREAK_EXT,    // extended key released
+   ACT_PAUSE,        // start of Pause sequence
+   ACT_SKIP,         // byte of Pause sequence
+   ACT_RESYNC        // drop sequence, release all keys
+};
+
+const int PAUSE_SEQ_LEN = 8;   // bytes in the Pause sequence
+
+struct DecodeStep {
+   uint8_t next;
+   uint8_t action;
+};
+
+constexpr uint8_t byte_class(uint8_t b) {
+   return (b == 0xF0) ? BC_F0 :
+          (b == 0xE0) ? BC_E0 :
+          (b == 0xE1) ? BC_E1 :
+          (b == 0x00 || b == 0xFF || b == 0xAA ||
+           b == 0xFA || b == 0xFE || b == 0xEE) ? BC_SYNC : BC_KEY;
+}
+
+// next state / action for [state][byte class]
+constexpr DecodeStep DECODE_TABLE[DEC_NUM_STATES][BC_NUM_CLASSES] = {
+   //  BC_KEY                      BC_F0                     BC_E0                  BC_E1                   BC_SYNC
+   { { DEC_IDLE, ACT_MAKE },      { DEC_BRK, ACT_NONE },     { DEC_EXT, ACT_NONE },  { DEC_PAUSE, ACT_PAUSE }, { DEC_IDLE, ACT_RESYNC } },  // DEC_IDLE
+   { { DEC_IDLE, ACT_BREAK },     { DEC_IDLE, ACT_RESYNC },  { DEC_IDLE, ACT_RESYNC }, { DEC_IDLE, ACT_RESYNC }, { DEC_IDLE, ACT_RESYNC } },  // DEC_BRK
+   { { DEC_IDLE, ACT_MAKE_EXT },  { DEC_EXT_BRK, ACT_NONE }, { DEC_IDLE, ACT_RESYNC }, { DEC_IDLE, ACT_RESYNC }, { DEC_IDLE, ACT_RESYNC } },  // DEC_EXT
+   { { DEC_IDLE, ACT_BREAK_EXT }, { DEC_IDLE, ACT_RESYNC },  { DEC_IDLE, ACT_RESYNC }, { DEC_IDLE, ACT_RESYNC }, { DEC_IDLE, ACT_RESYNC } },  // DEC_EXT_BRK
+   { { DEC_PAUSE, ACT_SKIP },     { DEC_PAUSE, ACT_SKIP },   { DEC_PAUSE, ACT_SKIP },  { DEC_PAUSE, ACT_SKIP },  { DEC_PAUSE, ACT_SKIP } }     // DEC_PAUSE
+};
+
+static_assert(byte_class(0x1C) == BC_KEY, "plain key code");
+static_assert(byte_class(0xF0) == BC_F0 && byte_class(0xE0) == BC_E0, "prefixes");
+static_assert(DECODE_TABLE[DEC_EXT][BC_KEY].action == ACT_MAKE_EXT, "E0 kk");
+static_assert(DECODE_TABLE[DEC_EXT_BRK][BC_KEY].action == ACT_BREAK_EXT, "E0 F0 kk");
+
+}  // namespace
+
+/**********************************************************************
+ * KeyState methods
+ *********************************************************************/
+KeyState::KeyState() {
+   clear();
+}
+
+void KeyState::apply(const KeyEvent &ev) {
+   if (ev.code == KEY_ALL_UP)
+      clear();
+   else
+      set(ev.code, !ev.is_break);
+}
+
+int KeyState::is_down(int code) const {
+   if (code < 0 || code >= NUM_KEYS)
+      return (0);
+   return ((int) bit_read(bits[code >> 5], code & 0x1f));
+}
+
+int KeyState::set(int code, int down) {
+   if (code < 0 || code >= NUM_KEYS || is_down(code) == down)
+      return (0);
+   if (down)
+      bit_set(bits[code >> 5], code & 0x1f);
+   else
+      bit_clear(bits[code >> 5], code & 0x1f);
+   return (1);
+}
+
+void KeyState::clear() {
+   for (int i = 0; i < NUM_KEYS / 32; i++)
+      bits[i] = 0;
+}
+
+/**********************************************************************
+ * Ps2Input methods
+ *********************************************************************/
+Ps2Input::Ps2Input(Ps2Core *ps2_core) {
+   ps2 = ps2_core;
+   state = DEC_IDLE;
+   skip = 0;
+}
+
+Ps2Input::~Ps2Input() {
+}
+
+void Ps2Input::poll() {
+   int code;
+
+   while ((code = ps2->rx_byte()) >= 0)
+      decode((uint8_t) code, (uint32_t) now_us());
+}
+
+void Ps2Input::decode(uint8_t byte, uint32_t t_us) {
+   const DecodeStep &step = DECODE_TABLE[state][byte_class(byte)];
+
+   state = step.next;
+   switch (step.action) {
+   case ACT_MAKE:
+      emit(byte, 0, t_us);
+      break;
+   case ACT_BREAK:
+      emit(byte, 1, t_us);
+      break;
+   case ACT_MAKE_EXT:
+      emit(KEY_EXT | byte, 0, t_us);
+      break;
+   case ACT_BREAK_EXT:
+      emit(KEY_EXT | byte, 1, t_us);
+      break;
+   case ACT_PAUSE:
+      skip = PAUSE_SEQ_LEN - 1;
+      break;
+   case ACT_SKIP:
+      if (--skip == 0)
+         state = DEC_IDLE;
+      break;
+   case ACT_RESYNC:
+      emit(KEY_ALL_UP, 1, t_us);   // releases every key
+      break;
+   default:
+      break;
+   }
+}
+
+void Ps2Input::emit(int code, int is_break, uint32_t t_us) {
+   KeyEvent ev;
+
+   // typematic repeat (make of a held key) and stray breaks carry no news
+   if (code != KEY_ALL_UP && held.is_down(code) == !is_break)
+      return;
+   ev.t_us = t_us;
+   ev.code = (uint16_t) code;
+   ev.is_break = (uint8_t) is_break;
+   // ring full: held keeps the old state, so the next typematic repeat
+   // (or the break) of the key is sent instead of suppressed
+   if (!ring.push(ev))
+      return;
+   if (code == KEY_ALL_UP)
+      held.clear();
+   else
+      held.set(code, !is_break);
+}
+
+int Ps2Input::next_event(KeyEvent *ev) {
+   return (ring.pop(ev));
+}
+
+void Ps2Input::flush() {
+   KeyEvent ev;
+
+   poll();
+   while (ring.pop(&ev))
+      ;
+   held.clear();
+}
@@ -0,0 +1,207 @@
+/*****************************************************************//**
+ * @file key_input.h
+ *
+ * @brief buffered, timestamped ps2 keyboard input
+ *
+ * Description:
+ *  - KeyEventRing: lock-free single-producer/single-consumer ring
+ *  - Ps2Input: drains the ps2 core rx fifo into the ring, decoding
+ *    scan code set 2 and stamping each event with now_us()
+ *  - decoder is a table-driven state machine (see key_input.cpp):
+ *    0xE0 prefix gives extended keys (code | KEY_EXT), 0xE1 (Pause)
+ *    is swallowed, typematic repeats of a held key are dropped, and
+ *    controller/keyboard status bytes resynchronize the decoder and
+ *    release every key (KEY_ALL_UP event)
+ *  - poll() is the producer; it may run from a timer ISR or be
+ *    called from any wait loop, so the 16-byte hardware fifo is
+ *    emptied much more often than once per frame
+ *  - next_event() is the consumer (game loop)
+ *  - KeyState: bitset of keys currently held down
+ *
+ ********************************************************************/
+
+#ifndef _KEY_INPUT_H_INCLUDED
+#define _KEY_INPUT_H_INCLUDED
+
+#include "chu_init.h"
+#include "ps2_core.h"
+
+/**
+ * one decoded key transition
+ *
+ */
+struct KeyEvent {
+   uint32_t t_us;      // now_us() when the last byte was read
+   uint16_t code;      // key code: scan code, | KEY_EXT if 0xE0-prefixed
+   uint8_t is_break;   // 1: key released; 0: key pressed
+};
+
+/**
+ * key code space
+ *
+ */
+enum {
+   KEY_EXT = 0x100,      /**< flag for 0xE0-prefixed (extended) keys */
+   KEY_ALL_UP = 0x1ff,   /**< pseudo key: release everything (resync) */
+   KEY_CODE_MAX = 0x200  /**< # of key codes */
+};
+
+/* compiler barrier between ring slot and index accesses */
+#define KEY_RING_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/**
+ * single-producer/single-consumer event ring
+ *  - N must be a power of 2
+ *  - head written by producer only, tail by consumer only
+ *  - one slot kept empty to tell full from empty
+ *  - the slots are not volatile: KEY_RING_BARRIER keeps the compiler
+ *    from moving slot accesses across the index updates (one in-order
+ *    core, so no hardware fence is needed)
+ */
+template<int N>
+class KeyEventRing {
+public:
+   KeyEventRing() : head(0), tail(0), overflow(0) {}
+
+   /**
+    * append an event (producer side)
+    * @return 1 on success; 0 if ring is full (event dropped)
+    */
+   int push(const KeyEvent &ev) {
+      uint32_t h = head;
+      uint32_t next = (h + 1) & (N - 1);
+
+      if (next == tail) {
+         overflow++;
+         return (0);
+      }
+      buf[h] = ev;
+      KEY_RING_BARRIER();
+      head = next;    // publish after the slot is written
+      return (1);
+   }
+
+   /**
+    * remove the oldest event (consumer side)
+    * @return 1 if an event was returned; 0 if ring is empty
+    */
+   int pop(KeyEvent *ev) {
+      uint32_t t = tail;
+
+      if (t == head)
+         return (0);
+      KEY_RING_BARRIER();
+      *ev = buf[t];
+      KEY_RING_BARRIER();
+      tail = (t + 1) & (N - 1);   // free the slot after it is read
+      return (1);
+   }
+
+   int empty() const { return (head == tail); }
+
+   /* # events dropped because the ring was full */
+   uint32_t dropped() const { return (overflow); }
+
+private:
+   KeyEvent buf[N];
+   volatile uint32_t head;
+   volatile uint32_t tail;
+   volatile uint32_t overflow;
+};
+
+/**
+ * keys currently held down
+ *
+ */
+class KeyState {
+public:
+   enum {
+      NUM_KEYS = KEY_CODE_MAX   /**< # of trackable key codes */
+   };
+   KeyState();
+
+   /**
+    * apply a key event
+    * @param ev key event
+    */
+   void apply(const KeyEvent &ev);
+
+   /**
+    * check whether a key is down
+    * @param code scan code
+    * @return 1: key held; 0: otherwise
+    */
+   int is_down(int code) const;
+
+   /**
+    * release all keys
+    */
+   void clear();
+
+   /**
+    * update one key
+    * @param code key code
+    * @param down 1: pressed; 0: released
+    * @return 1 if the key changed state; 0 otherwise
+    */
+   int set(int code, int down);
+
+private:
+   uint32_t bits[NUM_KEYS / 32];
+};
+
+/**
+ * buffered ps2 keyboard reader
+ *
+ */
+class Ps2Input {
+public:
+   enum {
+      RING_SIZE = 64   /**< event ring capacity (power of 2) */
+   };
+   Ps2Input(Ps2Core *ps2_core);
+   ~Ps2Input();      // not used
+
+   /**
+    * move all bytes from the ps2 rx fifo into the event ring
+    *
+    * @note producer; call often (wait loops, timer ISR)
+    */
+   void poll();
+
+   /**
+    * get the oldest pending key event
+    * @param ev returned event
+    * @return 1 if an event was returned; 0 if none pending
+    *
+    * @note consumer; call from the game loop only
+    */
+   int next_event(KeyEvent *ev);
+
+   /**
+    * discard pending bytes and events
+    */
+   void flush();
+
+   /**
+    * run one received byte through the set-2 decoder
+    * @param byte raw byte from the keyboard
+    * @param t_us time stamp of the byte
+    *
+    * @note poll() calls this; exposed to feed recorded byte streams
+    */
+   void decode(uint8_t byte, uint32_t t_us);
+
+   /* # events lost to ring overflow */
+   uint32_t dropped() const { return (ring.dropped()); }
+
+private:
+   Ps2Core *ps2;
+   uint8_t state;       // decoder state (DEC_* in key_input.cpp)
+   uint8_t skip;        // bytes left in a Pause sequence
+   KeyState held;       // producer-side copy, for repeat suppression
+   KeyEventRing<RING_SIZE> ring;
+   void emit(int code, int is_break, uint32_t t_us);
+};
+
+#endif  // _KEY_INPUT_H_INCLUDED
@@ -1,30 +1,72 @@
 #include "chu_init.h"
 #include "gpio_cores.h"
 #include "vga_core.h"
+#include "osd_canvas.h"
+#include "raster.h"
+#include "sprite_art.h"
 #include "sseg_core.h"
 #include "ps2_core.h"
+#include "key_input.h"
 #include "ddfs_core.h"
 #include "adsr_core.h"
 #include "audio_manager.h"
 #include "game_physics.h"
-#include <cstdio>
+#include "replay.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "netplay.h"
+#include "tick_div.h"
 #include <cstring>
-#include <cmath>
 
 // ===== Constants =====
-#define MATCH_DURATION_SEC 10
 static const int GP_W = 8, GP_H = 80;
 const int INVISIBLE_LINE_Y = SCREEN_H - 40;
-static const float JUMP_VELOCITY = -10.0f * 0.75f;
 static const float DEFAULT_ENV_LEVEL = 0.8;
 
+// Frame timing: physics runs at PHYSICS_TICK_MS, rendering runs decoupled
+static const unsigned long PHYSICS_TICK_US = PHYSICS_TICK_MS * 1000UL;
+static const uint32_t PHYSICS_TICK_CLKS = PHYSICS_TICK_US * SYS_CLK_FREQ;
+static const uint32_t MAX_BACKLOG_CLKS  = 4 * PHYSICS_TICK_CLKS;  // drop time after long stalls
+static const unsigned long RENDER_PERIOD_MS = 15;   // frame deadline period
+static const unsigned long AUDIO_TASK_US  = 2000;
+static const unsigned long PROMPT_TASK_US = 700000;  // splash prompt flash
+static const unsigned long HUD_TASK_US    = 100000;  // score/timer refresh
+static const int ALPHA_SHIFT = 8;                // interpolation factor is Q8
+static const int ALPHA_ONE   = 1 << ALPHA_SHIFT;
+static const unsigned long NET_SETTLE_MS = 2000;  // wait for the peer's last inputs
+
 // Goalpost positions
 static const int LEFT_POST_X      = 10;
 static const int RIGHT_POST_X     = SCREEN_W - 10 - GP_W;
-static const int POST_INNER_LEFT  = LEFT_POST_X + GP_W;
-static const int POST_INNER_RIGHT = RIGHT_POST_X;
 static const int POST_TOP_Y       = SCREEN_H - GP_H;
 
+// PS/2 set-2 key codes (arrows are 0xE0-prefixed, hence KEY_EXT)
+static const int KEY_ENTER = 0x5A;
+static const int KEY_A     = 0x1C;
+static const int KEY_D     = 0x23;
+static const int KEY_W     = 0x1D;
+static const int KEY_SPACE = 0x29;
+static const int KEY_P     = 0x4D;
+static const int KEY_LEFT  = KEY_EXT | 0x6B;
+static const int KEY_RIGHT = KEY_EXT | 0x74;
+static const int KEY_UP    = KEY_EXT | 0x75;
+
+// Pitch background (frame buffer), laid out like the bar core scene
+static const int HUD_H      = 60;                // grey strip behind the scoreboard
+static const int HORIZON_Y  = SCREEN_H - 80;     // sky above, grass below
+static const int STRIPE_W   = 40;                // mown grass stripes
+static const int FLAG_W = 8, FLAG_H = 20;
+static const uint32_t PITCH_HUD    = frame_color(0x888);
+static const uint32_t PITCH_BOX    = frame_color(0x000);
+static const uint32_t PITCH_SKY    = frame_color(0x8CF);
+static const uint32_t PITCH_SUN    = frame_color(0xFF0);
+static const uint32_t PITCH_CLOUD1 = frame_color(0xDEF);
+static const uint32_t PITCH_CLOUD2 = frame_color(0xFFF);
+static const uint32_t PITCH_GRASS1 = frame_color(0x0A8);
+static const uint32_t PITCH_GRASS2 = frame_color(0x074);
+static const uint32_t PITCH_LINE   = frame_color(0xFFF);
+static const uint32_t PITCH_FLAG   = frame_color(0xF00);
+
 // Scoreboard layout
 static const int P1_COL = 7, P1_ROW = 2;
 static const int P2_COL = 73, P2_ROW = 2;
@@ -35,6 +77,7 @@ GpoCore    led      (get_slot_addr(BRIDGE_BASE, S2_LED));
 GpiCore    sw       (get_slot_addr(BRIDGE_BASE, S3_SW));
 SsegCore   sseg     (get_slot_addr(BRIDGE_BASE, S8_SSEG));
 Ps2Core    ps2      (get_slot_addr(BRIDGE_BASE, S11_PS2));
+Ps2Input   kbd      (&ps2);
 DdfsCore   ddfs     (get_slot_addr(BRIDGE_BASE, S12_DDFS));
 AdsrCore   adsr     (get_slot_addr(BRIDGE_BASE, S13_ADSR), &ddfs);
 
@@ -46,103 +89,181 @@ SpriteCore goalpost1 (get_sprite_addr(BRIDGE_BASE, V6_GOALPOST1), 512);
 SpriteCore goalpost2 (get_sprite_addr(BRIDGE_BASE, V5_GOALPOST2), 512);
 GpvCore    bar       (get_sprite_addr(BRIDGE_BASE, V7_BAR));
 OsdCore    osd       (get_sprite_addr(BRIDGE_BASE, V1_OSD));
+OsdCanvas  hud       (&osd);   // in-game scoreboard, redrawn by the hud task
+SyncCore   vsync     (get_sprite_addr(BRIDGE_BASE, V0_SYNC));
+FrameCore  frame     (FRAME_BASE);
+Raster     raster    (&frame);  // pitch drawing on the frame buffer
+SpriteBatch sprites;            // sprite moves, committed once per frame
+
+// ===== Scheduling =====
+FramePacer pacer     (RENDER_PERIOD_MS * 1000);
+TaskTable  tasks;
+static int task_audio, task_prompt, task_hud;
+static bool vsync_ok = false;   // raster status readable: commit in vblank
+static bool pitch_drawn = false;
+static int players_swapped = -1;   // art in the player rams (-1: bitstream)
+
+// ===== Two-Board Play =====
+Netplay    net       (&uart);   // rollback session with the board on the uart
+static bool netplay_on = false;
+static uint8_t net_match = 0;   // match id; both boards count matches alike
 
 // ===== Game State =====
-int p1_score = 0, p2_score = 0;
+GameState game;           // the simulated match: bodies, scores, clock, rng
 bool game_over = false;
-unsigned long start_time;
-bool p1_kick = false, p2_kick = false;
+bool p1_kick = false, p2_kick = false;   // kick sprite shown
+KeyState keys;
+
+// State at the start of the current physics tick (for render interpolation)
+static GameState prev;
 
 // ===== Function Prototypes =====
 void draw_splash_credits();
-void starting_splash_screen(OsdCore *osd_p, Ps2Core *ps2_p);
-void load_goalposts();
+void starting_splash_screen(OsdCore *osd_p, Ps2Input *kbd_p);
+void load_sprite_art();
+void load_player_art(bool swap);
+void draw_pitch();
 void show_countdown(OsdCore *osd_p);
 void draw_score_and_timer();
-void update_sprite_positions();
-void reset_positions(bool ball_on_ground);
-void detect_goal();
-void handle_ps2_input();
-void process_controls();
+void update_sprite_positions(int alpha = ALPHA_ONE);
+void stage_sprite_positions(int alpha);
+void commit_sprite_positions();
+void save_prev_positions();
+void celebrate_goal();
+void handle_ps2_input(uint32_t tick);
+bool enter_pressed();
+void init_tasks();
+void idle_tasks();
+void idle_ms(unsigned long ms);
+void wait_audio();
+uint8_t player_input(int left, int right, int jump, int kick);
+void process_controls(uint8_t p1_in, uint8_t p2_in);
+void settle_netplay();
 void game_loop();
 
-void starting_splash_screen(OsdCore *osd_p, Ps2Core *ps2_p) {
+// Splash prompt, toggled by the prompt task
+static const char *SPLASH_PROMPT = "Press ENTER to start game";
+static const int PROMPT_ROW = 15;
+static bool show_prompt = true;
+
+void flash_prompt() {
+    int prompt_len = strlen(SPLASH_PROMPT);
+    int prompt_x = (80 - prompt_len) / 2;
+
+    osd.set_color(0xFF0, 0x000); // yellow on black
+    for (int i = 0; i < prompt_len; i++) {
+        osd.wr_char(prompt_x + i, PROMPT_ROW, show_prompt ? SPLASH_PROMPT[i] : ' ');
+    }
+    show_prompt = !show_prompt;
+}
+
+void starting_splash_screen(OsdCore *osd_p, Ps2Input *kbd_p) {
     osd_p->clr_screen();
     draw_splash_credits();
     osd_p->set_color(0xFF0, 0x000); // yellow on black
 
     const char *title = "BIG HEAD SOCCER";
-    const char *prompt = "Press ENTER to start game";
 
     int title_len = strlen(title);
-    int prompt_len = strlen(prompt);
     int title_x = (80 - title_len) / 2;
-    int prompt_x = (80 - prompt_len) / 2;
 
     int title_row = 11;
-    int prompt_row = 15;
 
     for (int i = 0; i < title_len; i++) {
         osd_p->wr_char(title_x + i, title_row, title[i]);
     }
 
-    bool show_prompt = true;
-    unsigned long last_flash_time = now_ms();
-
     // Start looping splash music
     start_song(smash_splash, smash_splash_len, true);
+    show_prompt = true;
+    tasks.enable(task_prompt, true);   // flash the prompt every 700ms
 
-    bool enter_pressed = false;
+    bool start = false;
 
-    while (!enter_pressed) {
-        unsigned long now = now_ms();
-
-        // Flash the prompt every 700ms
-        if (now - last_flash_time >= 700) {
-            for (int i = 0; i < prompt_len; i++) {
-                osd_p->wr_char(prompt_x + i, prompt_row, show_prompt ? prompt[i] : ' ');
-            }
-            show_prompt = !show_prompt;
-            last_flash_time = now;
-        }
-
-        play_song_tick();  // Advance the looping music
-
-        // Exit only when Enter (scan code 0x5A) is pressed
-        while (!ps2_p->rx_fifo_empty()) {
-            int code = ps2_p->rx_byte();
-            if (code == 0x5A) {
-                enter_pressed = true;
+    while (!start) {
+        // Exit only when Enter is pressed
+        KeyEvent ev;
+        while (kbd_p->next_event(&ev)) {
+            if (ev.code == KEY_ENTER && !ev.is_break) {
+                start = true;
                 break;
             }
-            if (code == 0xF0) {
-                (void)ps2_p->rx_byte(); // skip break codes
-            }
         }
 
-        sleep_ms(20);  // Smooth updates
+        idle_ms(20);  // Smooth updates; keeps the looping music going
     }
+    tasks.enable(task_prompt, false);
 
     // Stop looping, play Mario intro once
     start_song(mario_intro, mario_intro_len, false);
     while (!is_song_done()) {
-        play_song_tick();
-        sleep_ms(20);
+        idle_ms(20);
     }
 
     osd_p->clr_screen();  // Clear before countdown
 }
 
-// Fill both goalpost RAMs with a 1 pixel border (code=1) and filled interior (code=2)
-void load_goalposts() {
-    for (int row = 0; row < GP_H; row++) {
-        for (int col = 0; col < GP_W; col++) {
-            uint8_t code = (row == 0 || row == GP_H-1 || col == 0 || col == GP_W-1) ? 1 : 2;
-            int addr = row * GP_W + col;
-            goalpost1.wr_mem(addr, code);
-            goalpost2.wr_mem(addr, code);
+// Sprite RAMs from the run-length-encoded art in sprite_art.h, so the
+// image, not the bitstream, decides what the sprites look like
+void load_sprite_art() {
+    rle_upload(&ball, BALL_ART);
+    rle_upload(&goalpost1, GOALPOST_ART);   // 1 pixel border, filled interior
+    rle_upload(&goalpost2, GOALPOST_ART);
+    load_player_art(false);
+}
+
+// Both frames (normal, kick) of each player; swap: each player wears the
+// other's art (jersey color stays with the core's palette)
+void load_player_art(bool swap) {
+    rle_upload(&player1, swap ? PLAYER2_ART : PLAYER1_ART);
+    rle_upload(&player2, swap ? PLAYER1_ART : PLAYER2_ART);
+    players_swapped = swap;
+}
+
+// Pitch in the frame buffer: the bar core scene (hud strip, sky, sun,
+// clouds, grass) redrawn in software with mown stripes, lines and
+// corner flags.  Drawn once; shown by bypassing the bar core.
+void draw_pitch() {
+    static uint32_t flag[FLAG_W * FLAG_H];
+
+    raster.reset_clip();
+    raster.fill_rect(0, 0, SCREEN_W, HUD_H, PITCH_HUD);
+    raster.fill_rect(10, 0, 90, HUD_H, PITCH_BOX);                     // P1 score
+    raster.fill_rect(SCREEN_W / 2 - 80, 0, 160, HUD_H, PITCH_BOX);     // timer
+    raster.fill_rect(SCREEN_W - 100, 0, 90, HUD_H, PITCH_BOX);         // P2 score
+
+    // sky; the sun is cut at the hud like in the bar core
+    raster.fill_rect(0, HUD_H, SCREEN_W, HORIZON_Y - HUD_H, PITCH_SKY);
+    raster.set_clip(0, HUD_H, SCREEN_W, HORIZON_Y);
+    raster.fill_circle(550, 80, 34, PITCH_SUN);
+    raster.fill_rect(51, 101, 99, 39, PITCH_CLOUD1);
+    raster.fill_rect(221, 61, 99, 39, PITCH_CLOUD1);
+    raster.fill_rect(301, 131, 79, 29, PITCH_CLOUD2);
+    raster.fill_rect(421, 91, 79, 29, PITCH_CLOUD2);
+    raster.reset_clip();
+
+    // grass, touchline, halfway line, penalty areas (open at the edges)
+    for (int x = 0; x < SCREEN_W; x += STRIPE_W)
+        raster.fill_rect(x, HORIZON_Y, STRIPE_W, SCREEN_H - HORIZON_Y,
+                         ((x / STRIPE_W) & 1) ? PITCH_GRASS1 : PITCH_GRASS2);
+    raster.hspan(0, HORIZON_Y, SCREEN_W, PITCH_LINE);
+    raster.vspan(SCREEN_W / 2, HORIZON_Y, SCREEN_H - HORIZON_Y, PITCH_LINE);
+    raster.rect(-1, HORIZON_Y + 20, 81, 40, PITCH_LINE);
+    raster.rect(SCREEN_W - 80, HORIZON_Y + 20, 81, 40, PITCH_LINE);
+
+    // corner flags: white pole, red pennant, key 0 lets the grass through
+    for (int row = 0; row < FLAG_H; row++) {
+        for (int col = 0; col < FLAG_W; col++) {
+            uint32_t c = 0;
+            if (col == 0)
+                c = PITCH_LINE;
+            else if (row < 6 && col < 7 - row)
+                c = PITCH_FLAG;
+            flag[row * FLAG_W + col] = c;
         }
     }
+    raster.blit(2, SCREEN_H - FLAG_H - 2, flag, FLAG_W, FLAG_H, 0);
+    raster.blit(SCREEN_W - FLAG_W, SCREEN_H - FLAG_H - 2, flag, FLAG_W, FLAG_H, 0);
 }
 
 void show_countdown(OsdCore *osd_p) {
@@ -163,20 +284,22 @@ void show_countdown(OsdCore *osd_p) {
 
     // Play sound: short for 3,2,1 — long for START!!!
     play_countdown_beep(i);
+    wait_audio();
     if (i < 3) {
-      sleep_ms(200);  // short beep
+      idle_ms(200);  // short beep
     } else {
-      sleep_ms(600);  // longer "GO" tone
+      idle_ms(600);  // longer "GO" tone
     }
 
     osd_p->clr_screen(); // hide message
-    sleep_ms(400);       // pause between flashes
+    idle_ms(400);        // pause between flashes
   }
 
 }
 
 void draw_score_and_timer() {
-    osd.clr_screen();
+    PROF_ZONE(PROF_HUD);
+    hud.clear();
     osd.set_color(0xFFF, 0x000); // white on black for best visibility
 
     // ==== PLAYER 1 label (shift left to center) ====
@@ -184,34 +307,22 @@ void draw_score_and_timer() {
     int p1_label_len = strlen(p1_label);
     int p1_label_col = P1_COL - (p1_label_len - 1) / 2;  // Shift left to center above score
     for (int i = 0; i < p1_label_len; i++) {
-        osd.wr_char(p1_label_col + i, P1_ROW - 1, p1_label[i]);
+        hud.put_char(p1_label_col + i, P1_ROW - 1, p1_label[i]);
     }
 
     // ==== Draw P1 score ====
-    {
-        char buf[4];
-        sprintf(buf, "%d", p1_score);
-        for (int i = 0; buf[i]; i++) {
-            osd.wr_char(P1_COL + i, P1_ROW, buf[i]);
-        }
-    }
+    hud.put_uint(P1_COL, P1_ROW, game.score[0]);
 
     // ==== PLAYER 2 label (shift left to center) ====
     const char *p2_label = "PLAYER 2";
     int p2_label_len = strlen(p2_label);
     int p2_label_col = P2_COL - (p2_label_len - 1) / 2;  // Same logic for player 2
     for (int i = 0; i < p2_label_len; i++) {
-        osd.wr_char(p2_label_col + i, P2_ROW - 1, p2_label[i]);
+        hud.put_char(p2_label_col + i, P2_ROW - 1, p2_label[i]);
     }
 
     // ==== Draw P2 score ====
-    {
-        char buf[4];
-        sprintf(buf, "%d", p2_score);
-        for (int i = 0; buf[i]; i++) {
-            osd.wr_char(P2_COL + i, P2_ROW, buf[i]);
-        }
-    }
+    hud.put_uint(P2_COL, P2_ROW, game.score[1]);
 
     // ==== Draw TIME label ====
     {
@@ -222,19 +333,16 @@ void draw_score_and_timer() {
         int centered_col = TIME_COL + (time_len - label_len) / 2;
 
         for (int i = 0; i < label_len; i++) {
-            osd.wr_char(centered_col + i, label_row, label[i]);
+            hud.put_char(centered_col + i, label_row, label[i]);
         }
     }
 
     // ==== Draw actual timer ====
     {
-        char buf[8];
-        unsigned long elapsed = (now_ms() - start_time) / 1000;
+        unsigned long elapsed = RecipDiv<1000>::div(game.match_ms);   // ms -> s
         int remaining = MATCH_DURATION_SEC - (int)elapsed;
-        sprintf(buf, "%02d:%02d", remaining / 60, remaining % 60);
-        for (int i = 0; buf[i]; i++) {
-            osd.wr_char(TIME_COL + i, TIME_ROW, buf[i]);
-        }
+        if (remaining < 0) remaining = 0;
+        hud.put_mmss(TIME_COL, TIME_ROW, remaining);
     }
 
     // ==== Player 1 Instructions ====
@@ -245,10 +353,10 @@ void draw_score_and_timer() {
     int instr_row2 = 2;
 
     for (int i = 0; p1_kick[i]; i++)
-        osd.wr_char(p1_instr_col + i, instr_row1, p1_kick[i]);
+        hud.put_char(p1_instr_col + i, instr_row1, p1_kick[i]);
 
     for (int i = 0; p1_move[i]; i++)
-        osd.wr_char(p1_instr_col + i, instr_row2, p1_move[i]);
+        hud.put_char(p1_instr_col + i, instr_row2, p1_move[i]);
 
     // ==== Player 2 Instructions ====
     const char *p2_kick = "Move: \x1B \x18 \x1A";
@@ -258,11 +366,12 @@ void draw_score_and_timer() {
     int instr_row4 = 2;
 
     for (int i = 0; p2_kick[i]; i++)
-        osd.wr_char(p2_instr_col + i, instr_row3, p2_kick[i]);
+        hud.put_char(p2_instr_col + i, instr_row3, p2_kick[i]);
 
     for (int i = 0; p2_move[i]; i++)
-        osd.wr_char(p2_instr_col + i, instr_row4, p2_move[i]);
+        hud.put_char(p2_instr_col + i, instr_row4, p2_move[i]);
 
+    hud.flush();  // only changed tiles reach the osd core
 }
 
 void draw_splash_credits() {
@@ -290,107 +399,141 @@ void draw_splash_credits() {
 }
 
 
-void update_sprite_positions() {
-    player1.move_xy(p1_x, p1_y);
-    player2.move_xy(p2_x, p2_y);
-    ball   .move_xy(ball_x, ball_y);
+// Blend between the previous and current physics tick; alpha is Q8 (0..ALPHA_ONE)
+static inline int lerp_pos(int prev, int cur, int alpha) {
+    return prev + (((cur - prev) * alpha) >> ALPHA_SHIFT);
+}
+
+static void stage_entity(SpriteCore *sprite, int e, int alpha) {
+    sprites.stage(sprite, lerp_pos(prev.x[e], game.x[e], alpha), lerp_pos(prev.y[e], game.y[e], alpha));
+}
+
+void stage_sprite_positions(int alpha) {
+    stage_entity(&player1, ENT_P1, alpha);
+    stage_entity(&player2, ENT_P2, alpha);
+    stage_entity(&ball, ENT_BALL, alpha);
 
     int post_y = INVISIBLE_LINE_Y - GP_H;
-    goalpost1.move_xy(10,                   post_y);
-    goalpost2.move_xy(SCREEN_W - 10 - GP_W, post_y);
+    sprites.stage(&goalpost1, 10,                   post_y);
+    sprites.stage(&goalpost2, SCREEN_W - 10 - GP_W, post_y);
+}
+
+// Write the staged positions; with the sync status register the writes
+// land in vertical blanking so no sprite shears mid-frame. Playback
+// runs unpaced and commits at once.
+void commit_sprite_positions() {
+    if (vsync_ok && replay_mode() != REPLAY_PLAY)
+        vsync.wait_vblank(idle_tasks);
+    sprites.commit();
+}
 
+void update_sprite_positions(int alpha) {
+    stage_sprite_positions(alpha);
+    commit_sprite_positions();
 }
 
- void reset_positions(bool ball_on_ground) {
-    // ball back to center or floor
-    ball_x = SCREEN_W / 2 - BALL_W / 2;
-    ball_y = ball_on_ground ? (INVISIBLE_LINE_Y - BALL_H) : (SCREEN_H / 2 - BALL_H / 2);
-    ball_vx = 0;
-    ball_vy = ball_on_ground ? 0 : 5;
-
-    // players back on ground line
-    p1_x = 50;
-    p1_y = INVISIBLE_LINE_Y - PLAYER_H;
-    p2_x = SCREEN_W - 50 - PLAYER_W;
-    p2_y = INVISIBLE_LINE_Y - PLAYER_H;
-
-    p1_vy = p2_vy = 0;
-    p1_on_ground = p2_on_ground = ball_on_ground;
+// also called after a reset: no interpolation across it
+void save_prev_positions() {
+    prev = game;   // one block copy
 }
 
-void detect_goal() {
+// game_step() has scored the goal and reset the positions
+void celebrate_goal() {
     const char* goal_msg = "GOLAZO!!!";
     int msg_len = strlen(goal_msg);
     int msg_x = (80 - msg_len) / 2;     // 80 columns on screen
     int msg_y = 15;                     // center vertically (30 rows / 2)
 
-    auto show_golazo = [&]() {
-        osd.set_color(0xFF0, 0x000);  // yellow on black
-        for (int i = 0; i < msg_len; i++) {
-            osd.wr_char(msg_x + i, msg_y, goal_msg[i]);
-        }
-        play_goal_tune();
-        sleep_ms(1000);  // let message stay briefly
-        osd.clr_screen();  // clear it before next play
-    };
-
-    // Left goal: ball’s right edge fully past the left post’s inner X
-    if (ball_x + BALL_W < POST_INNER_LEFT) {
-        p2_score++;
-        show_golazo();
-        reset_positions(false); // ball starts in air
-        update_sprite_positions();
-        return;
+    osd.set_color(0xFF0, 0x000);  // yellow on black
+    for (int i = 0; i < msg_len; i++) {
+        osd.wr_char(msg_x + i, msg_y, goal_msg[i]);
     }
+    play_goal_tune();  // queued; plays out during the pause
+    idle_ms(1000);     // let message stay briefly
+    vsync.resync();    // not a dropped frame
+    osd.clr_screen();  // clear it before next play
 
-    // Right goal: ball’s left edge fully past the right post’s inner X
-    if (ball_x > POST_INNER_RIGHT) {
-        p1_score++;
-        show_golazo();
-        reset_positions(false); // ball starts in air
-        update_sprite_positions();
-        return;
-    }
+    save_prev_positions();
+    update_sprite_positions();
 }
 
-void handle_ps2_input() {
-    static bool break_code = false;
+// Apply key events for one physics tick; during playback the live
+// keyboard is ignored and the logged events are applied instead
+void handle_ps2_input(uint32_t tick) {
+    KeyEvent ev;
+
+    kbd.poll();
+    while (kbd.next_event(&ev)) {
+        if (replay_mode() == REPLAY_PLAY)
+            continue;
+        replay_record(tick, ev);
+        keys.apply(ev);
+    }
+    while (replay_next(tick, &ev)) {
+        keys.apply(ev);
+    }
+}
 
-    while (!ps2.rx_fifo_empty()) {
-        int code = ps2.rx_byte();
+// Consume buffered key events; true if Enter was pressed
+bool enter_pressed() {
+    KeyEvent ev;
+    bool pressed = false;
 
-        if (code == 0xF0) {
-            break_code = true;
-        } else {
-            if (break_code) {
-                key_state[code] = false;  // Key released
-                break_code = false;
-            } else {
-                key_state[code] = true;   // Key pressed
-            }
-        }
+    kbd.poll();
+    while (kbd.next_event(&ev)) {
+        if (ev.code == KEY_ENTER && !ev.is_break)
+            pressed = true;
     }
+    return pressed;
 }
 
-void process_controls() {
-    // - Player 1 Movement -
-    if (key_state[0x1C]) p1_x -= 5;            // A
-    if (key_state[0x23]) p1_x += 5;            // D
-    if (key_state[0x1D] && p1_on_ground) {     // W
-        p1_vy = JUMP_VELOCITY;
-        p1_on_ground = false;
-    }
+// Periodic jobs run while idle: music/notes, splash prompt, scoreboard
+void init_tasks() {
+    task_audio  = tasks.add(audio_tick, AUDIO_TASK_US);
+    task_prompt = tasks.add(flash_prompt, PROMPT_TASK_US);
+    task_hud    = tasks.add(draw_score_and_timer, HUD_TASK_US);
+    tasks.enable(task_audio, true);
+}
+
+// Idle hook: drain the PS/2 FIFO, keep the netplay link going and
+// run the tasks that are due
+void idle_tasks() {
+    kbd.poll();
+    net.service();
+    tasks.run();
+}
+
+// Wait ms milliseconds, running the idle hook
+void idle_ms(unsigned long ms) {
+    uint32_t end = sched_now() + ms * SYS_CLK_FREQ * 1000;
+
+    do {
+        idle_tasks();
+    } while (!sched_due(sched_now(), end));
+}
 
-    // - Player 2 Movement -
-    if (key_state[0x6B]) p2_x -= 5;            // <- Arrow
-    if (key_state[0x74]) p2_x += 5;            // -> Arrow
-    if (key_state[0x75] && p2_on_ground) {     // ^ Arrow
-        p2_vy = JUMP_VELOCITY;
-        p2_on_ground = false;
+// Wait until every queued note has played
+void wait_audio() {
+    while (audio_busy()) {
+        idle_ms(1);
     }
+}
+
+// Keys held for this tick -> IN_* bits of one player
+uint8_t player_input(int left, int right, int jump, int kick) {
+    uint8_t in = 0;
 
-    // - Kick‐sprite toggle for P1 (Space = 0x29) -
-    if (key_state[0x29]) {
+    if (keys.is_down(left))  in |= IN_LEFT;
+    if (keys.is_down(right)) in |= IN_RIGHT;
+    if (keys.is_down(jump))  in |= IN_JUMP;
+    if (keys.is_down(kick))  in |= IN_KICK;
+    return in;
+}
+
+// Movement is simulated by game_step(); only the sprites are driven here
+void process_controls(uint8_t p1_in, uint8_t p2_in) {
+    // - Kick‐sprite toggle for P1 (Space) -
+    if (p1_in & IN_KICK) {
         if (!p1_kick) {
             p1_kick = true;
             player1.bypass(0);
@@ -401,8 +544,8 @@ void process_controls() {
         p1_kick = false;
     }
 
-    // - Kick‐sprite toggle for P2 (P = 0x4D) -
-    if (key_state[0x4D]) {
+    // - Kick‐sprite toggle for P2 (P) -
+    if (p2_in & IN_KICK) {
         if (!p2_kick) {
             p2_kick = true;
             player2.bypass(0);
@@ -412,55 +555,133 @@ void process_controls() {
         if (p2_kick) player2.wr_ctrl(0x00);
         p2_kick = false;
     }
+}
 
-    // - Manual clamping on screen -
-    if (p1_x < 0) p1_x = 0;
-    else if (p1_x > SCREEN_W - PLAYER_W) p1_x = SCREEN_W - PLAYER_W;
+// Netplay: keep the link going until both boards hold every input of
+// the match, so the final score is the same on both (bounded wait)
+void settle_netplay() {
+    uint32_t end = sched_now() + NET_SETTLE_MS * SYS_CLK_FREQ * 1000;
 
-    if (p2_x < 0) p2_x = 0;
-    else if (p2_x > SCREEN_W - PLAYER_W) p2_x = SCREEN_W - PLAYER_W;
+    while (!net.settled() && !sched_due(sched_now(), end)) {
+        idle_tasks();
+    }
 }
 
 void game_loop() {
-  start_time = now_ms();
-  unsigned long last_collision_time = 0;
-
-  while (!game_over) {
-    unsigned long now = now_ms(); //  Get this once per frame
+  uint32_t backlog = 0;                  // wall time not yet simulated (clocks)
+  uint32_t last_tick = now_tick32();
+  bool fast = (replay_mode() == REPLAY_PLAY);  // playback: no real-time pacing
 
-    handle_ps2_input();
-    process_controls();
+  save_prev_positions();
 
-    apply_gravity_and_ground();
-    update_ball_motion();
+  prof_reset();
+  pacer.start();
+  vsync.start();
+  tasks.enable(task_hud, true);
 
-    // === Player-Ball Collision ===
-    bool is_p1_kicking = key_state[0x29];  // spacebar
-    bool is_p2_kicking = key_state[0x4D];  // P key
-
-    handle_player_ball_collision(p1_x, p1_y, is_p1_kicking, now, last_collision_time, 1);
-    handle_player_ball_collision(p2_x, p2_y, is_p2_kicking, now, last_collision_time, 2);
+  while (!game_over) {
+    bool scored = false;
+    {
+        PROF_ZONE(PROF_FRAME);   // idle time and goal celebrations excluded
+        uint32_t now = now_tick32();
+        backlog += now - last_tick;       // 32-bit wrap-safe difference
+        last_tick = now;
+        if (backlog > MAX_BACKLOG_CLKS)
+            backlog = MAX_BACKLOG_CLKS;
+        if (fast)
+            backlog = PHYSICS_TICK_CLKS;
+
+        // === Fixed-timestep physics: run every tick that is due ===
+        while (backlog >= PHYSICS_TICK_CLKS) {
+            uint8_t p1_in, p2_in;
+            int ev;
+            {
+                PROF_ZONE(PROF_INPUT);
+                handle_ps2_input(game.tick);   // events queued since the previous tick
+                save_prev_positions();
+                p1_in = player_input(KEY_A, KEY_D, KEY_W, KEY_SPACE);
+                p2_in = player_input(KEY_LEFT, KEY_RIGHT, KEY_UP, KEY_P);
+            }
+            {
+                PROF_ZONE(PROF_PHYSICS);
+                if (netplay_on) {
+                    // either key set drives this board's player; the
+                    // other player's input comes over the link
+                    ev = net.step(p1_in | p2_in);
+                    p1_in = net.input(ENT_P1);
+                    p2_in = net.input(ENT_P2);
+                } else {
+                    ev = game_step(game, p1_in, p2_in);
+                    replay_tick_done(game);
+                }
+            }
+            if (ev < 0)
+                break;      // peer behind: the tick stays in the backlog
+            process_controls(p1_in, p2_in);
+            backlog -= PHYSICS_TICK_CLKS;
 
+            if (ev & EV_MATCH_OVER) {
+                game_over = true;
+                break;
+            }
+            if (ev & (EV_GOAL_P1 | EV_GOAL_P2)) {
+                scored = true;
+                break;
+            }
+        }
 
-    detect_goal();
-    update_sprite_positions();
-    draw_score_and_timer();
+        // === Render: interpolate sprites by the fraction of a tick left over ===
+        // a tick loop left early (netplay peer behind) keeps whole ticks
+        // in the backlog: show the current state, never extrapolate
+        if (!scored) {
+            int alpha = (backlog >= PHYSICS_TICK_CLKS) ? ALPHA_ONE :
+                        (int)((backlog << ALPHA_SHIFT) / PHYSICS_TICK_CLKS);
+            PROF_ZONE(PROF_SPRITES);
+            stage_sprite_positions(alpha);
+        }
+    }
 
-    if ((now - start_time) / 1000 >= MATCH_DURATION_SEC) {
-        game_over = true;
+    // a goal ends the frame with the celebration, outside PROF_FRAME
+    if (scored) {
+        {
+            PROF_ZONE(PROF_GOAL);
+            celebrate_goal();
+        }
+        // celebration stalled the clock; restart the accumulator
+        backlog = 0;
+        last_tick = now_tick32();
+        pacer.resync();
+        PROF_ZONE(PROF_SPRITES);
+        stage_sprite_positions(0);   // positions saved by celebrate_goal()
     }
 
-    sleep_ms(30);
+    // vsync: the frame ends with the commit in vertical blanking;
+    // otherwise commit now and wait for the next frame deadline.
+    // The hud task redraws the score while waiting.
+    commit_sprite_positions();
+    if (!fast && !vsync_ok)
+        pacer.wait(idle_tasks);
+  }
+  if (netplay_on)
+      settle_netplay();
+  draw_score_and_timer();   // final score and time
+  tasks.enable(task_hud, false);
+  if (!netplay_on) {        // the uart carries the link in netplay
+      prof_report(&uart);   // _PROFILE builds: zone table over uart per match
+#ifdef _PROFILE
+      if (vsync_ok)
+          vsync.report(&uart);
+      else
+          pacer.report(&uart);
+#endif
   }
+  replay_end(game.score[0], game.score[1]);
 
     // Game over message
-    char win_msg[30];
-    bool is_draw = (p1_score == p2_score);
-    if (is_draw) {
-        sprintf(win_msg, "Draw!!!");
-    } else {
-        sprintf(win_msg, "Player %d has won!!!", (p1_score > p2_score) ? 1 : 2);
-    }
+    bool is_draw = (game.score[0] == game.score[1]);
+    const char *win_msg = is_draw ? "Draw!!!" :
+                          (game.score[0] > game.score[1]) ? "Player 1 has won!!!"
+                                                          : "Player 2 has won!!!";
 
     int win_len = strlen(win_msg);
     int win_x = (80 - win_len) / 2;
@@ -474,9 +695,9 @@ void game_loop() {
         osd.set_color(0x080, 0x000);  // green on black
         for (int j = 0; j < win_len; j++) {
             osd.wr_char(win_x + j, y_pos, (i % 2 == 0) ? win_msg[j] : ' ');
-            //play_note(theme[i].freq, theme[i].duration);
         }
-        play_note(theme[i].freq, theme[i].duration);
+        play_note(theme[i].fcw, theme[i].duration);
+        wait_audio();  // one flash per note
     }
 
     // ==== Phase 2: Flash both winner/draw and restart messages ====
@@ -486,9 +707,9 @@ void game_loop() {
     int restart_x = (80 - restart_len) / 2;
 
     bool show_text = true;
-    bool enter_pressed = false;
+    bool restart = false;
 
-    while (!enter_pressed) {
+    while (!restart) {
         // Flash winner and prompt
         if (show_text) {
             for (int i = 0; i < win_len; i++) osd.wr_char(win_x + i, y_pos, win_msg[i]);
@@ -499,46 +720,61 @@ void game_loop() {
         }
 
         show_text = !show_text;
-        sleep_ms(700);
+        idle_ms(700);
 
-        // Check for Enter (scan code 0x5A) press only
-        while (!ps2.rx_fifo_empty()) {
-            int code = ps2.rx_byte();
-            if (code == 0x5A) {
-                enter_pressed = true;
-                break;
-            }
-            if (code == 0xF0) {
-                // skip break codes
-                (void)ps2.rx_byte();
-            }
-        }
+        // Check for Enter press only
+        restart = enter_pressed();
     }
 }
 
 int main() {
     init_audio(&ddfs, &adsr);
-    load_goalposts();
+    init_tasks();
+    load_sprite_art();
+    vsync_ok = vsync.probe();
 
     while (true) {
-        reset_positions(true);
+        game_init(game, 0);     // splash: ball resting on the ground
+        save_prev_positions();
         update_sprite_positions();
-        p1_score = p2_score = 0;
         game_over = false;
 
+        // sw 4 on: the players swap characters
+        if (sw.read(4) != players_swapped)
+            load_player_art(sw.read(4));
         player1.bypass(0);
         player2.bypass(0);
-        bar.bypass(0);
+        // sw 3 on: frame buffer pitch behind the sprites instead of the
+        // bar core scene (drawn on first use)
+        if (sw.read(3) && !pitch_drawn) {
+            draw_pitch();
+            pitch_drawn = true;
+        }
+        bar.bypass(sw.read(3));
         ball.bypass(0);
         goalpost1.bypass(0);
         goalpost2.bypass(0);
         osd.bypass(0);
 
-        while (!ps2.rx_fifo_empty()) (void)ps2.rx_byte();
-        starting_splash_screen(&osd, &ps2);
+        kbd.flush();
+        keys.clear();
+        starting_splash_screen(&osd, &kbd);
         show_countdown(&osd);
 
-        reset_positions(false);
+        // sw 0 on: record the match and dump the log over uart at the end
+        // sw 1 on: play against a second board on the uart (no recording);
+        //          sw 2 selects the player of this board (off: player 1)
+        net.end();
+        netplay_on = sw.read(1) && replay_mode() != REPLAY_PLAY;
+        if (replay_mode() == REPLAY_PLAY)
+            replay_begin(REPLAY_PLAY, 0);
+        else
+            replay_begin((sw.read(0) && !netplay_on) ? REPLAY_RECORD : REPLAY_OFF, now_us());
+        game_init(game, netplay_on ? net_match + 1u : replay_seed());
+        game_reset_positions(game, false);
+        if (netplay_on)
+            net.begin(&game, sw.read(2) ? ENT_P2 : ENT_P1, net_match++);
+        save_prev_positions();
         update_sprite_positions();
         game_loop();
     }
@@ -0,0 +1,253 @@
+/*****************************************************************//**
+ * @file netplay.cpp
+ *
+ * @brief implementation of the rollback netplay session
+ *
+ ********************************************************************/
+
+#include <string.h>
+#include "netplay.h"
+#include "scheduler.h"
+
+uint16_t net_crc16(const uint8_t *p, int n) {
+   uint16_t crc = 0xffff;
+   int i, b;
+
+   for (i = 0; i < n; i++) {
+      crc ^= (uint16_t) (p[i] << 8);
+      for (b = 0; b < 8; b++)
+         crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021)
+               : (uint16_t) (crc << 1);
+   }
+   return (crc);
+}
+
+Netplay::Netplay(UartCore *port) {
+   this->port = port;
+   state = 0;
+   active = false;
+   saved_baud = 0;
+   local = ENT_P1;
+   match_id = 0;
+   cur = 0;
+   remote_ok = -1;
+   peer_ack = -1;
+   redo_from = -1;
+   last_send = 0;
+   rx_len = 0;
+   memset(&st, 0, sizeof(st));
+}
+
+Netplay::~Netplay() {
+}
+
+void Netplay::begin(GameState *s, int player, uint8_t match) {
+   state = s;
+   local = player;
+   match_id = match;
+   cur = 0;
+   remote_ok = -1;
+   peer_ack = -1;
+   redo_from = -1;
+   memset(in_local, 0, sizeof(in_local));
+   memset(in_remote, 0, sizeof(in_remote));
+   memset(&st, 0, sizeof(st));
+   if (!active)
+      saved_baud = port->get_baud_rate();
+   port->set_baud_rate(BAUD);
+   // bytes left over from the previous match
+   while (port->rx_byte() >= 0) {
+   }
+   rx_len = 0;
+   active = true;
+   send();     // the peer learns that this board is in the match
+}
+
+void Netplay::end() {
+   if (active)
+      port->set_baud_rate(saved_baud);
+   active = false;
+}
+
+// tick number nearest to the local one with these low 16 bits
+int32_t Netplay::widen(uint16_t t) const {
+   return (cur + (int16_t) (t - (uint16_t) cur));
+}
+
+// the remote player keeps doing what it last did
+uint8_t Netplay::predict() const {
+   return ((remote_ok < 0) ? 0 : in_remote[remote_ok % RING_LEN]);
+}
+
+int Netplay::run_tick(int32_t f) {
+   int slot = f % RING_LEN;
+   uint8_t in[2];
+
+   snap[slot] = *state;
+   if (f > remote_ok)
+      in_remote[slot] = predict();
+   in[local] = in_local[slot];
+   in[1 - local] = in_remote[slot];
+   return (game_step(*state, in[0], in[1]));
+}
+
+// events of re-run ticks are dropped: sounds and goals were played
+// (or not) when the tick first ran; the state itself is corrected
+void Netplay::rollback() {
+   uint32_t depth;
+   int32_t f;
+
+   if (redo_from < 0)
+      return;
+   depth = (uint32_t) (cur - redo_from);
+   *state = snap[redo_from % RING_LEN];
+   physics_sound(false);
+   for (f = redo_from; f < cur; f++)
+      run_tick(f);
+   physics_sound(true);
+   redo_from = -1;
+   st.rollbacks++;
+   st.resim_ticks += depth;
+   if (depth > st.max_depth)
+      st.max_depth = depth;
+}
+
+int Netplay::step(uint8_t local_in) {
+   int ev;
+
+   receive();
+   rollback();
+   if (cur - remote_ok > MAX_AHEAD || cur - peer_ack >= RING_LEN) {
+      st.stalls++;
+      return (-1);
+   }
+   in_local[cur % RING_LEN] = local_in;
+   ev = run_tick(cur);
+   cur++;
+   st.ticks++;
+   send();
+   return (ev);
+}
+
+void Netplay::service() {
+   if (!active)
+      return;
+   receive();
+   rollback();
+   if (sched_due(sched_now(), last_send + RESEND_US * SYS_CLK_FREQ))
+      send();
+}
+
+bool Netplay::settled() const {
+   return (remote_ok >= cur - 1 && peer_ack >= cur - 1 && redo_from < 0);
+}
+
+uint8_t Netplay::input(int player) const {
+   int slot = (cur + RING_LEN - 1) % RING_LEN;
+
+   if (cur == 0)
+      return (0);
+   return ((player == local) ? in_local[slot] : in_remote[slot]);
+}
+
+/**********************************************************************
+ * packets
+ *********************************************************************/
+// local inputs not yet acknowledged, with the ack of the remote ones
+void Netplay::send() {
+   uint8_t pkt[MAX_PACKET];
+   int32_t first = peer_ack + 1;
+   int n = (int) (cur - first);
+   int i, len;
+   uint16_t crc;
+
+   pkt[0] = SYNC;
+   pkt[1] = match_id;
+   pkt[2] = (uint8_t) cur;
+   pkt[3] = (uint8_t) (cur >> 8);
+   pkt[4] = (uint8_t) remote_ok;
+   pkt[5] = (uint8_t) (remote_ok >> 8);
+   pkt[6] = (uint8_t) n;
+   for (i = 0; i < n; i++)
+      pkt[HEAD_LEN + i] = in_local[(first + i) % RING_LEN];
+   len = HEAD_LEN + n;
+   crc = net_crc16(pkt, len);
+   pkt[len++] = (uint8_t) crc;
+   pkt[len++] = (uint8_t) (crc >> 8);
+   for (i = 0; i < len; i++)
+      port->tx_byte(pkt[i]);
+   st.pkt_sent++;
+   last_send = sched_now();
+}
+
+void Netplay::receive() {
+   int c;
+
+   while ((c = port->rx_byte()) >= 0) {
+      if (rx_len == 0 && c != SYNC)
+         continue;            // noise between packets
+      rx_buf[rx_len++] = (uint8_t) c;
+      rx_frame();
+   }
+}
+
+// act on the bytes buffered so far; a bad packet is searched for the
+// next sync byte, which may start a good one
+void Netplay::rx_frame() {
+   int need, i;
+   uint16_t crc;
+
+   while (rx_len >= HEAD_LEN) {
+      if (rx_buf[HEAD_LEN - 1] <= RING_LEN) {
+         need = HEAD_LEN + rx_buf[HEAD_LEN - 1] + 2;
+         if (rx_len < need)
+            return;
+         crc = net_crc16(rx_buf, need - 2);
+         if (rx_buf[need - 2] == (uint8_t) crc
+               && rx_buf[need - 1] == (uint8_t) (crc >> 8)) {
+            if (rx_buf[1] == match_id) {
+               st.pkt_recv++;
+               rx_packet();
+            } else {
+               st.pkt_bad++;
+            }
+            rx_len = 0;
+            return;
+         }
+      }
+      st.pkt_bad++;
+      for (i = 1; i < rx_len && rx_buf[i] != SYNC; i++) {
+      }
+      memmove(rx_buf, rx_buf + i, rx_len - i);
+      rx_len -= i;
+   }
+}
+
+void Netplay::rx_packet() {
+   int32_t frame = widen((uint16_t) (rx_buf[2] | rx_buf[3] << 8));
+   int32_t ack = widen((uint16_t) (rx_buf[4] | rx_buf[5] << 8));
+   int n = rx_buf[HEAD_LEN - 1];
+   int32_t f;
+   uint8_t v;
+   int i;
+
+   if (ack > peer_ack && ack < cur)
+      peer_ack = ack;
+   // inputs arrive in order; anything past a gap or beyond the
+   // prediction window is not from a well-behaved peer
+   for (i = 0; i < n; i++) {
+      f = frame - n + i;
+      if (f <= remote_ok)
+         continue;
+      if (f != remote_ok + 1 || f >= cur + MAX_AHEAD)
+         break;
+      v = rx_buf[HEAD_LEN + i];
+      if (f < cur && in_remote[f % RING_LEN] != v) {
+         st.mispredicts++;
+         if (redo_from < 0 || f < redo_from)
+            redo_from = f;
+      }
+      in_remote[f % RING_LEN] = v;
+      remote_ok = f;
+   }
+}
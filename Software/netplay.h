@@ -0,0 +1,157 @@
+/*****************************************************************//**
+ * @file netplay.h
+ *
+ * @brief rollback netplay of one match between two boards over uart
+ *
+ * Description:
+ *  - each board runs the full simulation (GameState + game_step()) and
+ *    owns one player; only inputs cross the link
+ *  - every tick the local input is sent at once and the remote input
+ *    is predicted (the last confirmed one is repeated), so the local
+ *    player never waits for the link
+ *  - the state before every unconfirmed tick is kept in a ring of
+ *    snapshots; a confirmed remote input that differs from the
+ *    prediction restores the snapshot of that tick and re-simulates
+ *    up to the present (sound muted) with the corrected input
+ *  - a board stalls (step() returns -1) while it is MAX_AHEAD ticks
+ *    past the last confirmed remote input or RING_LEN-1 ticks past
+ *    the last acknowledged local one; this bounds the rollback depth
+ *    and the memory (RING_LEN ticks of state and input)
+ *  - packet, little-endian, CRC-16-CCITT over all bytes before it:
+ *      0xa5 | match | frame(2) | ack(2) | n | input x n | crc(2)
+ *    - frame: first tick the sender has not run; the inputs are the
+ *      sender's own for ticks frame-n .. frame-1
+ *    - ack: last tick of the receiver's inputs the sender holds
+ *    - ticks travel as 16 bits and are widened around the local tick
+ *  - all unacknowledged inputs go in every packet, so a lost packet
+ *    costs latency, not a resend; a board that has not sent for
+ *    RESEND_US (stalled or past the match end) sends again
+ *  - statistics: rollbacks, re-simulated ticks, deepest rollback,
+ *    mispredicted ticks, stalls, packets
+ *
+ ********************************************************************/
+
+#ifndef _NETPLAY_H_INCLUDED
+#define _NETPLAY_H_INCLUDED
+
+#include "chu_init.h"
+#include "game_physics.h"
+
+/**
+ * rollback session:
+ *  - begin() at the start of a match, step() once per physics tick,
+ *    service() from the idle hook
+ */
+class Netplay {
+public:
+   /**
+    * symbolic constants
+    */
+   enum {
+      RING_LEN = 16,        /**< ticks of snapshots and inputs kept */
+      MAX_AHEAD = 8,        /**< ticks run past the confirmed remote input */
+      SYNC = 0xa5,          /**< first byte of a packet */
+      HEAD_LEN = 7,         /**< sync .. n */
+      MAX_PACKET = HEAD_LEN + RING_LEN + 2,
+      BAUD = 115200,
+      RESEND_US = 30000
+   };
+
+   /* counters since begin() */
+   struct Stats {
+      uint32_t ticks;        /**< ticks run by step() */
+      uint32_t stalls;       /**< step() calls refused */
+      uint32_t rollbacks;
+      uint32_t resim_ticks;  /**< ticks re-run by rollbacks */
+      uint32_t max_depth;    /**< deepest rollback (ticks) */
+      uint32_t mispredicts;  /**< ticks whose remote input was wrong */
+      uint32_t pkt_sent;
+      uint32_t pkt_recv;
+      uint32_t pkt_bad;      /**< crc, framing or match id */
+   };
+
+   /**
+    * constructor
+    * @param port uart core wired to the other board
+    */
+   Netplay(UartCore *port);
+   ~Netplay();                  // not used
+
+   /**
+    * start a match on the given state (already initialized the same
+    * way on both boards); switches the port to BAUD until end()
+    * @param s state simulated by step()
+    * @param player local player (ENT_P1 or ENT_P2)
+    * @param match match id; packets of other matches are dropped
+    */
+   void begin(GameState *s, int player, uint8_t match);
+
+   /**
+    * stop the session (no more resends); the port gets back the baud
+    * rate it had before begin() (the debug uart, when not linked)
+    */
+   void end();
+
+   /**
+    * run one tick with the local input and a predicted remote one
+    * @param local_in IN_* bits of the local player
+    * @return EV_* bits of the tick; -1 if stalled (tick not run)
+    */
+   int step(uint8_t local_in);
+
+   /**
+    * receive, roll back if an input was mispredicted, resend if idle
+    */
+   void service();
+
+   /**
+    * true once every tick run so far is confirmed on both boards
+    * (the state is final and the same on both)
+    */
+   bool settled() const;
+
+   /* input used by the last tick run */
+   uint8_t input(int player) const;
+   /* ticks run */
+   int32_t frame() const { return cur; }
+   /* last tick with a confirmed remote input (-1: none) */
+   int32_t confirmed() const { return remote_ok; }
+   const Stats &stats() const { return st; }
+
+private:
+   UartCore *port;
+   GameState *state;
+   bool active;
+   int saved_baud;           // port rate before begin()
+   int local;
+   uint8_t match_id;
+   int32_t cur;              // next tick to run
+   int32_t remote_ok;        // last tick with a confirmed remote input
+   int32_t peer_ack;         // last local tick the peer holds
+   int32_t redo_from;        // first tick to re-run; -1: none
+   uint32_t last_send;
+   GameState snap[RING_LEN]; // state before tick f at f % RING_LEN
+   uint8_t in_local[RING_LEN];
+   uint8_t in_remote[RING_LEN];  // confirmed or predicted
+   uint8_t rx_buf[MAX_PACKET];
+   int rx_len;
+   Stats st;
+
+   int32_t widen(uint16_t t) const;
+   uint8_t predict() const;
+   int run_tick(int32_t f);
+   void rollback();
+   void send();
+   void receive();
+   void rx_frame();
+   void rx_packet();
+};
+
+/**
+ * CRC-16-CCITT (polynomial 0x1021, initial value 0xffff)
+ * @param p data
+ * @param n number of bytes
+ */
+uint16_t net_crc16(const uint8_t *p, int n);
+
+#endif  // _NETPLAY_H_INCLUDED
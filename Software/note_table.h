@@ -0,0 +1,82 @@
+/*****************************************************************//**
+ * @file note_table.h
+ *
+ * @brief compile-time music note frequency control words (FCW)
+ *
+ * Description:
+ *  - equal temperament (A4 = 440 Hz), octave 0 (C0) to octave 8 (B8)
+ *  - note_fcw() and NOTE_FCW[] are constexpr; constant notes are
+ *    converted at compile time and played with DdfsCore::set_carrier_fcw()
+ *  - fcw = round(f * 2^PHA_WIDTH / system clock); 1 fcw step is
+ *    0.093 Hz, so the rounding error is at most 0.51 cent from C3 up
+ *    (4.2 cents in octave 0)
+ *
+ *********************************************************************/
+
+#ifndef _NOTE_TABLE_H_INCLUDED
+#define _NOTE_TABLE_H_INCLUDED
+
+#include "chu_init.h"
+#include "ddfs_core.h"
+
+enum {
+   NOTE_OCTAVES = 9,                    /**< octave 0 to 8 */
+   NOTE_PER_OCTAVE = 12
+};
+
+/**
+ * 2^(k/12) by repeated multiplication (c++11 constexpr: no pow())
+ * @param k semitone count (positive or negative)
+ */
+constexpr double semitone_ratio(int k) {
+   return (k == 0) ? 1.0 :
+          (k > 0) ? 1.0594630943592953 * semitone_ratio(k - 1) :
+                    semitone_ratio(k + 1) / 1.0594630943592953;
+}
+
+/**
+ * equal-temperament frequency of a note
+ * @param oct octave (4 for the octave containing A4)
+ * @param ni note index (0:C, 1:C#, ..., 11:B)
+ * @return frequency in Hz
+ */
+constexpr double note_hz(int oct, int ni) {
+   return 440.0 * semitone_ratio((oct - 4) * NOTE_PER_OCTAVE + ni - 9);
+}
+
+/**
+ * convert a frequency to a ddfs carrier frequency control word
+ * @param hz frequency in Hz
+ * @return fcw rounded to nearest
+ */
+constexpr uint32_t hz_to_fcw(double hz) {
+   return (uint32_t) (hz * (double) (1UL << DdfsCore::PHA_WIDTH)
+         / (SYS_CLK_FREQ * 1000000.0) + 0.5);
+}
+
+/**
+ * fcw of a note
+ * @param oct octave
+ * @param ni note index (0:C, 1:C#, ..., 11:B)
+ */
+constexpr uint32_t note_fcw(int oct, int ni) {
+   return hz_to_fcw(note_hz(oct, ni));
+}
+
+#define NOTE_FCW_OCTAVE(o) \
+   note_fcw(o, 0), note_fcw(o, 1), note_fcw(o, 2), note_fcw(o, 3), \
+   note_fcw(o, 4), note_fcw(o, 5), note_fcw(o, 6), note_fcw(o, 7), \
+   note_fcw(o, 8), note_fcw(o, 9), note_fcw(o, 10), note_fcw(o, 11)
+
+/* fcw table indexed by oct*12 + ni */
+constexpr uint32_t NOTE_FCW[NOTE_OCTAVES * NOTE_PER_OCTAVE] = {
+   NOTE_FCW_OCTAVE(0), NOTE_FCW_OCTAVE(1), NOTE_FCW_OCTAVE(2),
+   NOTE_FCW_OCTAVE(3), NOTE_FCW_OCTAVE(4), NOTE_FCW_OCTAVE(5),
+   NOTE_FCW_OCTAVE(6), NOTE_FCW_OCTAVE(7), NOTE_FCW_OCTAVE(8)
+};
+
+#undef NOTE_FCW_OCTAVE
+
+static_assert(NOTE_FCW[4 * NOTE_PER_OCTAVE + 9] == 4724, "A4 fcw");
+
+#endif  // _NOTE_TABLE_H_INCLUDED
@@ -0,0 +1,66 @@
+/*****************************************************************//**
+ * @file num_fmt.cpp
+ *
+ * @brief implementation of the integer formatters
+ *
+ ********************************************************************/
+
+#include "num_fmt.h"
+#include "tick_div.h"
+
+const char NUM_PAIRS[200] = {
+   '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+   '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+   '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+   '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+   '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+   '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+   '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+   '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+   '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+   '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+int fmt_uint(char *buf, uint32_t v, int width, char pad) {
+   char rev[FMT_UINT_MAX_LEN];   // digits, lowest first
+   int n = 0, len, i;
+   uint32_t q, r;
+
+   while (v >= 100) {
+      q = RecipDiv<100>::div(v);
+      r = v - q * 100;
+      rev[n++] = NUM_PAIRS[2 * r + 1];
+      rev[n++] = NUM_PAIRS[2 * r];
+      v = q;
+   }
+   if (v >= 10) {
+      rev[n++] = NUM_PAIRS[2 * v + 1];
+      rev[n++] = NUM_PAIRS[2 * v];
+   } else {
+      rev[n++] = (char) ('0' + v);
+   }
+   len = (width > n) ? width : n;
+   for (i = 0; i < len - n; i++)
+      buf[i] = pad;
+   for (; i < len; i++)
+      buf[i] = rev[len - 1 - i];
+   buf[len] = '\0';
+   return (len);
+}
+
+// minutes of a time below 65536 s with one 32-bit multiply:
+// 34953 = ceil(2^21 / 60); (sec * 34953) >> 21 is exact up to 74898 s
+// and the product fits 32 bits
+int fmt_mmss(char *buf, uint32_t sec) {
+   uint32_t m, s;
+   int n;
+
+   m = (sec < 65536) ? (sec * 34953) >> 21 : RecipDiv<60>::div(sec);
+   s = sec - m * 60;
+   n = fmt_uint(buf, m, 2, '0');
+   buf[n++] = ':';
+   buf[n++] = NUM_PAIRS[2 * s];
+   buf[n++] = NUM_PAIRS[2 * s + 1];
+   buf[n] = '\0';
+   return (n);
+}
@@ -0,0 +1,54 @@
+/*****************************************************************//**
+ * @file num_fmt.h
+ *
+ * @brief integer-only decimal formatting (no printf)
+ *
+ * Description:
+ *  - right-aligned unsigned decimal in a fixed-width field, padded
+ *    with ' ' or '0', and MM:SS
+ *  - values under 100 take both digits from a 200-byte table of
+ *    digit pairs: no divide, no multiply
+ *  - larger values are split into pairs by RecipDiv<100> (multiply
+ *    and shift, tick_div.h); minutes and seconds by one 32-bit
+ *    multiply and shift
+ *  - stands in for sprintf("%d") / sprintf("%02d:%02d"), which pull
+ *    newlib's vfprintf into the image
+ *
+ ********************************************************************/
+
+#ifndef _NUM_FMT_H_INCLUDED
+#define _NUM_FMT_H_INCLUDED
+
+#include <inttypes.h>
+
+/**
+ * symbolic constants
+ */
+enum {
+   FMT_UINT_MAX_LEN = 10     /**< digits of a 32-bit value */
+};
+
+/**
+ * digit pairs "00" "01" .. "99"
+ */
+extern const char NUM_PAIRS[200];
+
+/**
+ * format an unsigned integer, right-aligned
+ * @param buf output; at least max(width, FMT_UINT_MAX_LEN) + 1 chars
+ * @param v value
+ * @param width minimum field width (0: as many digits as needed)
+ * @param pad fill char left of the digits (' ' or '0')
+ * @return chars written, terminating 0 not counted
+ */
+int fmt_uint(char *buf, uint32_t v, int width, char pad);
+
+/**
+ * format a time as MM:SS (more minute digits past 99 minutes)
+ * @param buf output; at least 12 chars
+ * @param sec time in seconds
+ * @return chars written, terminating 0 not counted
+ */
+int fmt_mmss(char *buf, uint32_t sec);
+
+#endif  // _NUM_FMT_H_INCLUDED
@@ -0,0 +1,72 @@
+/*****************************************************************//**
+ * @file osd_canvas.cpp
+ *
+ * @brief implementation of OsdCanvas class
+ *
+ ********************************************************************/
+
+#include <string.h>
+#include "osd_canvas.h"
+#include "num_fmt.h"
+
+OsdCanvas::OsdCanvas(OsdCore *osd_core) {
+   osd = osd_core;
+   memset(back, OsdCore::NULL_CHAR, sizeof(back));
+   used_rows = 0;
+   dirty_rows = 0;
+}
+
+OsdCanvas::~OsdCanvas() {
+}
+
+void OsdCanvas::clear() {
+   int y;
+
+   // only rows holding something need to be blanked (and re-sent)
+   for (y = 0; y < OsdCore::CHAR_Y_MAX; y++) {
+      if (bit_read(used_rows, y))
+         memset(back[y], OsdCore::NULL_CHAR, OsdCore::CHAR_X_MAX);
+   }
+   dirty_rows |= used_rows;
+   used_rows = 0;
+}
+
+void OsdCanvas::put_char(int x, int y, char ch, int reverse) {
+   if (x < 0 || x >= OsdCore::CHAR_X_MAX || y < 0 || y >= OsdCore::CHAR_Y_MAX)
+      return;
+   back[y][x] = (reverse == 1) ? (uint8_t) (ch | 0x80) : (uint8_t) ch;
+   bit_set(used_rows, y);
+   bit_set(dirty_rows, y);
+}
+
+void OsdCanvas::put_str(int x, int y, const char *str) {
+   for (int i = 0; str[i]; i++)
+      put_char(x + i, y, str[i]);
+}
+
+void OsdCanvas::put_uint(int x, int y, uint32_t v, int width, char pad) {
+   char buf[FMT_UINT_MAX_LEN + 1];
+
+   if (width > FMT_UINT_MAX_LEN)
+      width = FMT_UINT_MAX_LEN;
+   fmt_uint(buf, v, width, pad);
+   put_str(x, y, buf);
+}
+
+void OsdCanvas::put_mmss(int x, int y, uint32_t sec) {
+   char buf[FMT_UINT_MAX_LEN + 4];
+
+   fmt_mmss(buf, sec);
+   put_str(x, y, buf);
+}
+
+void OsdCanvas::flush() {
+   int y;
+
+   for (y = 0; y < OsdCore::CHAR_Y_MAX; y++) {
+      // OsdCore drops writes of tiles that already match
+      if (bit_read(dirty_rows, y))
+         osd->wr_span(0, y, back[y], OsdCore::CHAR_X_MAX);
+   }
+   dirty_rows = 0;
+}
@@ -0,0 +1,94 @@
+/*****************************************************************//**
+ * @file profiler.cpp
+ *
+ * @brief implementation of the scoped-zone cycle profiler
+ *
+ * @note compiled only when _PROFILE is defined
+ *
+ ********************************************************************/
+
+#include <string.h>
+#include "profiler.h"
+
+#ifdef _PROFILE
+
+static const char *ZONE_NAMES[PROF_ZONE_COUNT] = { "frame", "input",
+      "physics", "goal", "sprites", "hud" };
+
+static ProfStats stats[PROF_ZONE_COUNT];
+static ProfSample ring[PROF_RING_LEN];
+static uint32_t ring_head = 0;   // total samples recorded
+
+void prof_add(int zone, uint32_t cycles) {
+   ProfStats *s = &stats[zone];
+
+   if (s->count == 0 || cycles < s->min)
+      s->min = cycles;
+   if (cycles > s->max)
+      s->max = cycles;
+   s->count++;
+   s->total += cycles;
+   ring[ring_head % PROF_RING_LEN].cycles = cycles;
+   ring[ring_head % PROF_RING_LEN].zone = (uint8_t) zone;
+   ring_head++;
+}
+
+void prof_reset_on() {
+   int i;
+
+   for (i = 0; i < PROF_ZONE_COUNT; i++) {
+      stats[i].count = 0;
+      stats[i].min = 0;
+      stats[i].max = 0;
+      stats[i].total = 0;
+   }
+   ring_head = 0;
+}
+
+const ProfStats &prof_stats(int zone) {
+   return (stats[zone]);
+}
+
+// print a cycle count followed by its value in us
+static void disp_cycles(UartCore *port, uint32_t cycles) {
+   port->disp((int) cycles, 10, 10);
+   port->disp(" (");
+   port->disp((int) (cycles / SYS_CLK_FREQ));
+   port->disp("us)");
+}
+
+void prof_report_on(UartCore *port) {
+   int i, n, col;
+   uint32_t k;
+
+   port->disp("profile: zone count min/avg/max cycles\n\r");
+   for (i = 0; i < PROF_ZONE_COUNT; i++) {
+      const ProfStats *s = &stats[i];
+      if (s->count == 0)
+         continue;
+      port->disp(ZONE_NAMES[i]);
+      for (n = strlen(ZONE_NAMES[i]); n < 8; n++)
+         port->disp(' ');
+      port->disp((int) s->count, 10, 8);
+      disp_cycles(port, s->min);
+      disp_cycles(port, (uint32_t) (s->total / s->count));
+      disp_cycles(port, s->max);
+      port->disp("\n\r");
+   }
+   // last samples, oldest first
+   n = (ring_head < PROF_RING_LEN) ? ring_head : PROF_RING_LEN;
+   port->disp("profile: last ");
+   port->disp(n);
+   port->disp(" samples (zone:cycles)\n\r");
+   col = 0;
+   for (k = ring_head - n; k != ring_head; k++) {
+      const ProfSample *p = &ring[k % PROF_RING_LEN];
+      port->disp((int) p->zone);
+      port->disp(':');
+      port->disp((int) p->cycles);
+      port->disp((++col % 8 == 0) ? "\n\r" : " ");
+   }
+   port->disp("\n\r");
+}
+
+#endif // _PROFILE
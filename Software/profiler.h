@@ -0,0 +1,113 @@
+/*****************************************************************//**
+ * @file profiler.h
+ *
+ * @brief scoped-zone cycle profiler
+ *
+ * Description:
+ *  - PROF_ZONE(zone) starts a timer that stops at the end of the
+ *    enclosing block (RAII) and accumulates count/min/avg/max cycles
+ *  - cycles come from the system timer (SYS_CLK_FREQ clocks per us);
+ *    32-bit deltas, so a single zone must be shorter than ~42 s
+ *  - the most recent PROF_RING_LEN samples are kept in a fixed ring
+ *  - no heap; all state is static
+ *  - prof_report(port) prints a table over a uart core
+ *  - controlled by _PROFILE (like _DEBUG for debug()): without it the
+ *    macros expand to nothing and no profiler code is linked
+ *  - the host simulation (sim/) provides a virtual timer, so zones can
+ *    be measured off-board with -D_PROFILE (sim/bench_prof.cpp checks
+ *    the statistics on it)
+ *
+ ********************************************************************/
+
+#ifndef _PROFILER_H_INCLUDED
+#define _PROFILER_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * profiled game subsystems
+ */
+enum ProfZone {
+   PROF_FRAME = 0,   /**< one game loop iteration, idle and goals excluded */
+   PROF_INPUT,       /**< key events and player input of a tick */
+   PROF_PHYSICS,     /**< game_step() or the netplay step */
+   PROF_GOAL,        /**< celebrate_goal() after a scored goal */
+   PROF_SPRITES,     /**< stage_sprite_positions() */
+   PROF_HUD,         /**< draw_score_and_timer() (hud task) */
+   PROF_ZONE_COUNT
+};
+
+#define PROF_RING_LEN 256
+
+#ifdef _PROFILE
+
+/**
+ * accumulated statistics of a zone
+ */
+struct ProfStats {
+   uint32_t count;
+   uint32_t min;
+   uint32_t max;
+   uint64_t total;
+};
+
+/**
+ * one recorded sample
+ */
+struct ProfSample {
+   uint32_t cycles;
+   uint8_t zone;
+};
+
+/**
+ * record a sample of a zone.
+ * @param zone zone id
+ * @param cycles elapsed system clocks
+ */
+void prof_add(int zone, uint32_t cycles);
+
+/**
+ * clear all statistics and the sample ring
+ */
+void prof_reset_on();
+
+/**
+ * print count/min/avg/max per zone and the last samples
+ * @param port uart core
+ */
+void prof_report_on(UartCore *port);
+
+/**
+ * statistics of a zone (for host-side checks)
+ * @param zone zone id
+ */
+const ProfStats &prof_stats(int zone);
+
+/**
+ * scoped timer:
+ *  - constructor takes the start tick, destructor records the delta
+ */
+class ProfScope {
+public:
+   ProfScope(int z) : zone(z), start(now_tick32()) {}
+   ~ProfScope() { prof_add(zone, now_tick32() - start); }
+private:
+   int zone;
+   uint32_t start;
+};
+
+#define PROF_CAT2(a, b) a##b
+#define PROF_CAT(a, b) PROF_CAT2(a, b)
+#define PROF_ZONE(zone) ProfScope PROF_CAT(_prof_scope_, __LINE__)(zone)
+#define prof_reset() prof_reset_on()
+#define prof_report(port) prof_report_on(port)
+
+#else  // not _PROFILE
+
+#define PROF_ZONE(zone) do {} while (0)
+#define prof_reset() do {} while (0)
+#define prof_report(port) do {} while (0)
+
+#endif // _PROFILE
+
+#endif  // _PROFILER_H_INCLUDED
@@ -0,0 +1,130 @@
+/*****************************************************************//**
+ * @file raster.cpp
+ *
+ * @brief implementation of Raster class
+ *
+ ********************************************************************/
+
+#include "raster.h"
+
+static inline int max_of(int a, int b) {
+   return (a > b) ? a : b;
+}
+
+static inline int min_of(int a, int b) {
+   return (a < b) ? a : b;
+}
+
+Raster::Raster(FrameCore *frame_core) {
+   frame = frame_core;
+   reset_clip();
+}
+
+Raster::~Raster() {
+}
+
+void Raster::set_clip(int x0, int y0, int x1, int y1) {
+   clip_x0 = max_of(x0, 0);
+   clip_y0 = max_of(y0, 0);
+   clip_x1 = min_of(x1, W);
+   clip_y1 = min_of(y1, H);
+}
+
+void Raster::reset_clip() {
+   set_clip(0, 0, W, H);
+}
+
+void Raster::clear(int color) {
+   fill_rect(clip_x0, clip_y0, clip_x1 - clip_x0, clip_y1 - clip_y0, color);
+}
+
+void Raster::hspan(int x, int y, int n, int color) {
+   int x0 = max_of(x, clip_x0);
+   int x1 = min_of(x + n, clip_x1);
+
+   if (y < clip_y0 || y >= clip_y1 || x1 <= x0)
+      return;
+   frame->wr_pix_fill(x0, y, color, x1 - x0);
+}
+
+void Raster::vspan(int x, int y, int n, int color) {
+   int y0 = max_of(y, clip_y0);
+   int y1 = min_of(y + n, clip_y1);
+
+   if (x < clip_x0 || x >= clip_x1)
+      return;
+   for (; y0 < y1; y0++)
+      frame->wr_pix(x, y0, color);
+}
+
+void Raster::fill_rect(int x, int y, int w, int h, int color) {
+   int x0 = max_of(x, clip_x0);
+   int x1 = min_of(x + w, clip_x1);
+   int y0 = max_of(y, clip_y0);
+   int y1 = min_of(y + h, clip_y1);
+
+   if (x1 <= x0 || y1 <= y0)
+      return;
+   // full rows are contiguous: one run over all of them
+   if (x0 == 0 && x1 == W) {
+      frame->wr_pix_fill(0, y0, color, W * (y1 - y0));
+      return;
+   }
+   for (; y0 < y1; y0++)
+      frame->wr_pix_fill(x0, y0, color, x1 - x0);
+}
+
+void Raster::rect(int x, int y, int w, int h, int color) {
+   if (w <= 0 || h <= 0)
+      return;
+   hspan(x, y, w, color);
+   if (h > 1)
+      hspan(x, y + h - 1, w, color);
+   vspan(x, y + 1, h - 2, color);
+   if (w > 1)
+      vspan(x + w - 1, y + 1, h - 2, color);
+}
+
+// one span per row; the half width shrinks as dy grows (no sqrt)
+void Raster::fill_circle(int cx, int cy, int r, int color) {
+   int dx = r, dy;
+
+   if (r < 0)
+      return;
+   for (dy = 0; dy <= r; dy++) {
+      while (dx * dx + dy * dy > r * r)
+         dx--;
+      hspan(cx - dx, cy - dy, 2 * dx + 1, color);
+      if (dy > 0)
+         hspan(cx - dx, cy + dy, 2 * dx + 1, color);
+   }
+}
+
+void Raster::blit(int x, int y, const uint32_t *bmp, int w, int h, int key) {
+   int x0 = max_of(x, clip_x0);
+   int x1 = min_of(x + w, clip_x1);
+   int y0 = max_of(y, clip_y0);
+   int y1 = min_of(y + h, clip_y1);
+   const uint32_t *src;
+   int i, run;
+
+   if (x1 <= x0 || y1 <= y0)
+      return;
+   for (; y0 < y1; y0++) {
+      src = bmp + (y0 - y) * w + (x0 - x);
+      if (key == NO_KEY) {
+         frame->wr_pix_span(x0, y0, src, x1 - x0);
+         continue;
+      }
+      // opaque runs between key pixels
+      for (i = 0; i < x1 - x0; i += run) {
+         if (src[i] == (uint32_t) key) {
+            run = 1;
+            continue;
+         }
+         for (run = 1; i + run < x1 - x0 && src[i + run] != (uint32_t) key; run++) {
+         }
+         frame->wr_pix_span(x0 + i, y0, src + i, run);
+      }
+   }
+}
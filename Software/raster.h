@@ -0,0 +1,125 @@
+/*****************************************************************//**
+ * @file raster.h
+ *
+ * @brief 2-d drawing primitives over the frame buffer core
+ *
+ * Description:
+ *  - spans, filled and outlined rectangles, filled circles and
+ *    bitmap blits, all clipped to a clip window (whole frame by
+ *    default)
+ *  - everything is drawn as horizontal runs in address order: one
+ *    block write per run (io_fill_block/io_write_block), no per-pixel
+ *    address computation
+ *  - rectangles spanning the full width are one block fill over all
+ *    their rows (the frame buffer has no row padding)
+ *  - blits skip pixels of a chroma-key color; the opaque runs between
+ *    them are written as blocks
+ *  - frame buffer pixels are 9-bit RRRGGGBBB (frame_palette_9);
+ *    frame_color() converts the 12-bit colors used by the other cores
+ *
+ ********************************************************************/
+
+#ifndef _RASTER_H_INCLUDED
+#define _RASTER_H_INCLUDED
+
+#include "vga_core.h"
+
+/**
+ * 12-bit RGB (4:4:4) to a 9-bit frame buffer pixel (3:3:3)
+ */
+constexpr uint32_t frame_color(uint32_t rgb12) {
+   return (((rgb12 >> 3) & 0x1c0) | ((rgb12 >> 2) & 0x038) | ((rgb12 >> 1) & 0x007));
+}
+
+/**
+ * clipped drawing on a frame core
+ *
+ */
+class Raster {
+public:
+   /**
+    * symbolic constants
+    */
+   enum {
+      W = FrameCore::HMAX,
+      H = FrameCore::VMAX,
+      NO_KEY = -1        /**< blit without a chroma key */
+   };
+
+   /* methods */
+   Raster(FrameCore *frame_core);
+   ~Raster();                  // not used
+
+   /**
+    * restrict drawing to a window
+    * @param x0 left column (inclusive)
+    * @param y0 top row (inclusive)
+    * @param x1 right column (exclusive)
+    * @param y1 bottom row (exclusive)
+    *
+    * @note the window is cut to the frame
+    */
+   void set_clip(int x0, int y0, int x1, int y1);
+
+   /**
+    * draw on the whole frame again
+    */
+   void reset_clip();
+
+   /**
+    * fill the clip window
+    * @param color pixel color
+    */
+   void clear(int color);
+
+   /**
+    * horizontal run of n pixels from (x, y) to the right
+    */
+   void hspan(int x, int y, int n, int color);
+
+   /**
+    * vertical run of n pixels from (x, y) down
+    */
+   void vspan(int x, int y, int n, int color);
+
+   /**
+    * filled rectangle
+    * @param x x-coordinate of the top-left corner
+    * @param y y-coordinate of the top-left corner
+    * @param w width
+    * @param h height
+    * @param color pixel color
+    */
+   void fill_rect(int x, int y, int w, int h, int color);
+
+   /**
+    * one pixel wide rectangle outline (parameters as fill_rect())
+    */
+   void rect(int x, int y, int w, int h, int color);
+
+   /**
+    * filled circle
+    * @param cx x-coordinate of the center
+    * @param cy y-coordinate of the center
+    * @param r radius
+    * @param color pixel color
+    */
+   void fill_circle(int cx, int cy, int r, int color);
+
+   /**
+    * copy a bitmap
+    * @param x x-coordinate of the top-left corner
+    * @param y y-coordinate of the top-left corner
+    * @param bmp pixels, row by row (w per row)
+    * @param w bitmap width
+    * @param h bitmap height
+    * @param key color left transparent; NO_KEY: copy every pixel
+    */
+   void blit(int x, int y, const uint32_t *bmp, int w, int h, int key = NO_KEY);
+
+private:
+   FrameCore *frame;
+   int clip_x0, clip_y0, clip_x1, clip_y1;
+};
+
+#endif  // _RASTER_H_INCLUDED
@@ -0,0 +1,194 @@
+#include "replay.h"
+#include "game_physics.h"
+
+// ========== Log Word ==========
+// tick in bits 31..10, break flag in bit 9, key code in bits 8..0
+static const int TICK_SHIFT = 10;
+static const uint32_t BRK_BIT = 1 << 9;
+static const uint32_t CODE_MASK = KEY_CODE_MAX - 1;
+static const uint32_t FNV_BASIS = 2166136261u;
+
+// ========== Replay State ==========
+static ReplayMode mode = REPLAY_OFF;
+static uint32_t seed_value = 0;
+static uint32_t log_buf[REPLAY_LOG_LEN];
+static int log_len = 0;
+static int log_pos = 0;
+static bool log_full = false;
+static uint32_t trace = FNV_BASIS;
+static uint32_t ticks = 0;
+static void (*end_hook)(bool ok) = nullptr;
+
+// expected result (PLAY), from the H record
+static uint32_t want_trace = 0, want_ticks = 0;
+static int want_p1 = 0, want_p2 = 0;
+
+// ========== Match Control ==========
+void replay_begin(ReplayMode m, uint32_t seed) {
+    mode = m;
+    if (mode != REPLAY_PLAY) {
+        seed_value = seed;
+        log_len = 0;
+        log_full = false;
+    }
+    log_pos = 0;
+    trace = FNV_BASIS;
+    ticks = 0;
+}
+
+ReplayMode replay_mode() {
+    return mode;
+}
+
+uint32_t replay_seed() {
+    return seed_value;
+}
+
+bool replay_end(int p1_score, int p2_score) {
+    bool ok = true;
+
+    if (mode == REPLAY_RECORD) {
+        want_trace = trace;
+        want_ticks = ticks;
+        want_p1 = p1_score;
+        want_p2 = p2_score;
+        replay_dump(&uart);
+    } else if (mode == REPLAY_PLAY) {
+        ok = (trace == want_trace && ticks == want_ticks &&
+              p1_score == want_p1 && p2_score == want_p2);
+        uart.disp(ok ? "replay: match\n\r" : "replay: MISMATCH\n\r");
+    }
+    if (end_hook)
+        end_hook(ok);
+    return ok;
+}
+
+void replay_set_end_hook(void (*hook)(bool ok)) {
+    end_hook = hook;
+}
+
+// ========== Per Tick ==========
+void replay_record(uint32_t tick, const KeyEvent &ev) {
+    if (mode != REPLAY_RECORD)
+        return;
+    if (log_len == REPLAY_LOG_LEN) {
+        log_full = true;
+        return;
+    }
+    log_buf[log_len++] = (tick << TICK_SHIFT) | (ev.is_break ? BRK_BIT : 0) |
+                         (ev.code & CODE_MASK);
+}
+
+bool replay_next(uint32_t tick, KeyEvent *ev) {
+    if (mode != REPLAY_PLAY || log_pos == log_len)
+        return false;
+    uint32_t w = log_buf[log_pos];
+    if ((w >> TICK_SHIFT) != tick)
+        return false;
+    log_pos++;
+    ev->t_us = 0;
+    ev->code = (uint16_t)(w & CODE_MASK);
+    ev->is_break = (w & BRK_BIT) ? 1 : 0;
+    return true;
+}
+
+void replay_tick_done(const GameState &s) {
+    if (mode == REPLAY_OFF)
+        return;
+    trace = physics_hash(s, trace);
+    ticks++;
+}
+
+// ========== Log Access ==========
+static void put_hex(UartCore *port, uint32_t w) {
+    for (int i = 28; i >= 0; i -= 4)
+        port->disp("0123456789abcdef"[(w >> i) & 0xf]);
+}
+
+static void put_record(UartCore *port, char tag, const uint32_t *w, int n) {
+    port->disp(tag);
+    for (int i = 0; i < n; i++) {
+        port->disp(' ');
+        put_hex(port, w[i]);
+    }
+    port->disp("\n\r");
+}
+
+void replay_dump(UartCore *port) {
+    uint32_t h[4] = { want_trace, (uint32_t)want_p1, (uint32_t)want_p2, want_ticks };
+
+    put_record(port, 'S', &seed_value, 1);
+    for (int i = 0; i < log_len; i++)
+        put_record(port, 'E', &log_buf[i], 1);
+    put_record(port, 'H', h, 4);
+    if (log_full)
+        port->disp("replay: log full, playback will diverge\n\r");
+}
+
+static const char* parse_hex(const char* p, uint32_t* w) {
+    uint32_t v = 0;
+    int digits = 0;
+
+    while (*p == ' ')
+        p++;
+    for (;; p++, digits++) {
+        char c = *p;
+        if (c >= '0' && c <= '9')      v = (v << 4) | (uint32_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') v = (v << 4) | (uint32_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v = (v << 4) | (uint32_t)(c - 'A' + 10);
+        else break;
+    }
+    *w = v;
+    return digits ? p : nullptr;
+}
+
+bool replay_parse_line(const char *line) {
+    uint32_t w[4];
+    const char *p;
+
+    while (*line == '\r' || *line == '\n' || *line == ' ')
+        line++;
+    p = line + 1;
+    switch (line[0]) {
+    case 'S':
+        if (!parse_hex(p, &seed_value))
+            return false;
+        log_len = 0;
+        log_full = false;
+        return true;
+    case 'E':
+        if (!parse_hex(p, &w[0]) || log_len == REPLAY_LOG_LEN)
+            return false;
+        log_buf[log_len++] = w[0];
+        return true;
+    case 'H':
+        for (int i = 0; i < 4; i++) {
+            p = parse_hex(p, &w[i]);
+            if (!p)
+                return false;
+        }
+        want_trace = w[0];
+        want_p1 = (int)w[1];
+        want_p2 = (int)w[2];
+        want_ticks = w[3];
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t replay_trace() {
+    return trace;
+}
+
+uint32_t replay_ticks() {
+    return ticks;
+}
+
+int replay_events() {
+    return log_len;
+}
+
+bool replay_overflow() {
+    return log_full;
+}
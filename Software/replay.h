@@ -0,0 +1,52 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "chu_init.h"
+#include "key_input.h"
+#include "game_physics.h"
+
+// Match recording / replay
+//  - a match is reproduced by the physics seed plus every key event
+//    stamped with the physics tick that consumed it
+//  - playback drops live keyboard events and applies the logged ones
+//    on the same ticks, so the simulation runs bit-identically
+//  - a running hash of the physics state after every tick checks the
+//    whole trajectory, not just the final score
+//
+// Log text format (one record per line, hex fields), as dumped over uart:
+//   S <seed>
+//   E <tick << 10 | is_break << 9 | code>
+//   H <trace hash> <p1 score> <p2 score> <ticks>
+
+#define REPLAY_LOG_LEN 1024   // logged key events (4 bytes each)
+
+enum ReplayMode {
+    REPLAY_OFF,
+    REPLAY_RECORD,
+    REPLAY_PLAY
+};
+
+// ========== Match Control ==========
+// start a match; in REPLAY_PLAY the loaded log supplies the seed
+void replay_begin(ReplayMode mode, uint32_t seed);
+ReplayMode replay_mode();
+uint32_t replay_seed();
+// end of match: RECORD dumps the log, PLAY checks hash and scores;
+// returns false on a playback mismatch
+bool replay_end(int p1_score, int p2_score);
+void replay_set_end_hook(void (*hook)(bool ok));   // called by replay_end()
+
+// ========== Per Tick ==========
+void replay_record(uint32_t tick, const KeyEvent &ev);   // no-op unless recording
+bool replay_next(uint32_t tick, KeyEvent *ev);           // logged event due at tick
+void replay_tick_done(const GameState &s);               // fold physics state into the trace
+
+// ========== Log Access ==========
+void replay_dump(UartCore *port);
+bool replay_parse_line(const char *line);   // load one text record (PLAY)
+uint32_t replay_trace();
+uint32_t replay_ticks();
+int replay_events();
+bool replay_overflow();                     // log full while recording
+
+#endif // REPLAY_H
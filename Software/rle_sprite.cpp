@@ -0,0 +1,33 @@
+/*****************************************************************//**
+ * @file rle_sprite.cpp
+ *
+ * @brief implementation of the run-length-encoded sprite upload
+ *
+ ********************************************************************/
+
+#include "rle_sprite.h"
+
+int rle_upload(SpriteCore *sprite, const RleSprite &art, int addr) {
+   uint32_t buf[RLE_CHUNK];
+   uint32_t code;
+   int i, run, fill = 0, done = 0;
+
+   for (i = 0; i < art.len && done + fill < art.pixels; i++) {
+      code = art.data[i] & RLE_CODE_MASK;
+      run = (art.data[i] >> RLE_CODE_BITS) + 1;
+      if (run > art.pixels - done - fill)
+         run = art.pixels - done - fill;
+      while (run > 0) {
+         buf[fill++] = code;
+         run--;
+         if (fill == RLE_CHUNK) {
+            sprite->wr_mem_span(addr + done, buf, fill);
+            done += fill;
+            fill = 0;
+         }
+      }
+   }
+   if (fill > 0)
+      sprite->wr_mem_span(addr + done, buf, fill);
+   return (done + fill);
+}
@@ -0,0 +1,57 @@
+/*****************************************************************//**
+ * @file rle_sprite.h
+ *
+ * @brief run-length-encoded sprite art and its upload to a sprite ram
+ *
+ * Description:
+ *  - sprite art is built into the image as constant run-length
+ *    encoded arrays (sprite_art.h, generated by sim/mem2rle from the
+ *    .mem files in Hardware/), so art can change or be swapped at run
+ *    time without a new bitstream
+ *  - one byte per run, in ram address order:
+ *      bits 7..3: run length - 1 (1 .. RLE_RUN_MAX pixels)
+ *      bits 2..0: palette code (0: chroma key)
+ *    longer runs are split; rows are not marked, a run may continue
+ *    on the next row
+ *  - rle_upload() decodes into a small word buffer and streams it to
+ *    the ram with SpriteCore::wr_mem_span() (one block write per
+ *    RLE_CHUNK pixels)
+ *
+ ********************************************************************/
+
+#ifndef _RLE_SPRITE_H_INCLUDED
+#define _RLE_SPRITE_H_INCLUDED
+
+#include "vga_core.h"
+
+/**
+ * symbolic constants
+ */
+enum {
+   RLE_CODE_BITS = 3,                     /**< palette code field */
+   RLE_CODE_MASK = (1 << RLE_CODE_BITS) - 1,
+   RLE_RUN_MAX = 256 >> RLE_CODE_BITS,    /**< pixels per run byte */
+   RLE_CHUNK = 64                         /**< pixels per block write */
+};
+
+/**
+ * one piece of encoded sprite art
+ */
+struct RleSprite {
+   const uint8_t *data;   /**< run bytes */
+   uint16_t len;          /**< number of run bytes */
+   uint16_t pixels;       /**< decoded size (ram words) */
+};
+
+/**
+ * decode sprite art into a sprite ram
+ * @param sprite sprite core
+ * @param art encoded art
+ * @param addr ram address of the first pixel
+ * @return pixels written (art.pixels unless the runs fall short)
+ *
+ * @note runs past art.pixels are dropped
+ */
+int rle_upload(SpriteCore *sprite, const RleSprite &art, int addr = 0);
+
+#endif  // _RLE_SPRITE_H_INCLUDED
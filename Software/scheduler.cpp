@@ -0,0 +1,122 @@
+/*****************************************************************//**
+ * @file scheduler.cpp
+ *
+ * @brief implementation of the frame pacer and the task table
+ *
+ ********************************************************************/
+
+#include "scheduler.h"
+
+/**********************************************************************
+ * FramePacer
+ *********************************************************************/
+FramePacer::FramePacer(uint32_t period_us) {
+   period = period_us * SYS_CLK_FREQ;
+   deadline = 0;
+   n_frames = 0;
+   n_overruns = 0;
+   late_max = 0;
+   late_sum = 0;
+}
+
+FramePacer::~FramePacer() {
+}
+
+void FramePacer::start() {
+   deadline = sched_now() + period;
+   n_frames = 0;
+   n_overruns = 0;
+   late_max = 0;
+   late_sum = 0;
+}
+
+void FramePacer::resync() {
+   deadline = sched_now() + period;
+}
+
+bool FramePacer::wait(void (*idle)()) {
+   uint32_t now, late;
+   bool met;
+
+   now = sched_now();
+   met = !sched_due(now, deadline);
+   if (!met) {
+      // frame work ran past the deadline; re-base instead of catching up
+      n_overruns++;
+      deadline = now + period;
+      n_frames++;
+      return (false);
+   }
+   do {
+      if (idle)
+         idle();
+      now = sched_now();
+   } while (!sched_due(now, deadline));
+   late = now - deadline;
+   if (late > late_max)
+      late_max = late;
+   late_sum += late;
+   deadline += period;
+   n_frames++;
+   return (true);
+}
+
+void FramePacer::report(UartCore *port) {
+   uint32_t met = n_frames - n_overruns;
+
+   port->disp("pacer: frames ");
+   port->disp((int) n_frames);
+   port->disp(" overruns ");
+   port->disp((int) n_overruns);
+   port->disp(" late avg/max ");
+   port->disp((int) (met ? (late_sum / met) / SYS_CLK_FREQ : 0));
+   port->disp("/");
+   port->disp((int) (late_max / SYS_CLK_FREQ));
+   port->disp("us\n\r");
+}
+
+/**********************************************************************
+ * TaskTable
+ *********************************************************************/
+TaskTable::TaskTable() {
+   n_tasks = 0;
+}
+
+TaskTable::~TaskTable() {
+}
+
+int TaskTable::add(void (*fn)(), uint32_t period_us) {
+   Task *t;
+
+   if (n_tasks == MAX_TASKS)
+      return (-1);
+   t = &task[n_tasks];
+   t->fn = fn;
+   t->period = period_us * SYS_CLK_FREQ;
+   t->next = 0;
+   t->enabled = false;
+   return (n_tasks++);
+}
+
+void TaskTable::enable(int id, bool on) {
+   if (id < 0 || id >= n_tasks)
+      return;
+   task[id].enabled = on;
+   task[id].next = sched_now();
+}
+
+void TaskTable::run() {
+   uint32_t now;
+   int i;
+
+   now = sched_now();
+   for (i = 0; i < n_tasks; i++) {
+      Task *t = &task[i];
+      if (!t->enabled || !sched_due(now, t->next))
+         continue;
+      t->next += t->period;
+      if (sched_due(now, t->next))   // fell behind: skip missed periods
+         t->next = now + t->period;
+      t->fn();
+   }
+}
@@ -0,0 +1,140 @@
+/*****************************************************************//**
+ * @file scheduler.h
+ *
+ * @brief deadline-based frame pacing and cooperative periodic tasks
+ *
+ * Description:
+ *  - FramePacer: frames start on absolute deadlines (k * period from
+ *    start()), so the frame period does not grow with the frame work
+ *    - waiting runs an idle hook instead of a bare busy loop
+ *    - a frame whose work ends past its deadline is an overrun; the
+ *      next deadline is then re-based on the current time (no burst of
+ *      back-to-back frames to catch up)
+ *    - wake-up lateness (time from deadline to return) is tracked
+ *  - TaskTable: fixed table of periodic jobs run from the idle hook
+ *  - times are 32-bit system clock ticks compared by signed
+ *    difference; wrap-safe for periods below ~21 s
+ *
+ ********************************************************************/
+
+#ifndef _SCHEDULER_H_INCLUDED
+#define _SCHEDULER_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * current system time as a 32-bit tick (wraps every 2^32 clocks)
+ */
+static inline uint32_t sched_now() {
+   return (now_tick32());
+}
+
+/**
+ * true when tick t is at or after deadline d (wrap-safe)
+ */
+static inline bool sched_due(uint32_t t, uint32_t d) {
+   return ((int32_t) (t - d) >= 0);
+}
+
+/**
+ * frame pacer:
+ *  - call start() once, then wait() at the end of every frame
+ */
+class FramePacer {
+public:
+   /**
+    * constructor
+    * @param period_us frame period in microseconds
+    * @note no timer access (safe for a global instance); start() sets
+    *       the first deadline
+    */
+   FramePacer(uint32_t period_us);
+   ~FramePacer();                  // not used
+
+   /**
+    * set the first deadline one period from now and clear statistics
+    */
+   void start();
+
+   /**
+    * re-base the next deadline one period from now (after a known
+    * stall such as a pause screen); statistics are kept
+    */
+   void resync();
+
+   /**
+    * idle until the next frame deadline
+    * @param idle hook called repeatedly while waiting (0: none)
+    * @return true if the deadline was met; false on an overrun
+    */
+   bool wait(void (*idle)());
+
+   /* statistics since start() */
+   uint32_t frames() const { return n_frames; }
+   uint32_t overruns() const { return n_overruns; }
+   uint32_t max_late() const { return late_max; }  /**< ticks */
+
+   /**
+    * print frame/overrun count and wake-up lateness over a uart core
+    * @param port uart core
+    */
+   void report(UartCore *port);
+
+private:
+   uint32_t period;      // ticks
+   uint32_t deadline;
+   uint32_t n_frames;
+   uint32_t n_overruns;
+   uint32_t late_max;
+   uint64_t late_sum;
+};
+
+/**
+ * cooperative periodic task table:
+ *  - run() executes every enabled task whose time has come, once
+ *  - a late task is not run repeatedly to catch up
+ */
+class TaskTable {
+public:
+   /**
+    * symbolic constants
+    */
+   enum {
+      MAX_TASKS = 8
+   };
+
+   TaskTable();
+   ~TaskTable();                   // not used
+
+   /**
+    * add a task (initially disabled)
+    * @param fn task function
+    * @param period_us period in microseconds
+    * @return task id; -1 if the table is full
+    */
+   int add(void (*fn)(), uint32_t period_us);
+
+   /**
+    * enable/disable a task
+    * @param id task id
+    * @param on true: run on the next run() call and then periodically
+    */
+   void enable(int id, bool on);
+
+   /**
+    * run the tasks that are due
+    */
+   void run();
+
+private:
+   struct Task {
+      void (*fn)();
+      uint32_t period;   // ticks
+      uint32_t next;
+      bool enabled;
+   };
+   Task task[MAX_TASKS];
+   int n_tasks;
+};
+
+#endif  // _SCHEDULER_H_INCLUDED
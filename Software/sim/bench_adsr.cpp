@@ -0,0 +1,352 @@
+/*****************************************************************//**
+ * @file bench_adsr.cpp
+ *
+ * @brief host benchmark of an adsr note start under a soft-division
+ *        cost model
+ *
+ * Description:
+ *  - the MCS has no divider and no FPU: a division or a float
+ *    multiply, compare or conversion is a libgcc call; this benchmark
+ *    counts them on the host and prices them like those calls
+ *  - a note start is ddfs.set_carrier_fcw() + adsr.set_env() +
+ *    adsr.start() on sim/rec_io_bus.h (writes are only counted)
+ *  - note streams: "game" = the songs with the song envelope, with a
+ *    kick or collision effect (and the resume of the cut note) after
+ *    one note in five, plus countdown beeps and queued notes;
+ *    "alternate" = every note changes the envelope (worst case for
+ *    the envelope cache)
+ *  - each stream runs through AdsrCore (the register-word cache and
+ *    the envelope cache) and through ref_set_env(), the per-note
+ *    conversion the driver did before (three divisions, a float
+ *    multiply and five register writes per note)
+ *  - the code is single-stepped with the x86 trap flag; each host
+ *    instruction is 1 clock, except: integer division UDIV_CLKS,
+ *    float multiply/divide FMUL_CLKS, float compare FCMP_CLKS,
+ *    float/int conversion FCVT_CLKS, and IO_CLKS per register write
+ *    (the mock's own instructions are taken out)
+ *  - both paths must leave the same adsr register words after each
+ *    note start (the mock keeps the last word per register)
+ *  - x86-64 Linux only
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/rec_io_bus.h sim/bench_adsr.cpp adsr_core.cpp
+ *       ddfs_core.cpp audio_manager.cpp -o bench_adsr
+ *  - exit status 1 on any register mismatch
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <vector>
+#include "audio_manager.h"
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "bench_adsr counts instructions with the x86-64 trap flag"
+#endif
+
+/* cost model (clocks), after the libgcc soft routines */
+static const int UDIV_CLKS = 120;   // __udivsi3: shift-subtract loop
+static const int FMUL_CLKS = 80;    // __mulsf3
+static const int FCMP_CLKS = 30;    // __nesf2
+static const int FCVT_CLKS = 40;    // __floatsisf, __fixunssfsi
+static const int IO_CLKS = 4;       // one bus write
+
+static const uint32_t DDFS_BASE = get_slot_addr(BRIDGE_BASE, S12_DDFS);
+static const uint32_t ADSR_BASE = get_slot_addr(BRIDGE_BASE, S13_ADSR);
+
+/* one note start of a stream */
+struct Note {
+   uint32_t fcw;
+   int attack, decay, sustain, release;
+   float level;
+};
+
+/* operation counts of a traced run */
+struct Ops {
+   uint64_t insn, udiv, fmul, fcmp, fcvt, writes;
+};
+
+static volatile uint64_t n_insn, n_udiv, n_fmul, n_fcmp, n_fcvt;
+static volatile uint64_t n_writes;
+static uint32_t mock_reg[64];           // last word per register
+
+extern "C" {
+
+uint32_t rec_io_read(uint32_t addr) {
+   (void) addr;
+   return (1);
+}
+
+void rec_io_write(uint32_t addr, uint32_t data) {
+   // one index for every register of the ddfs and adsr slots, with
+   // no branch, so every write costs the same host instructions
+   mock_reg[(addr >> 2) & 63] = data;
+   n_writes++;
+}
+
+void debug_off() {
+}
+
+unsigned long now_ms() {
+   return (0);
+}
+
+}  // extern "C"
+
+/**********************************************************************
+ * instruction classes under the trap flag
+ *********************************************************************/
+static void on_trap(int sig, siginfo_t *info, void *ctx) {
+   const uint8_t *p;
+   uint8_t rep = 0, op;
+
+   (void) sig;
+   (void) info;
+   p = (const uint8_t *) ((ucontext_t *) ctx)->uc_mcontext.gregs[REG_RIP];
+   n_insn++;
+   // legacy prefixes, then REX
+   while (*p == 0x66 || *p == 0xf2 || *p == 0xf3) {
+      if (*p != 0x66)
+         rep = *p;
+      p++;
+   }
+   if ((*p & 0xf0) == 0x40)
+      p++;
+   if ((*p == 0xf6 || *p == 0xf7) && ((p[1] >> 3) & 7) >= 6) {
+      n_udiv++;                   // div, idiv
+      return;
+   }
+   if (*p != 0x0f)
+      return;
+   op = p[1];
+   if (rep && (op == 0x59 || op == 0x5e))
+      n_fmul++;                   // mulss/sd, divss/sd
+   else if (op == 0x2e || op == 0x2f)
+      n_fcmp++;                   // (u)comiss/sd
+   else if (rep && (op == 0x2a || op == 0x2c || op == 0x2d || op == 0x5a))
+      n_fcvt++;                   // cvtsi2ss, cvt(t)ss2si, cvtss2sd
+}
+
+// noinline, so the pushf below the caller's frame is safe
+__attribute__((noinline))
+static void trace_on() {
+   __asm__ volatile("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+__attribute__((noinline))
+static void trace_off() {
+   __asm__ volatile("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+static void zero_counts() {
+   n_insn = n_udiv = n_fmul = n_fcmp = n_fcvt = n_writes = 0;
+}
+
+static Ops counts() {
+   Ops o = { n_insn, n_udiv, n_fmul, n_fcmp, n_fcvt, n_writes };
+   return (o);
+}
+
+/**********************************************************************
+ * per-note conversion, as before the caches
+ *********************************************************************/
+static void ref_set_env(int ams, int dms, int sms, int rms, float slevel) {
+   const uint32_t clks = SYS_CLK_FREQ * 1000;
+   const uint32_t MAX = AdsrCore::MAX;
+   uint32_t nc, step, sus_abs;
+
+   sus_abs = (unsigned int) MAX * slevel;
+   io_write(ADSR_BASE, AdsrCore::SUS_LEVEL_REG, sus_abs);
+   nc = ams * clks;
+   step = MAX / nc;
+   if (step == 0)
+      step = 1;
+   io_write(ADSR_BASE, AdsrCore::ATK_REG, step);
+   nc = dms * clks;
+   step = (MAX - sus_abs) / nc;
+   if (step == 0)
+      step = 1;
+   io_write(ADSR_BASE, AdsrCore::DCY_REG, step);
+   nc = sms * clks;
+   io_write(ADSR_BASE, AdsrCore::SUS_REG, nc);
+   nc = rms * clks;
+   step = sus_abs / nc;
+   if (step == 0)
+      step = 1;
+   io_write(ADSR_BASE, AdsrCore::REL_REG, step);
+}
+
+/**********************************************************************
+ * note streams
+ *********************************************************************/
+static uint32_t rng = 0x2545f491;
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+static Note song_env(uint32_t fcw, int dur) {
+   Note n = { fcw, 5, 10, (dur - 30 > 0) ? dur - 30 : 5, 20, 0.8f };
+   return (n);
+}
+
+static void game_stream(std::vector<Note> &s) {
+   Song *songs[] = { mario_intro, luffy_theme, zoro_theme, smash_splash };
+   const int lens[] = { mario_intro_len, luffy_theme_len, zoro_theme_len,
+                        smash_splash_len };
+   const Note kick = { NOTE_C5, 5, 15, 0, 60, 1.0f };
+   const Note collision = { NOTE_C4, 5, 10, 0, 50, 1.0f };
+   const Note beep = { NOTE_C5, 5, 10, 300, 100, 0.8f };
+   const Note go = { NOTE_G5, 10, 10, 500, 200, 0.8f };
+   Note n;
+   int i, k;
+
+   for (i = 0; i < 4; i++) {
+      for (k = 0; k < lens[i]; k++) {
+         if (songs[i][k].fcw == REST)
+            continue;
+         n = song_env(songs[i][k].fcw, songs[i][k].duration);
+         s.push_back(n);
+         if (rnd(5) == 0) {
+            s.push_back(rnd(2) ? kick : collision);
+            n.sustain = rnd(n.sustain + 1);     // resume: time left
+            s.push_back(n);
+         }
+      }
+      s.push_back(beep);
+      s.push_back(beep);
+      s.push_back(beep);
+      s.push_back(go);
+   }
+   for (k = 0; k < 3; k++) {                    // goal tune (play_note)
+      n.fcw = NOTE_FCW[4 * NOTE_PER_OCTAVE + 4 * k];
+      n.attack = 10;
+      n.decay = 10;
+      n.release = 100;
+      n.sustain = (k == 2 ? QUARTER : EIGHTH) - 120;
+      n.level = 0.8f;
+      s.push_back(n);
+   }
+}
+
+static void alternate_stream(std::vector<Note> &s) {
+   const Note kick = { NOTE_C5, 5, 15, 0, 60, 1.0f };
+   int k;
+
+   for (k = 0; k < 200; k++) {
+      s.push_back((k & 1) ? kick : song_env(NOTE_FCW[k % 36], 200));
+   }
+}
+
+/**********************************************************************
+ * traced runs
+ *********************************************************************/
+static DdfsCore ddfs(DDFS_BASE);
+static AdsrCore adsr(ADSR_BASE, &ddfs);
+
+// adsr register words after each note start
+static uint32_t *adsr_regs() {
+   return (&mock_reg[((ADSR_BASE >> 2) & 63) + AdsrCore::ATK_REG]);
+}
+
+static const int ENV_REGS = AdsrCore::SUS_LEVEL_REG - AdsrCore::ATK_REG + 1;
+
+static Ops run(const std::vector<Note> &s, bool ref,
+      std::vector<uint32_t> &regs) {
+   size_t i;
+
+   regs.clear();
+   zero_counts();
+   for (i = 0; i < s.size(); i++) {
+      const Note &n = s[i];
+
+      trace_on();
+      ddfs.set_carrier_fcw(n.fcw);
+      if (ref)
+         ref_set_env(n.attack, n.decay, n.sustain, n.release, n.level);
+      else
+         adsr.set_env(n.attack, n.decay, n.sustain, n.release, n.level);
+      adsr.start();
+      trace_off();
+      regs.insert(regs.end(), adsr_regs(), adsr_regs() + ENV_REGS);
+   }
+   return (counts());
+}
+
+// host instructions of one traced empty start/stop and one mock write
+static uint64_t empty_insn, write_insn;
+
+static void calibrate() {
+   void (*volatile wr)(uint32_t, uint32_t) = rec_io_write;
+
+   zero_counts();
+   trace_on();
+   trace_off();
+   empty_insn = n_insn;
+   zero_counts();
+   trace_on();
+   wr(0, 0);
+   trace_off();
+   write_insn = n_insn - empty_insn;
+}
+
+static double model_clks(const Ops &o, size_t notes) {
+   uint64_t other = o.insn - notes * empty_insn - o.writes * write_insn
+         - o.udiv - o.fmul - o.fcmp - o.fcvt;
+
+   return ((double) (other + o.udiv * UDIV_CLKS + o.fmul * FMUL_CLKS
+         + o.fcmp * FCMP_CLKS + o.fcvt * FCVT_CLKS + o.writes * IO_CLKS)
+         / notes);
+}
+
+// returns the number of notes that leave other adsr register words
+static int report(const char *name, const std::vector<Note> &s) {
+   std::vector<uint32_t> now_regs, ref_regs;
+   Ops now = run(s, false, now_regs), ref = run(s, true, ref_regs);
+   double n = (double) s.size();
+   size_t i;
+   int bad = 0;
+
+   for (i = 0; i < s.size(); i++) {
+      if (memcmp(&now_regs[i * ENV_REGS], &ref_regs[i * ENV_REGS],
+            ENV_REGS * sizeof(uint32_t)) != 0)
+         bad++;
+   }
+
+   printf("%-9s %4d notes  per note: %5.2f div %5.2f fmul %5.2f fcmp "
+         "%5.2f fcvt %5.2f writes, %6.1f clks\n", name, (int) n,
+         now.udiv / n, now.fmul / n, now.fcmp / n, now.fcvt / n,
+         now.writes / n, model_clks(now, s.size()));
+   printf("%-9s %4s per-note conversion: %5.2f div %5.2f fmul %5.2f fcmp "
+         "%5.2f fcvt %5.2f writes, %6.1f clks\n", "", "", ref.udiv / n,
+         ref.fmul / n, ref.fcmp / n, ref.fcvt / n, ref.writes / n,
+         model_clks(ref, s.size()));
+   printf("%-9s %4s register mismatches: %d\n", "", "", bad);
+   return (bad);
+}
+
+int main() {
+   struct sigaction sa;
+   std::vector<Note> game, alt;
+   int bad;
+
+   memset(&sa, 0, sizeof(sa));
+   sa.sa_sigaction = on_trap;
+   sa.sa_flags = SA_SIGINFO;
+   sigaction(SIGTRAP, &sa, 0);
+   calibrate();
+   game_stream(game);
+   alternate_stream(alt);
+   printf("model: div %d, fmul %d, fcmp %d, fcvt %d, write %d clks, "
+         "other host instructions 1 clk\n", UDIV_CLKS, FMUL_CLKS, FCMP_CLKS,
+         FCVT_CLKS, IO_CLKS);
+   bad = report("game", game);
+   bad += report("alternate", alt);
+   return (bad > 0 ? 1 : 0);
+}
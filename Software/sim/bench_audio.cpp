@@ -0,0 +1,314 @@
+/*****************************************************************//**
+ * @file bench_audio.cpp
+ *
+ * @brief host check of the audio sequencer over a recording mock
+ *
+ * Description:
+ *  - DdfsCore/AdsrCore run on sim/rec_io_bus.h: register writes are
+ *    recorded with the mock clock (now_ms()), which only the test
+ *    moves; sleep_ms()/sleep_us() count as a blocking call
+ *  - queue: random runs of queued notes (play_note(), some rests);
+ *    song: each built-in song (start_song()); the clock advances in
+ *    random steps of 1..MAX_STEP_MS with audio_tick() in between,
+ *    like frames of the game loop
+ *  - every note must start (ddfs carrier then adsr start) in the
+ *    first update at or after its due time, i.e. 0 <= error < step,
+ *    and the sequence of carriers must match; rests start nothing
+ *  - ducking: a kick effect (KICK_MS) cuts into a song at a random
+ *    update; the song must freeze for exactly KICK_MS: the cut note
+ *    resumes when the effect ends (if at least RESUME_MS of it is
+ *    left) and every later note starts KICK_MS late, whatever the
+ *    step that spans the end of the effect
+ *  - zero blocking: no sleep call and no adsr status read in any
+ *    audio call, and the clock never moves inside one
+ *  - prints the start time error and host ns per call (mean)
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/rec_io_bus.h sim/bench_audio.cpp audio_manager.cpp
+ *       ddfs_core.cpp adsr_core.cpp -o bench_audio
+ *  - exit status 1 on any mismatch or blocking call
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "audio_manager.h"
+
+static const int TRIALS = 2000;
+static const int MAX_STEP_MS = 40;
+static const unsigned long KICK_MS = 5 + 15 + 60;   // play_kick_sound()
+static const unsigned long RESUME_MS = 40;          // MIN_RESUME_MS
+static const uint32_t DDFS_BASE = get_slot_addr(BRIDGE_BASE, S12_DDFS);
+static const uint32_t ADSR_BASE = get_slot_addr(BRIDGE_BASE, S13_ADSR);
+
+/* one recorded note start */
+struct Start {
+   unsigned long t_ms;
+   uint32_t fcw;
+};
+
+/* mock board */
+static unsigned long mock_ms;
+static uint32_t carrier;
+static std::vector<Start> starts;
+static int blocked, adsr_reads;        // sleep calls, clock moves in a call
+
+static uint32_t rng = 0x2545f491;
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+extern "C" {
+
+uint32_t rec_io_read(uint32_t addr) {
+   if (addr >= ADSR_BASE && addr < ADSR_BASE + 32 * 4)
+      adsr_reads++;
+   return (1);                          // adsr idle
+}
+
+void rec_io_write(uint32_t addr, uint32_t data) {
+   if (addr == DDFS_BASE + 4 * DdfsCore::FCW_REG)
+      carrier = data;
+   else if (addr == ADSR_BASE + 4 * AdsrCore::START_REG)
+      starts.push_back(Start { mock_ms, carrier });
+}
+
+unsigned long now_ms() {
+   return (mock_ms);
+}
+
+unsigned long now_us() {
+   return (mock_ms * 1000);
+}
+
+void sleep_ms(unsigned long int t) {
+   blocked++;
+   mock_ms += t;
+}
+
+void sleep_us(unsigned long int t) {
+   blocked++;
+   mock_ms += t / 1000;
+}
+
+void debug_off() {
+}
+
+}  // extern "C"
+
+static DdfsCore ddfs(DDFS_BASE);
+static AdsrCore adsr(ADSR_BASE, &ddfs);
+
+/* start time error over all checked notes */
+static long err_max;
+static double err_sum;
+static long err_n;
+static double call_ns_sum;
+static long call_n;
+
+static void timed_tick() {
+   double t0 = seconds(), ns;
+   unsigned long before = mock_ms;
+
+   audio_tick();
+   ns = (seconds() - t0) * 1e9;
+   call_ns_sum += ns;
+   call_n++;
+   if (mock_ms != before)
+      blocked++;
+}
+
+// let the clock run in random steps until the sequencer is idle;
+// step_at gets the clock after each step
+static void run_until_idle(std::vector<unsigned long> &step_at, bool song) {
+   int s;
+
+   while (audio_busy() || (song && !is_song_done())) {
+      s = 1 + rnd(MAX_STEP_MS);
+      mock_ms += s;
+      step_at.push_back(mock_ms);
+      timed_tick();
+   }
+   // let a last effect or release run out
+   mock_ms += 500;
+   timed_tick();
+}
+
+// step that ended at update time t
+static unsigned long step_of(const std::vector<unsigned long> &step_at,
+      unsigned long t0, unsigned long t) {
+   unsigned long prev = t0;
+
+   for (size_t i = 0; i < step_at.size(); i++) {
+      if (step_at[i] == t)
+         return (t - prev);
+      prev = step_at[i];
+   }
+   return (0);
+}
+
+// compare the recorded starts with the due times of the non-rest notes
+static int compare(const std::vector<Start> &want, size_t first,
+      const std::vector<unsigned long> &step_at, unsigned long t0) {
+   size_t i;
+   long err;
+   int bad = 0;
+
+   if (starts.size() - first != want.size())
+      return (1);
+   for (i = 0; i < want.size(); i++) {
+      const Start &got = starts[first + i];
+
+      err = (long) got.t_ms - (long) want[i].t_ms;
+      // a note due at t0 starts in the call itself (step 0)
+      if (got.fcw != want[i].fcw || err < 0
+            || (err > 0 && err >= (long) step_of(step_at, t0, got.t_ms)))
+         bad++;
+      if (err > err_max)
+         err_max = err;
+      err_sum += err;
+      err_n++;
+   }
+   return (bad);
+}
+
+static int queue_trial() {
+   std::vector<Start> want;
+   std::vector<unsigned long> step_at;
+   size_t first = starts.size();
+   unsigned long t0 = mock_ms, due = mock_ms;
+   int n = 1 + rnd(NOTE_QUEUE_LEN + 1), k, dur;
+   uint32_t fcw;
+
+   for (k = 0; k < n; k++) {
+      dur = 50 + rnd(400);
+      fcw = rnd(5) ? NOTE_FCW[rnd(NOTE_OCTAVES * NOTE_PER_OCTAVE)] : REST;
+      play_note(fcw, dur);
+      if (fcw != REST)
+         want.push_back(Start { due, fcw });
+      due += dur;
+   }
+   if (mock_ms != t0)
+      blocked++;
+   run_until_idle(step_at, false);
+   return (compare(want, first, step_at, t0));
+}
+
+static int song_trial(Song *song, int len) {
+   std::vector<Start> want;
+   std::vector<unsigned long> step_at;
+   size_t first = starts.size();
+   unsigned long t0 = mock_ms, due = mock_ms;
+   int k;
+
+   start_song(song, len, false);
+   for (k = 0; k < len; k++) {
+      if (song[k].fcw != REST)
+         want.push_back(Start { due, song[k].fcw });
+      due += song[k].duration;
+   }
+   run_until_idle(step_at, true);
+   return (compare(want, first, step_at, t0));
+}
+
+static int duck_trial(Song *song, int len) {
+   std::vector<Start> want;
+   std::vector<unsigned long> step_at;
+   size_t first = starts.size();
+   unsigned long t0 = mock_ms, due = mock_ms, total = 0, t_kick, left;
+   int k;
+
+   for (k = 0; k < len; k++)
+      total += song[k].duration;
+   start_song(song, len, false);
+   t_kick = t0 + rnd((int) total);
+   while (mock_ms < t_kick) {
+      mock_ms += 1 + rnd(MAX_STEP_MS);
+      step_at.push_back(mock_ms);
+      timed_tick();
+   }
+   t_kick = mock_ms;
+   if (t_kick >= t0 + total) {
+      run_until_idle(step_at, true);
+      return (0);                       // song over before the kick
+   }
+   play_kick_sound();
+
+   for (k = 0; k < len; k++) {
+      if (due <= t_kick && due + song[k].duration > t_kick) {
+         // the note the kick cuts into
+         if (song[k].fcw != REST)
+            want.push_back(Start { due, song[k].fcw });
+         want.push_back(Start { t_kick, NOTE_C5 });
+         left = due + song[k].duration - t_kick;
+         if (song[k].fcw != REST && left >= RESUME_MS)
+            want.push_back(Start { t_kick + KICK_MS, song[k].fcw });
+      } else if (song[k].fcw != REST) {
+         want.push_back(Start { due > t_kick ? due + KICK_MS : due, song[k].fcw });
+      }
+      due += song[k].duration;
+   }
+   run_until_idle(step_at, true);
+   return (compare(want, first, step_at, t0));
+}
+
+// wall time of the calls that used to sleep or poll
+static void time_calls() {
+   double t0, ns;
+   int i;
+
+   for (i = 0; i < 1000; i++) {
+      t0 = seconds();
+      play_goal_tune();
+      play_kick_sound();
+      play_countdown_beep(i % 4);
+      ns = (seconds() - t0) * 1e9;
+      call_ns_sum += ns;
+      call_n += 3;
+      audio_clear();
+   }
+}
+
+int main() {
+   Song *songs[] = { mario_intro, luffy_theme, zoro_theme, smash_splash };
+   const int lens[] = { mario_intro_len, luffy_theme_len, zoro_theme_len,
+                        smash_splash_len };
+   int t, bad = 0, qbad = 0, sbad = 0, dbad = 0;
+   unsigned long before;
+
+   init_audio(&ddfs, &adsr);
+   for (t = 0; t < TRIALS; t++)
+      qbad += queue_trial();
+   for (t = 0; t < 4 * 50; t++)
+      sbad += song_trial(songs[t % 4], lens[t % 4]);
+   for (t = 0; t < TRIALS; t++)
+      dbad += duck_trial(songs[t % 4], lens[t % 4]);
+   before = mock_ms;
+   time_calls();
+   if (mock_ms != before)
+      blocked++;
+
+   bad = qbad + sbad + dbad + blocked + adsr_reads;
+   printf("queue: %d runs, song: %d runs, ducked song: %d runs, %ld notes, "
+         "%d + %d + %d mismatches\n", TRIALS, 4 * 50, TRIALS, err_n, qbad,
+         sbad, dbad);
+   printf("start error: mean %.1f ms, max %ld ms (steps up to %d ms)\n",
+         err_n ? err_sum / err_n : 0.0, err_max, MAX_STEP_MS);
+   printf("blocking: %d blocking calls, %d adsr status reads, %.0f ns per call\n",
+         blocked, adsr_reads, call_n ? call_ns_sum / call_n : 0.0);
+   return (bad > 0 ? 1 : 0);
+}
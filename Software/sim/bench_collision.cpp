@@ -0,0 +1,179 @@
+/*****************************************************************//**
+ * @file bench_collision.cpp
+ *
+ * @brief host benchmark of the collision world
+ *
+ * Description:
+ *  - fills a field with moving balls (circles) and static blocks
+ *    (boxes) at a constant density and steps it: move, bounce off
+ *    the walls, collide(), elastic velocity response per contact
+ *  - the field grows with the entity count, so contacts per entity
+ *    stay about the same and the cost shows how the broadphase scales
+ *  - prints per entity count: broadphase pairs (vs n*(n-1)/2),
+ *    contacts per step, steps and contacts resolved per second
+ *  - checks the contact normals of fx_unit() against two operator/
+ *    divides (the code before it) for random vectors up to
+ *    NORMAL_PX long: at most NORMAL_LSB off per component
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h -DCOLL_MAX_ENTITIES=1024
+ *       -DCOLL_MAX_CONTACTS=4096 sim/bench_collision.cpp
+ *       collision_world.cpp -o bench_collision
+ *  - exit status 1 if a normal is off by more than NORMAL_LSB
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "collision_world.h"
+
+static const int BLOCK_EVERY = 4;        // one static block per 4 entities
+static const int AREA_PER_ENTITY = 1600; // px^2 (40 x 40)
+static const double RUN_SECONDS = 0.5;
+static const int NORMALS = 10000000;
+static const int NORMAL_PX = 64;         // longer than any contact
+static const int NORMAL_LSB = 3;
+
+static CollisionWorld world;
+static phys_t vx[CollisionWorld::MAX_ENTITIES];
+static phys_t vy[CollisionWorld::MAX_ENTITIES];
+static bool moving[CollisionWorld::MAX_ENTITIES];
+static uint32_t rng = 0x2545f491;
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+static void build(int n, int w, int h) {
+   int i, id;
+
+   world.clear();
+   for (i = 0; i < n; i++) {
+      phys_t x(16 + rnd(w - 32));
+      phys_t y(16 + rnd(h - 32));
+      if (i % BLOCK_EVERY == 0) {
+         id = world.add_box(x, y, phys_t(4 + rnd(5)), phys_t(4 + rnd(5)),
+               CollisionWorld::COLL_STATIC, 0, 1, 1);
+         moving[id] = false;
+         vx[id] = vy[id] = phys_t(0);
+      } else {
+         id = world.add_circle(x, y, phys_t(6 + rnd(5)), 0, 1, 1, 1);
+         moving[id] = true;
+         vx[id] = phys_t(rnd(7) - 3);
+         vy[id] = phys_t(rnd(7) - 3);
+      }
+   }
+}
+
+// one step; returns contacts resolved
+static int step(int n, int w, int h) {
+   int i, k, a, b, contacts;
+   phys_t zero(0), rel;
+
+   for (i = 0; i < n; i++) {
+      if (!moving[i])
+         continue;
+      phys_t x = world.pos_x(i) + vx[i];
+      phys_t y = world.pos_y(i) + vy[i];
+      if (x < zero || x > phys_t(w))
+         vx[i] = -vx[i];
+      if (y < zero || y > phys_t(h))
+         vy[i] = -vy[i];
+      world.set_pos(i, x, y);
+   }
+   contacts = world.collide();
+   for (k = 0; k < world.contacts(); k++) {
+      const CollisionWorld::Contact &c = world.contact(k);
+      a = c.a;
+      b = c.b;
+      rel = (vx[b] - vx[a]) * c.nx + (vy[b] - vy[a]) * c.ny;
+      if (rel >= zero)
+         continue;   // already separating
+      if (moving[a] && moving[b]) {
+         // equal masses: exchange the normal components
+         vx[a] += c.nx * rel;
+         vy[a] += c.ny * rel;
+         vx[b] -= c.nx * rel;
+         vy[b] -= c.ny * rel;
+      } else if (moving[a]) {
+         vx[a] += c.nx * rel * 2;
+         vy[a] += c.ny * rel * 2;
+      } else if (moving[b]) {
+         vx[b] -= c.nx * rel * 2;
+         vy[b] -= c.ny * rel * 2;
+      }
+   }
+   return (contacts);
+}
+
+// fx_unit() against the divides; returns the normals off by more
+// than NORMAL_LSB
+static int check_normals(int &max_lsb) {
+   phys_t dx, dy, dist, nx, ny;
+   int i, e, bad = 0;
+
+   max_lsb = 0;
+   for (i = 0; i < NORMALS; i++) {
+      // lengths over the whole range: 1 LSB to NORMAL_PX
+      int bits = rnd(16 + 7);
+      dx = phys_t::from_raw(rnd(2 << bits) - (1 << bits));
+      dy = phys_t::from_raw(rnd(2 << bits) - (1 << bits));
+      if (fx_abs(dx) > phys_t(NORMAL_PX) || fx_abs(dy) > phys_t(NORMAL_PX))
+         continue;
+      dist = fx_sqrt(dx * dx + dy * dy);
+      if (dist <= phys_t(0))
+         continue;
+      fx_unit(dx, dy, dist, nx, ny);
+      e = abs((nx - dx / dist).raw);
+      if (abs((ny - dy / dist).raw) > e)
+         e = abs((ny - dy / dist).raw);
+      if (e > max_lsb)
+         max_lsb = e;
+      bad += (e > NORMAL_LSB);
+   }
+   return (bad);
+}
+
+int main() {
+   int n, w, h, steps, bad, max_lsb;
+   uint64_t contacts, pairs;
+   double t0, t;
+
+   printf("%8s %12s %12s %10s %12s %14s\n", "entities", "pairs/step",
+         "all pairs", "hits/step", "steps/s", "contacts/s");
+   for (n = 16; n <= CollisionWorld::MAX_ENTITIES; n *= 2) {
+      w = (int) sqrt(n * AREA_PER_ENTITY * 4.0 / 3.0);
+      h = w * 3 / 4;
+      build(n, w, h);
+      for (steps = 0; steps < 50; steps++)   // settle the initial overlaps
+         step(n, w, h);
+      steps = 0;
+      contacts = pairs = 0;
+      t0 = seconds();
+      do {
+         contacts += step(n, w, h);
+         pairs += world.pairs_tested();
+         steps++;
+      } while ((t = seconds() - t0) < RUN_SECONDS);
+      printf("%8d %12.1f %12d %10.2f %12.0f %14.0f\n", n,
+            (double) pairs / steps, n * (n - 1) / 2,
+            (double) contacts / steps, steps / t, contacts / t);
+   }
+   bad = check_normals(max_lsb);
+   printf("normals: %d random vectors, max %d LSB off the divides, "
+         "%d over %d\n", NORMALS, max_lsb, bad, NORMAL_LSB);
+   return (bad > 0 ? 1 : 0);
+}
@@ -0,0 +1,99 @@
+/*****************************************************************//**
+ * @file bench_fmt.cpp
+ *
+ * @brief host check and benchmark of the integer formatters
+ *
+ * Description:
+ *  - checks fmt_uint() against snprintf("%*u") / ("%0*u") for every
+ *    value below 2^20, sampled values up to 2^32 and widths 0..10,
+ *    and fmt_mmss() against snprintf("%02u:%02u") for 0..359999 s
+ *  - prints ns per formatted field for the scoreboard fields (score
+ *    below 100, MM:SS) with num_fmt and with snprintf
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. sim/bench_fmt.cpp num_fmt.cpp -o bench_fmt
+ *  - exit status 1 on any mismatch
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "num_fmt.h"
+
+static const int REPS = 10000000;
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+static int check_uint(uint32_t v, int width, char pad) {
+   char a[16], b[16];
+
+   fmt_uint(a, v, width, pad);
+   if (pad == '0')
+      snprintf(b, sizeof(b), "%0*u", width, (unsigned) v);
+   else
+      snprintf(b, sizeof(b), "%*u", width, (unsigned) v);
+   return (strcmp(a, b) != 0);
+}
+
+int main() {
+   char buf[16];
+   volatile char sink = 0;
+   uint32_t v, x = 0x2545f491;
+   double t0, t_fmt, t_pf, t_mm, t_pfmm;
+   int i, w, bad = 0;
+
+   for (v = 0; v < (1u << 20); v++)
+      bad += check_uint(v, 0, ' ');
+   for (i = 0; i < 1000000; i++) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      w = i % 11;
+      bad += check_uint(x >> (i % 32), w, (i & 1) ? '0' : ' ');
+   }
+   bad += check_uint(0xffffffffu, 0, ' ');
+   for (v = 0; v < 360000; v++) {
+      char b[16];
+      fmt_mmss(buf, v);
+      snprintf(b, sizeof(b), "%02u:%02u", (unsigned) (v / 60), (unsigned) (v % 60));
+      bad += (strcmp(buf, b) != 0);
+   }
+
+   // scoreboard fields: a score and the clock
+   t0 = seconds();
+   for (i = 0; i < REPS; i++) {
+      fmt_uint(buf, (uint32_t) i & 63, 0, ' ');
+      sink += buf[0];
+   }
+   t_fmt = (seconds() - t0) * 1e9 / REPS;
+   t0 = seconds();
+   for (i = 0; i < REPS; i++) {
+      snprintf(buf, sizeof(buf), "%d", i & 63);
+      sink += buf[0];
+   }
+   t_pf = (seconds() - t0) * 1e9 / REPS;
+   t0 = seconds();
+   for (i = 0; i < REPS; i++) {
+      fmt_mmss(buf, (uint32_t) i & 1023);
+      sink += buf[4];
+   }
+   t_mm = (seconds() - t0) * 1e9 / REPS;
+   t0 = seconds();
+   for (i = 0; i < REPS; i++) {
+      v = (uint32_t) i & 1023;
+      snprintf(buf, sizeof(buf), "%02d:%02d", (int) (v / 60), (int) (v % 60));
+      sink += buf[4];
+   }
+   t_pfmm = (seconds() - t0) * 1e9 / REPS;
+
+   printf("mismatches: %d\n", bad);
+   printf("score (%%d):     fmt_uint %5.1f ns   snprintf %5.1f ns\n", t_fmt, t_pf);
+   printf("clock (MM:SS):  fmt_mmss %5.1f ns   snprintf %5.1f ns\n", t_mm, t_pfmm);
+   return ((bad > 0 || sink == 1) ? 1 : 0);
+}
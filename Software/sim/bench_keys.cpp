@@ -0,0 +1,392 @@
+/*****************************************************************//**
+ * @file bench_keys.cpp
+ *
+ * @brief host check of the ps2 key input path
+ *
+ * Description:
+ *  - replay: random scan-code streams (makes, typematic repeats,
+ *    breaks, stray breaks, 0xE0 keys, Pause, status bytes, sequences
+ *    cut by a status byte) are fed byte by byte to Ps2Input::decode();
+ *    the events must match a reference model of the keyboard, with
+ *    the time stamp of the last byte, and KeyState must follow it
+ *  - ring: random push/pop against a queue model, with overflow
+ *  - full ring: makes and a resync sent while the event ring is full
+ *    are dropped, but must come through on the next repeat once the
+ *    game has drained the ring (no stuck or dead keys)
+ *  - throughput: THROUGHPUT_BYTES synthetic bytes (the replay mix)
+ *    through poll()'s decode path, drained every 16 bytes; prints ns
+ *    per byte and per event
+ *  - latency: runs the firmware main() on the virtual bus with key
+ *    presses (D and the extended RIGHT) at random times during
+ *    matches; at every vertical blanking checks whether the game's
+ *    KeyState holds the key; press to first frame with the key held
+ *    must stay within one physics tick plus two frames (the frame
+ *    sample itself adds up to one frame)
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h -Dmain=game_main *.cpp
+ *       sim/sim_bus.cpp sim/bench_keys.cpp -o bench_keys
+ *  - exit status 1 on any mismatch, a key lost to a full ring, a press
+ *    the game never saw, or a latency over the bound
+ *
+ ********************************************************************/
+
+#undef main   // the firmware main() is game_main
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <deque>
+#include <vector>
+#include "sim_bus.h"
+#include "key_input.h"
+#include "game_physics.h"
+
+int game_main();
+
+extern GameState game;
+extern bool game_over;
+extern KeyState keys;
+
+static const int REPLAY_ACTIONS = 1000000;
+static const int RING_OPS = 1000000;
+static const int THROUGHPUT_BYTES = 50000000;
+static const int RUN_MS = 120000;
+static const double FRAME_MS = SimBus::RASTER_LINES * SimBus::RASTER_LINE_CLKS
+      / (SYS_CLK_FREQ * 1000.0);
+static const double MAX_LATENCY_MS = PHYSICS_TICK_MS + 2 * FRAME_MS;
+
+static uint32_t rng = 0x2545f491;
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+/**********************************************************************
+ * replay of scan-code streams
+ *********************************************************************/
+static const int KEYS[] = {
+   0x1c, 0x23, 0x1d, 0x29, 0x4d, 0x5a, 0x6b, 0x74, 0x75, 0x72,    // plain
+   KEY_EXT | 0x6b, KEY_EXT | 0x74, KEY_EXT | 0x75, KEY_EXT | 0x72  // E0 kk
+};
+static const int NUM_KEYS = sizeof(KEYS) / sizeof(KEYS[0]);
+static const uint8_t SYNC_BYTES[] = { 0x00, 0xff, 0xaa, 0xfa, 0xfe, 0xee };
+static const uint8_t PAUSE_BYTES[] = { 0xe1, 0x14, 0x77, 0xe1, 0xf0, 0x14, 0xf0, 0x77 };
+
+static Ps2Input dec(0);        // decode() does not touch the core
+static uint32_t t_us;
+
+static void feed(uint8_t b) {
+   dec.decode(b, ++t_us);
+}
+
+static void feed_key(int code, bool brk) {
+   if (code & KEY_EXT)
+      feed(0xe0);
+   if (brk)
+      feed(0xf0);
+   feed((uint8_t) code);
+}
+
+static int replay() {
+   bool held[NUM_KEYS] = { false };
+   std::vector<KeyEvent> want;
+   KeyState state;
+   KeyEvent ev;
+   int a, k, i, n, bad = 0, events = 0;
+
+   for (a = 0; a < REPLAY_ACTIONS; a++) {
+      k = rnd(NUM_KEYS);
+      want.clear();
+      switch (rnd(8)) {
+      case 0:            // make: an event unless already held (repeat)
+      case 1:
+      case 2:
+         feed_key(KEYS[k], false);
+         if (!held[k])
+            want.push_back(KeyEvent { t_us, (uint16_t) KEYS[k], 0 });
+         held[k] = true;
+         break;
+      case 3:            // break: an event unless not held (stray)
+      case 4:
+      case 5:
+         feed_key(KEYS[k], true);
+         if (held[k])
+            want.push_back(KeyEvent { t_us, (uint16_t) KEYS[k], 1 });
+         held[k] = false;
+         break;
+      case 6:            // Pause: no event, no state change
+         for (i = 0; i < (int) sizeof(PAUSE_BYTES); i++)
+            feed(PAUSE_BYTES[i]);
+         break;
+      default:           // status byte, maybe inside a sequence
+         n = rnd(3);
+         if (n == 1)
+            feed(0xe0);
+         else if (n == 2)
+            feed(0xf0);
+         feed(SYNC_BYTES[rnd(sizeof(SYNC_BYTES))]);
+         want.push_back(KeyEvent { t_us, (uint16_t) KEY_ALL_UP, 1 });
+         memset(held, 0, sizeof(held));
+         break;
+      }
+      for (i = 0; dec.next_event(&ev); i++) {
+         events++;
+         if (i >= (int) want.size() || ev.code != want[i].code
+               || ev.is_break != want[i].is_break || ev.t_us != want[i].t_us)
+            bad++;
+         state.apply(ev);
+      }
+      if (i != (int) want.size())
+         bad++;
+      for (i = 0; i < NUM_KEYS; i++) {
+         if (state.is_down(KEYS[i]) != (held[i] ? 1 : 0))
+            bad++;
+      }
+   }
+   printf("replay: %d actions, %u bytes, %d events, %d mismatches\n",
+         REPLAY_ACTIONS, (unsigned) t_us, events, bad);
+   return (bad);
+}
+
+/**********************************************************************
+ * ring against a queue model
+ *********************************************************************/
+static int ring_check() {
+   KeyEventRing<8> ring;
+   std::deque<uint32_t> model;
+   KeyEvent ev;
+   uint32_t seq = 0, lost = 0;
+   int op, bad = 0, ok;
+
+   for (op = 0; op < RING_OPS; op++) {
+      if (rnd(2)) {
+         ev.t_us = ++seq;
+         ev.code = (uint16_t) seq;
+         ev.is_break = 0;
+         ok = ring.push(ev);
+         if (model.size() < 7) {
+            model.push_back(seq);
+            bad += (ok != 1);
+         } else {
+            lost++;
+            bad += (ok != 0);
+         }
+      } else {
+         ok = ring.pop(&ev);
+         if (model.empty()) {
+            bad += (ok != 0);
+         } else {
+            bad += (ok != 1 || ev.t_us != model.front());
+            model.pop_front();
+         }
+      }
+      bad += (ring.empty() != model.empty());
+   }
+   bad += (ring.dropped() != lost);
+   printf("ring: %d ops, %u dropped, %d mismatches\n", RING_OPS,
+         (unsigned) lost, bad);
+   return (bad);
+}
+
+/**********************************************************************
+ * events dropped by a full ring are sent again
+ *********************************************************************/
+static int full_ring() {
+   KeyState state;
+   KeyEvent ev;
+   int i, bad = 0;
+
+   while (dec.next_event(&ev))
+      ;
+   feed(0xaa);                    // start from all keys up
+   while (dec.next_event(&ev))
+      ;
+   // fill the ring with makes of other keys, then press D (dropped)
+   for (i = 0; i < Ps2Input::RING_SIZE - 1; i++) {
+      feed_key(KEY_EXT | i, false);
+      feed_key(KEY_EXT | i, true);
+   }
+   feed_key(0x23, false);
+   while (dec.next_event(&ev))
+      state.apply(ev);
+   // typematic repeat of D: the game must now see it held
+   feed_key(0x23, false);
+   while (dec.next_event(&ev))
+      state.apply(ev);
+   bad += !state.is_down(0x23);
+
+   // a resync dropped by a full ring: the next break of D still counts
+   for (i = 0; i < Ps2Input::RING_SIZE - 1; i++) {
+      feed_key(KEY_EXT | i, false);
+      feed_key(KEY_EXT | i, true);
+   }
+   feed(0xaa);
+   while (dec.next_event(&ev))
+      state.apply(ev);
+   feed_key(0x23, true);
+   while (dec.next_event(&ev))
+      state.apply(ev);
+   bad += state.is_down(0x23);
+   printf("full ring: %u events dropped, %d keys lost\n",
+         (unsigned) dec.dropped(), bad);
+   return (bad);
+}
+
+/**********************************************************************
+ * decoder throughput
+ *********************************************************************/
+static int throughput() {
+   std::vector<uint8_t> bytes;
+   KeyEvent ev;
+   double t0, t;
+   int k, i, events = 0;
+   bool held[NUM_KEYS] = { false };
+
+   // the replay mix, as one byte stream
+   while ((int) bytes.size() < THROUGHPUT_BYTES) {
+      k = rnd(NUM_KEYS);
+      switch (rnd(8)) {
+      case 6:
+         bytes.insert(bytes.end(), PAUSE_BYTES, PAUSE_BYTES + sizeof(PAUSE_BYTES));
+         break;
+      case 7:
+         bytes.push_back(SYNC_BYTES[rnd(sizeof(SYNC_BYTES))]);
+         break;
+      default:
+         if (KEYS[k] & KEY_EXT)
+            bytes.push_back(0xe0);
+         if (held[k])
+            bytes.push_back(0xf0);
+         bytes.push_back((uint8_t) KEYS[k]);
+         held[k] = !held[k];
+         break;
+      }
+   }
+   t0 = seconds();
+   for (i = 0; i < (int) bytes.size(); i++) {
+      dec.decode(bytes[i], (uint32_t) i);
+      if ((i & 15) == 15) {
+         while (dec.next_event(&ev))
+            events++;
+      }
+   }
+   while (dec.next_event(&ev))
+      events++;
+   t = seconds() - t0;
+   printf("throughput: %d bytes, %d events, %.2f ns per byte, %.2f ns per "
+         "event (%.0f Mbyte/s)\n", (int) bytes.size(), events,
+         t * 1e9 / bytes.size(), t * 1e9 / events, bytes.size() / t * 1e-6);
+   return (0);
+}
+
+/**********************************************************************
+ * press to KeyState latency in the game
+ *********************************************************************/
+struct Press {
+   double t_ms;
+   int code;                    // KeyState code
+};
+
+static std::vector<Press> presses;
+static size_t next_press;       // first press not yet resolved
+static double clk_ms;
+static uint32_t last_tick, last_score;
+static double tick_ms;          // virtual time of the last physics tick seen
+static int seen, skipped, missed, over;
+static double lat_sum, lat_max;
+
+// vertical blanking: resolve presses against the game's KeyState
+static void sample(uint64_t frame) {
+   double t_ms = sim_bus().now_clk() * clk_ms, lat;
+   uint32_t tick = game.tick;
+   uint32_t score = game.score[0] + game.score[1];
+   bool playing;
+
+   (void) frame;
+   if (tick != last_tick)
+      tick_ms = t_ms;
+   // ticks run at least every PHYSICS_TICK_MS in a match (goal pause,
+   // menus: none)
+   playing = t_ms - tick_ms <= PHYSICS_TICK_MS + FRAME_MS
+         && score == last_score && !game_over;
+   while (next_press < presses.size() && presses[next_press].t_ms <= t_ms) {
+      const Press &p = presses[next_press];
+
+      if (!playing) {
+         skipped++;               // menus, goal pause: not consumed
+      } else if (keys.is_down(p.code)) {
+         lat = t_ms - p.t_ms;
+         seen++;
+         lat_sum += lat;
+         if (lat > lat_max)
+            lat_max = lat;
+         if (lat > MAX_LATENCY_MS)
+            over++;
+      } else if (t_ms - p.t_ms > MAX_LATENCY_MS) {
+         missed++;
+      } else {
+         break;                   // not yet; look again next frame
+      }
+      next_press++;
+   }
+   last_tick = tick;
+   last_score = score;
+}
+
+static void finish() {
+   bool bad = missed > 0 || over > 0 || seen == 0;
+
+   printf("latency: %d presses in play, %d outside play, %d missed, "
+         "press to KeyState mean %.1f ms, max %.1f ms (bound %.1f), %d over\n",
+         seen, skipped, missed, seen ? lat_sum / seen : 0.0, lat_max,
+         MAX_LATENCY_MS, over);
+   exit(bad ? 1 : 0);
+}
+
+static void script(SimBus &bus) {
+   Press p;
+   int t;
+
+   for (t = 500; t < RUN_MS; t += 3000)
+      bus.press_key(t, 0x5a, 100);            // ENTER (menus)
+   for (t = 6000 + rnd(100); t < RUN_MS; t += 250 + rnd(200)) {
+      p.t_ms = t;
+      if (rnd(2)) {
+         bus.press_key(t, 0x23, 120);         // D: p1 right
+         p.code = 0x23;
+      } else {
+         bus.press_key(t, 0xe074, 120);       // RIGHT: p2 right
+         p.code = KEY_EXT | 0x74;
+      }
+      presses.push_back(p);
+   }
+}
+
+int main() {
+   SimBus &bus = sim_bus();
+   int bad;
+
+   bad = replay() + ring_check() + full_ring() + throughput();
+   if (bad)
+      return (1);
+   clk_ms = 1.0 / (SYS_CLK_FREQ * 1000.0);
+   script(bus);
+   bus.set_frame_hook(sample);
+   bus.set_limit_ms(RUN_MS, finish);
+   game_main();
+   finish();
+   return (0);
+}
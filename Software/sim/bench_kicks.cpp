@@ -0,0 +1,317 @@
+/*****************************************************************//**
+ * @file bench_kicks.cpp
+ *
+ * @brief host tunnelling check and cost benchmark of the ball physics
+ *
+ * Description:
+ *  - aimed shots: the ball starts clear of a player or post top and is
+ *    fired at it at 9..32 px per tick, so it reaches the obstacle within
+ *    one physics_step()
+ *  - kicks: a (grounded or jumping) player kicks a ball touching its
+ *    inner side; the ball then flies for KICK_TICKS steps past the other
+ *    player and the posts, all positions random
+ *  - every step the straight path of the ball center is checked in
+ *    double precision against each obstacle grown by the ball radius;
+ *    the first one entered by more than 1 px must stop the ball on the
+ *    entry side, otherwise the step counts as a tunnel
+ *  - steps whose path leaves the field are skipped (the ground and
+ *    wall clamps act first there); wall shots check the clamp
+ *  - also times physics_step() for a slow rolling ball (one step, the
+ *    common case) and a fast flying ball (substeps)
+ *  - exit status 1 if any shot tunnelled
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h sim/bench_kicks.cpp game_physics.cpp
+ *       collision_world.cpp -o bench_kicks
+ *   add -DPHYSICS_NO_CCD (single step) or -DPHYSICS_FLOAT to compare
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "game_physics.h"
+
+static const int SHOTS = 20000;
+static const int KICKS = 5000;
+static const int KICK_TICKS = 60;
+static const int TIMED_STEPS = 200000;
+static const int PATH_SAMPLES = 500;
+static const double PLAYER_R = PLAYER_W / 2.0 * 0.8;
+static const double BALL_R = BALL_W / 2.0;
+static const double POST_HALF = GOALPOST_W / 2.0;
+
+/* obstacle kinds */
+enum {
+   OBS_CIRCLE = 0,
+   OBS_BOX = 1
+};
+
+struct Obstacle {
+   int kind;
+   double x, y;      // center
+   double r;         // radius (circle) or half side (box)
+};
+
+static int sounds;
+static GameState gs;
+static uint32_t rng = 0x9e3779b9;
+
+void play_kick_sound() {
+   sounds++;
+}
+
+void play_collision_sound() {
+   sounds++;
+}
+
+static double frand() {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((rng >> 8) / 16777216.0);
+}
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+static double to_double(phys_t v) {
+   return ((double) fx_to_int(v * 1024) / 1024.0);
+}
+
+// distance from a point to an obstacle (0 inside a box); *nx, *ny is
+// the unit vector from the obstacle to the point
+static double obs_dist(const Obstacle &o, double px, double py,
+      double *nx, double *ny) {
+   double dx, dy, d;
+
+   if (o.kind == OBS_CIRCLE) {
+      dx = px - o.x;
+      dy = py - o.y;
+   } else {
+      dx = px - fmax(o.x - o.r, fmin(px, o.x + o.r));
+      dy = py - fmax(o.y - o.r, fmin(py, o.y + o.r));
+   }
+   d = sqrt(dx * dx + dy * dy);
+   if (d > 0.0) {
+      *nx = dx / d;
+      *ny = dy / d;
+   }
+   return ((o.kind == OBS_CIRCLE) ? d - o.r : d);
+}
+
+static int obstacles(Obstacle *o) {
+   double cap_y = SCREEN_H - GROUND_OFFSET - GOALPOST_H + POST_HALF;
+
+   o[0].kind = o[1].kind = OBS_CIRCLE;
+   o[0].r = o[1].r = PLAYER_R;
+   o[0].x = gs.x[ENT_P1] + PLAYER_W / 2.0;
+   o[0].y = gs.y[ENT_P1] + PLAYER_H / 2.0;
+   o[1].x = gs.x[ENT_P2] + PLAYER_W / 2.0;
+   o[1].y = gs.y[ENT_P2] + PLAYER_H / 2.0;
+   o[2].kind = o[3].kind = OBS_BOX;
+   o[2].r = o[3].r = POST_HALF;
+   o[2].x = GOALPOST_INSET + POST_HALF;
+   o[3].x = SCREEN_W - GOALPOST_INSET - POST_HALF;
+   o[2].y = o[3].y = cap_y;
+   return (4);
+}
+
+// run one step and check the ball path; returns 1 on a tunnel, 0 if
+// it stopped on the entry side, -1 if no obstacle was in the way
+static int checked_step(bool p1_kick, bool p2_kick) {
+   Obstacle o[4];
+   double x0 = gs.x[ENT_BALL] + BALL_R, y0 = gs.y[ENT_BALL] + BALL_R;
+   double vx = to_double(gs.vx[ENT_BALL]), vy = to_double(gs.vy[ENT_BALL] + GRAVITY);
+   double x1 = x0 + vx, y1 = y0 + vy, nx = 0.0, ny = 0.0, t, px, py;
+   int i, k, n, hit = -1;
+
+   gs.match_ms += 1000;
+   physics_step(gs, p1_kick, p2_kick);
+   if (x1 < BALL_R || x1 > SCREEN_W - BALL_R || y1 > BALL_GROUND_Y + BALL_R)
+      return (-1);
+   n = obstacles(o);
+   // drop obstacles the path cannot reach
+   for (i = 0; i < n; i++) {
+      if (hypot(o[i].x - (x0 + x1) / 2, o[i].y - (y0 + y1) / 2)
+            > hypot(vx, vy) / 2 + o[i].r * M_SQRT2 + BALL_R)
+         o[i--] = o[--n];
+   }
+   if (n == 0)
+      return (-1);
+   // the first sample of the path entering an obstacle (ball radius)
+   for (k = 1; k <= PATH_SAMPLES && hit < 0; k++) {
+      t = (double) k / PATH_SAMPLES;
+      px = x0 + vx * t;
+      py = y0 + vy * t;
+      for (i = 0; i < n; i++) {
+         if (obs_dist(o[i], x0, y0, &nx, &ny) < BALL_R)
+            continue;      // overlapping at the start: not a shot
+         if (obs_dist(o[i], px, py, &nx, &ny) < BALL_R) {
+            hit = i;
+            break;
+         }
+      }
+   }
+   if (hit < 0)
+      return (-1);
+   // entered by more than 1 px anywhere on the path?
+   double deepest = BALL_R, ex, ey;
+   for (k = 0; k <= PATH_SAMPLES; k++) {
+      t = (double) k / PATH_SAMPLES;
+      deepest = fmin(deepest, obs_dist(o[hit], x0 + vx * t, y0 + vy * t, &ex, &ey));
+   }
+   if (deepest > BALL_R - 1.0)
+      return (-1);
+   // the ball must end on the side it entered from
+   px = gs.x[ENT_BALL] + BALL_R - o[hit].x;
+   py = gs.y[ENT_BALL] + BALL_R - o[hit].y;
+   return ((px * nx + py * ny < 0.0) ? 1 : 0);
+}
+
+static void place_players(int p1, int p2) {
+   gs.x[ENT_P1] = p1;
+   gs.x[ENT_P2] = p2;
+   gs.y[ENT_P1] = gs.y[ENT_P2] = PLAYER_GROUND_Y;
+   gs.vy[ENT_P1] = gs.vy[ENT_P2] = phys_t(0);
+   gs.on_ground[ENT_P1] = gs.on_ground[ENT_P2] = true;
+}
+
+// fire the ball at obstacle i from a random point clear of it
+static int aimed_shot(int target) {
+   Obstacle o[4];
+   double speed, ang, dx, dy, off, lim, reach, back, sx, sy;
+
+   place_players(40 + (int) (frand() * 220), 340 + (int) (frand() * 220));
+   obstacles(o);
+   speed = 9.0 + frand() * 23.0;
+   ang = frand() * 2.0 * M_PI;
+   dx = cos(ang);
+   dy = sin(ang);
+   lim = o[target].r + BALL_R - 2.0;
+   off = (frand() * 2.0 - 1.0) * lim;
+   // clear of the obstacle (a box counts with its corner radius)
+   reach = o[target].r * ((o[target].kind == OBS_BOX) ? M_SQRT2 : 1.0) + BALL_R;
+   back = sqrt(fmax(reach * reach - off * off, 0.0)) + 0.5 + frand() * speed * 0.9;
+   sx = o[target].x - dx * back - dy * off;
+   sy = o[target].y - dy * back + dx * off;
+   if (sx < BALL_R || sx > SCREEN_W - BALL_R || sy < BALL_R
+         || sy > BALL_GROUND_Y + BALL_R)
+      return (-1);
+   gs.x[ENT_BALL] = (int) floor(sx - BALL_R);
+   gs.y[ENT_BALL] = (int) floor(sy - BALL_R);
+   gs.vx[ENT_BALL] = phys_t(dx * speed);
+   gs.vy[ENT_BALL] = phys_t(dy * speed) - GRAVITY;
+   return (checked_step(false, false));
+}
+
+// a player kicks the ball, then it flies; returns tunnels in the flight
+static int kick(int *checked) {
+   int k, r, tunnels = 0;
+   bool by_p1 = frand() < 0.5;
+   int jump = (frand() < 0.5) ? (int) (frand() * 120) : 0;
+
+   place_players(40 + (int) (frand() * 260), 300 + (int) (frand() * 260));
+   if (by_p1) {
+      gs.y[ENT_P1] -= jump;
+      gs.on_ground[ENT_P1] = (jump == 0);
+      gs.x[ENT_BALL] = gs.x[ENT_P1] + PLAYER_W - 4;
+      gs.y[ENT_BALL] = gs.y[ENT_P1] + (int) (frand() * (PLAYER_H - BALL_H));
+   } else {
+      gs.y[ENT_P2] -= jump;
+      gs.on_ground[ENT_P2] = (jump == 0);
+      gs.x[ENT_BALL] = gs.x[ENT_P2] - BALL_W + 4;
+      gs.y[ENT_BALL] = gs.y[ENT_P2] + (int) (frand() * (PLAYER_H - BALL_H));
+   }
+   gs.vx[ENT_BALL] = gs.vy[ENT_BALL] = phys_t(0);
+   gs.last_hit_ms[0] = gs.last_hit_ms[1] = 0;
+   checked_step(by_p1, !by_p1);
+   for (k = 0; k < KICK_TICKS; k++) {
+      r = checked_step(false, false);
+      if (r >= 0)
+         (*checked)++;
+      if (r > 0)
+         tunnels++;
+   }
+   return (tunnels);
+}
+
+static int wall_shot() {
+   bool left = frand() < 0.5;
+   double speed = 9.0 + frand() * 23.0;
+
+   place_players(200, 400);
+   gs.y[ENT_BALL] = 200 + (int) (frand() * 150);
+   gs.x[ENT_BALL] = left ? (int) (frand() * speed) : SCREEN_W - BALL_W - (int) (frand() * speed);
+   gs.vx[ENT_BALL] = phys_t(left ? -speed : speed);
+   gs.vy[ENT_BALL] = phys_t(0);
+   gs.match_ms += 1000;
+   physics_step(gs, false, false);
+   return (gs.x[ENT_BALL] < 0 || gs.x[ENT_BALL] > SCREEN_W - BALL_W);
+}
+
+// ns per physics_step(); fast: re-kick the ball so it keeps flying
+static double timed(bool fast) {
+   double t0;
+   int i;
+
+   place_players(60, 540);
+   gs.x[ENT_BALL] = 200;
+   gs.y[ENT_BALL] = BALL_GROUND_Y;
+   t0 = seconds();
+   for (i = 0; i < TIMED_STEPS; i++) {
+      if (fast && (i % 20) == 0) {
+         gs.x[ENT_BALL] = 200 + (int) (frand() * 200);
+         gs.y[ENT_BALL] = 250;
+         gs.vx[ENT_BALL] = phys_t((frand() < 0.5) ? -16 : 16);
+         gs.vy[ENT_BALL] = phys_t(-6);
+      } else if (!fast && (i % 100) == 0) {
+         gs.x[ENT_BALL] = 200;
+         gs.y[ENT_BALL] = BALL_GROUND_Y;
+         gs.vx[ENT_BALL] = phys_t(3);
+         gs.vy[ENT_BALL] = phys_t(0);
+      }
+      gs.match_ms += PHYSICS_TICK_MS;
+      physics_step(gs, false, false);
+   }
+   return ((seconds() - t0) * 1e9 / TIMED_STEPS);
+}
+
+int main() {
+   static const char *name[4] = {"player 1", "player 2", "post 1", "post 2"};
+   int i, r, target, checked[4] = {0}, tunnels[4] = {0};
+   int kick_checked = 0, kick_tunnels = 0, wall_escapes = 0, total;
+   double slow, fast;
+
+   game_init(gs, 1);
+   for (i = 0; i < SHOTS; i++) {
+      target = i % 4;
+      r = aimed_shot(target);
+      if (r >= 0)
+         checked[target]++;
+      if (r > 0)
+         tunnels[target]++;
+   }
+   for (i = 0; i < KICKS; i++)
+      kick_tunnels += kick(&kick_checked);
+   for (i = 0; i < SHOTS / 4; i++)
+      wall_escapes += wall_shot();
+
+   total = kick_tunnels + wall_escapes;
+   for (i = 0; i < 4; i++) {
+      printf("shots at %-8s %6d checked %6d tunnelled\n", name[i], checked[i], tunnels[i]);
+      total += tunnels[i];
+   }
+   printf("kicks %d, contacts checked %6d, tunnelled %d\n", KICKS, kick_checked, kick_tunnels);
+   printf("wall shots %d, escaped %d\n", SHOTS / 4, wall_escapes);
+   timed(false);   // warm up
+   slow = timed(false);
+   fast = timed(true);
+   printf("physics_step: %.0f ns slow ball, %.0f ns fast ball\n", slow, fast);
+   return ((total > 0) ? 1 : 0);
+}
@@ -0,0 +1,192 @@
+/*****************************************************************//**
+ * @file bench_loop.cpp
+ *
+ * @brief host check and benchmark of the fixed-timestep game loop
+ *
+ * Description:
+ *  - runs the firmware main() on the virtual bus, like bhs_sim, with a
+ *    script that starts a match every few seconds and keeps both
+ *    players moving and kicking
+ *  - at every vertical blanking samples the physics clock (game.tick)
+ *    against virtual time; within a stretch of play (from a kickoff
+ *    or the end of a goal pause to the next goal or the match end)
+ *    the physics clock must follow virtual time at one tick per
+ *    PHYSICS_TICK_MS: its lag behind virtual time may move by less
+ *    than the backlog limit of the loop, whatever the frame work
+ *  - --clks N sets the bus cost (system clocks per io access), i.e.
+ *    how long the frame work takes; run a few values:
+ *      for c in 5 10 20 40; do ./bench_loop --clks $c; done
+ *  - prints physics ticks per virtual second (1000/PHYSICS_TICK_MS
+ *    expected), ticks per wall second, the lag spread and standard
+ *    deviation (ms; the frame-time jitter seen by the physics clock)
+ *    and the frames of play without a sprite commit
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h -Dmain=game_main *.cpp
+ *       sim/sim_bus.cpp sim/bench_loop.cpp -o bench_loop
+ *  - exit status 1 if the physics clock drifts in any stretch of play
+ *
+ ********************************************************************/
+
+#undef main   // the firmware main() is game_main
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "sim_bus.h"
+#include "game_physics.h"
+
+int game_main();
+
+extern GameState game;
+extern bool game_over;
+
+static const double TICK_MS = PHYSICS_TICK_MS;
+static const double MAX_SPREAD_MS = 4 * PHYSICS_TICK_MS;   // MAX_BACKLOG_CLKS
+static const int SETTLE_TICKS = 2;       // after a goal pause, before a stretch
+
+static struct timespec wall_start;
+static double clk_ms;                    // virtual ms per clock
+static int bus_clks = 10;
+
+/* current stretch of play */
+static bool in_play = false;
+static uint32_t tick0;                   // tick at the anchor
+static double t_ms0;                     // virtual ms at the anchor
+static uint32_t settle_until;            // tick to reach before anchoring
+static uint32_t last_tick, last_score;
+static double last_ms;
+static double lag_min, lag_max;
+static uint64_t last_moves;
+
+/* totals */
+static uint64_t all_ticks, play_ticks;
+static double play_ms;
+static double lag_sum, lag_sq;
+static uint64_t lag_n;
+static uint64_t play_frames, bare_frames;
+static int stretches, drifted;
+static double worst_spread;
+
+static double wall_seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec - wall_start.tv_sec) + (t.tv_nsec - wall_start.tv_nsec) * 1e-9;
+}
+
+static void end_stretch() {
+   double spread;
+
+   if (!in_play)
+      return;
+   in_play = false;
+   spread = lag_max - lag_min;
+   stretches++;
+   if (spread > worst_spread)
+      worst_spread = spread;
+   if (spread >= MAX_SPREAD_MS)
+      drifted++;
+}
+
+// vertical blanking: one sample of the physics clock
+static void sample(uint64_t frame) {
+   const SimBus &bus = sim_bus();
+   double t_ms = bus.now_clk() * clk_ms, lag;
+   uint32_t tick = game.tick;
+   uint32_t score = game.score[0] + game.score[1];
+   uint64_t moves = bus.move_frames();
+
+   (void) frame;
+   if (tick >= last_tick)
+      all_ticks += tick - last_tick;
+   if (tick < last_tick || score != last_score || game_over) {
+      end_stretch();                     // goal, match end or new match
+      settle_until = tick + SETTLE_TICKS;
+   } else if (in_play) {
+      lag = (t_ms - t_ms0) - (tick - tick0) * TICK_MS;
+      if (lag < lag_min)
+         lag_min = lag;
+      if (lag > lag_max)
+         lag_max = lag;
+      lag_sum += lag;
+      lag_sq += lag * lag;
+      lag_n++;
+      play_ticks += tick - last_tick;
+      play_ms += t_ms - last_ms;
+      play_frames++;
+      if (moves == last_moves)
+         bare_frames++;
+   } else if (tick > 0 && tick >= settle_until) {
+      in_play = true;                    // anchor a new stretch
+      tick0 = tick;
+      t_ms0 = t_ms;
+      lag_min = lag_max = 0;
+   }
+   last_tick = tick;
+   last_score = score;
+   last_ms = t_ms;
+   last_moves = moves;
+}
+
+static void finish() {
+   double wall = wall_seconds();
+   double mean = lag_n ? lag_sum / lag_n : 0;
+   double sd = lag_n ? sqrt(lag_sq / lag_n - mean * mean) : 0;
+
+   end_stretch();
+   printf("clks %3d: %5.2f ticks/s virtual, %7.0f ticks/s wall, lag spread %5.1f ms "
+         "(sd %4.1f), %llu of %llu frames without a commit, %d stretches, %d drifted\n",
+         bus_clks, (play_ms > 0) ? play_ticks * 1000.0 / play_ms : 0.0,
+         (wall > 0) ? all_ticks / wall : 0.0, worst_spread, sd,
+         (unsigned long long) bare_frames, (unsigned long long) play_frames,
+         stretches, drifted);
+   exit((drifted > 0 || stretches == 0) ? 1 : 0);
+}
+
+// start a match every few seconds; both players run, jump and kick
+static void script(SimBus &bus, int run_ms) {
+   int t;
+
+   for (t = 500; t < run_ms; t += 3000)
+      bus.press_key(t, 0x5a, 100);            // ENTER (menus)
+   for (t = 6000; t < run_ms; t += 1100) {
+      bus.press_key(t, 0x23, 400);            // D: p1 right
+      bus.press_key(t + 500, 0x1c, 300);      // A: p1 left
+      bus.press_key(t + 200, 0x29, 100);      // SPACE: p1 kick
+      bus.press_key(t + 100, 0xe06b, 500);    // LEFT: p2 left
+      bus.press_key(t + 700, 0xe074, 300);    // RIGHT: p2 right
+      bus.press_key(t + 300, 0x4d, 100);      // P: p2 kick
+      bus.press_key(t + 50, 0x1d, 100);       // W: p1 jump
+   }
+}
+
+int main(int argc, char *argv[]) {
+   SimBus &bus = sim_bus();
+   int i, run_ms = 60000, idle_us = 10;
+
+   for (i = 1; i < argc; i++) {
+      if (!strcmp(argv[i], "--clks") && i + 1 < argc)
+         bus_clks = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "--ms") && i + 1 < argc)
+         run_ms = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "--idle-us") && i + 1 < argc)
+         idle_us = atoi(argv[++i]);
+      else {
+         fprintf(stderr, "usage: %s [--clks N] [--ms N] [--idle-us N]\n", argv[0]);
+         return (1);
+      }
+   }
+   clk_ms = 1.0 / (SYS_CLK_FREQ * 1000.0);
+   script(bus, run_ms);
+   bus.set_cost(bus_clks, idle_us * SYS_CLK_FREQ);
+   bus.set_frame_hook(sample);
+   clock_gettime(CLOCK_MONOTONIC, &wall_start);
+   bus.set_limit_ms(run_ms, finish);
+   game_main();
+   finish();
+   return (0);
+}
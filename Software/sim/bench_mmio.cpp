@@ -0,0 +1,194 @@
+/*****************************************************************//**
+ * @file bench_mmio.cpp
+ *
+ * @brief host check and benchmark of the block io writes
+ *
+ * Description:
+ *  - host memory is mapped at BRIDGE_BASE, so the native io macros
+ *    and io_write_block()/io_fill_block() of chu_io_rw.h run as on
+ *    the board, with plain stores (sim/mem_io_bus.h sets
+ *    _VENDOR_IO_ACCESS_USED, which turns the block calls into their
+ *    io_write() fallback)
+ *  - checks both block calls against a word-by-word reference for
+ *    every length 0..64 and offsets 0..3
+ *  - prints instructions per word of a loop of io_write() calls (the
+ *    per-word path the drivers used before) and of the block calls,
+ *    counted by single-stepping the code with the x86 trap flag
+ *    (x86-64 only; (count(n) - count(0)) / n, so call overhead is not
+ *    included), and host cycles per word for a 640-word goalpost
+ *    upload and a 2400-tile osd clear
+ *  - host instructions, not MicroBlaze ones: the ratio between the
+ *    paths is the useful number
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -Wno-int-to-pointer-cast -I. sim/bench_mmio.cpp
+ *       -o bench_mmio
+ *  - the io macros cast 32-bit addresses to pointers (the warning
+ *    is expected on a 64-bit host)
+ *  - exit status 1 on any mismatch or if the io window cannot be mapped
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+#include "chu_io_map.h"
+#include "chu_io_rw.h"
+
+static const uint32_t IO_BYTES = 0x01000000;     // 16 MB io window
+static const uint32_t SLOT = BRIDGE_BASE + 0x00100000;
+static const int COUNT_WORDS = 256;
+static const int REPS = 200000;
+
+static uint32_t src[4096];
+static volatile uint64_t steps;                  // trapped instructions
+
+static uint32_t rng = 0x2545f491;
+
+static uint32_t rnd() {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return (rng);
+}
+
+static volatile uint32_t *io_word(uint32_t base, uint32_t offset) {
+   return ((volatile uint32_t *) (uintptr_t) (base + 4 * offset));
+}
+
+/* the three write paths */
+__attribute__((noinline))
+static void per_word(uint32_t base, uint32_t offset, const uint32_t *data, int n) {
+   int i;
+
+   for (i = 0; i < n; i++)
+      io_write(base, offset + i, data[i]);
+}
+
+__attribute__((noinline))
+static void block(uint32_t base, uint32_t offset, const uint32_t *data, int n) {
+   io_write_block(base, offset, data, n);
+}
+
+__attribute__((noinline))
+static void fill(uint32_t base, uint32_t offset, const uint32_t *data, int n) {
+   io_fill_block(base, offset, data[0], n);
+}
+
+static int check() {
+   int n, off, i, bad = 0;
+
+   for (n = 0; n <= 64; n++) {
+      for (off = 0; off < 4; off++) {
+         for (i = 0; i < 72; i++)
+            *io_word(SLOT, i) = 0xdeadbeef;
+         block(SLOT, off, src, n);
+         for (i = 0; i < 72; i++) {
+            uint32_t want = (i >= off && i < off + n) ? src[i - off] : 0xdeadbeef;
+            if (*io_word(SLOT, i) != want)
+               bad++;
+         }
+         for (i = 0; i < 72; i++)
+            *io_word(SLOT, i) = 0xdeadbeef;
+         fill(SLOT, off, src, n);
+         for (i = 0; i < 72; i++) {
+            uint32_t want = (i >= off && i < off + n) ? src[0] : 0xdeadbeef;
+            if (*io_word(SLOT, i) != want)
+               bad++;
+         }
+      }
+   }
+   return (bad);
+}
+
+typedef void (*write_fn)(uint32_t, uint32_t, const uint32_t *, int);
+
+#if defined(__x86_64__)
+static void on_trap(int sig) {
+   (void) sig;
+   steps++;
+}
+
+// the trap flag raises SIGTRAP after each instruction; noinline
+// functions, so the pushf below the caller's frame is safe
+__attribute__((noinline))
+static void trace_on() {
+   __asm__ volatile("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+__attribute__((noinline))
+static void trace_off() {
+   __asm__ volatile("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+}
+
+static uint64_t traced(write_fn fn, int n) {
+   steps = 0;
+   trace_on();
+   fn(SLOT, 0, src, n);
+   trace_off();
+   return (steps);
+}
+
+static double insn_per_word(write_fn fn) {
+   uint64_t base = traced(fn, 0);
+
+   return ((double) (traced(fn, COUNT_WORDS) - base) / COUNT_WORDS);
+}
+#endif
+
+static uint64_t stamp() {
+#if defined(__x86_64__)
+   return (__rdtsc());
+#else
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return ((uint64_t) t.tv_sec * 1000000000u + t.tv_nsec);
+#endif
+}
+
+static double per_word_time(write_fn fn, int n) {
+   uint64_t t0;
+   int r;
+
+   t0 = stamp();
+   for (r = 0; r < REPS; r++)
+      fn(SLOT, 0, src, n);
+   return ((double) (stamp() - t0) / ((double) REPS * n));
+}
+
+int main() {
+   void *p;
+   int i, bad;
+
+   p = mmap((void *) (uintptr_t) BRIDGE_BASE, IO_BYTES, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+   if (p != (void *) (uintptr_t) BRIDGE_BASE) {
+      printf("cannot map the io window at 0x%08x\n", (unsigned) BRIDGE_BASE);
+      return (1);
+   }
+   for (i = 0; i < 4096; i++)
+      src[i] = rnd();
+   bad = check();
+   printf("block writes: %d mismatches\n", bad);
+
+#if defined(__x86_64__)
+   signal(SIGTRAP, on_trap);
+   printf("instructions per word: io_write loop %.2f, io_write_block %.2f, "
+         "io_fill_block %.2f\n", insn_per_word(per_word), insn_per_word(block),
+         insn_per_word(fill));
+#endif
+   printf(BENCH_UNIT " per word, 640 words:  io_write loop %.2f, io_write_block %.2f\n",
+         per_word_time(per_word, 640), per_word_time(block, 640));
+   printf(BENCH_UNIT " per word, 2400 tiles: io_write loop %.2f, io_fill_block %.2f\n",
+         per_word_time(per_word, 2400), per_word_time(fill, 2400));
+   return (bad > 0 ? 1 : 0);
+}
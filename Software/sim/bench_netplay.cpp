@@ -0,0 +1,190 @@
+/*****************************************************************//**
+ * @file bench_netplay.cpp
+ *
+ * @brief host test and benchmark of rollback netplay over a uart link
+ *
+ * Description:
+ *  - two Netplay sessions in one process: board A on the uart in slot
+ *    #1, board B on a second uart model in S4_USER, cross-wired by the
+ *    virtual bus with a configurable one-way latency and byte loss
+ *  - each board plays its own player with random held inputs; both
+ *    call step() once per physics tick of virtual time and service()
+ *    when stalled
+ *  - after the match end both are run until settled(); the final
+ *    states must be identical to each other and to a plain run of
+ *    game_step() with the inputs each board actually used
+ *  - end() must give each uart back the baud rate it had before
+ *    begin() (DEBUG_BAUD)
+ *  - prints, per link setting: rollbacks per 100 ticks, mean and
+ *    deepest rollback, re-simulated ticks per tick, stalls, packet
+ *    loss, host ns per step() and per plain game_step()
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h sim/bench_netplay.cpp netplay.cpp
+ *       game_physics.cpp collision_world.cpp scheduler.cpp
+ *       uart_core.cpp timer_core.cpp chu_init.cpp sim/sim_bus.cpp
+ *       -o bench_netplay
+ *  - exit status 1 on any desync, a match that never settles or a
+ *    baud rate not restored
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sim_bus.h"
+#include "netplay.h"
+
+static const int MATCHES = 20;
+static const int MAX_TICKS = 4000;        // per match, stalls included
+static const uint32_t TICK_US = PHYSICS_TICK_MS * 1000;
+static const int DEBUG_BAUD = 9600;       // UartCore default
+
+struct Link {
+   uint32_t latency_us;
+   uint32_t loss_ppm;
+};
+
+static const Link LINKS[] = {
+   { 0, 0 },
+   { 30000, 0 },
+   { 60000, 1000 },
+   { 100000, 2000 },
+   { 150000, 5000 }
+};
+
+static UartCore uart_b(get_slot_addr(BRIDGE_BASE, S4_USER));
+static Netplay net_a(&uart);
+static Netplay net_b(&uart_b);
+static GameState gs[2];
+static uint8_t used[2][MAX_TICKS];        // inputs each board ran with
+static uint32_t rng = 0x2545f491;
+
+void play_kick_sound() {
+}
+
+void play_collision_sound() {
+}
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+// inputs held for a few ticks, like keys
+static uint8_t next_input(uint8_t held) {
+   return ((rnd(6) == 0) ? (uint8_t) rnd(16) : held);
+}
+
+static void start_state(GameState &s, uint32_t seed) {
+   game_init(s, seed);
+   game_reset_positions(s, false);
+}
+
+int main() {
+   SimBus &bus = sim_bus();
+   Netplay *net[2] = { &net_a, &net_b };
+   GameState ref;
+   uint8_t held[2], in;
+   bool over[2];
+   double t0, t_step, t_plain, steps, plain;
+   uint32_t ticks, rollbacks, resim, depth, stalls, sent, recv;
+   int l, m, b, k, ev, n, bad, desync = 0, stuck = 0;
+   int baud_bad = 0;
+
+   bus.link_uart(S4_USER, 0, 0, 1);
+   printf("%8s %6s %9s %7s %6s %8s %6s %7s %8s %8s %6s\n", "latency", "loss",
+         "rb/100t", "mean", "max", "resim/t", "stall", "pktloss", "step ns",
+         "plain ns", "desync");
+   for (l = 0; l < (int) (sizeof(LINKS) / sizeof(LINKS[0])); l++) {
+      bus.link_uart(S4_USER, LINKS[l].latency_us, LINKS[l].loss_ppm, l + 1);
+      ticks = rollbacks = resim = depth = stalls = sent = recv = 0;
+      t_step = t_plain = steps = plain = 0;
+      bad = 0;
+      for (m = 0; m < MATCHES; m++) {
+         for (b = 0; b < 2; b++) {
+            start_state(gs[b], m + 1);
+            held[b] = 0;
+            over[b] = false;
+         }
+         net_a.begin(&gs[0], ENT_P1, (uint8_t) m);
+         net_b.begin(&gs[1], ENT_P2, (uint8_t) m);
+         for (k = 0; k < MAX_TICKS; k++) {
+            if (over[0] && over[1] && net_a.settled() && net_b.settled())
+               break;
+            for (b = 0; b < 2; b++) {
+               if (over[b]) {
+                  net[b]->service();
+                  continue;
+               }
+               in = next_input(held[b]);
+               t0 = seconds();
+               ev = net[b]->step(in);
+               if (ev >= 0) {
+                  t_step += seconds() - t0;
+                  steps++;
+                  used[b][net[b]->frame() - 1] = in;
+                  held[b] = in;
+                  over[b] = (ev & EV_MATCH_OVER) != 0;
+               } else {
+                  net[b]->service();
+               }
+            }
+            bus.advance_us(TICK_US);
+         }
+         if (k == MAX_TICKS) {
+            stuck++;
+            continue;
+         }
+         // both boards against a plain run with the inputs they used
+         start_state(ref, m + 1);
+         n = net_a.frame();
+         t0 = seconds();
+         for (k = 0; k < n; k++)
+            game_step(ref, used[0][k], used[1][k]);
+         t_plain += seconds() - t0;
+         plain += n;
+         if (n != net_b.frame() || memcmp(&gs[0], &ref, sizeof(ref)) != 0
+               || memcmp(&gs[1], &ref, sizeof(ref)) != 0)
+            bad++;
+         for (b = 0; b < 2; b++) {
+            const Netplay::Stats &s = net[b]->stats();
+            ticks += s.ticks;
+            rollbacks += s.rollbacks;
+            resim += s.resim_ticks;
+            stalls += s.stalls;
+            sent += s.pkt_sent;
+            recv += s.pkt_recv;
+            if (s.max_depth > depth)
+               depth = s.max_depth;
+         }
+         net_a.end();
+         net_b.end();
+         if (uart.get_baud_rate() != DEBUG_BAUD
+               || uart_b.get_baud_rate() != DEBUG_BAUD)
+            baud_bad++;
+      }
+      printf("%6ums %5.2f%% %9.1f %7.2f %6u %8.2f %6u %6.1f%% %8.0f %8.0f %6d\n",
+            (unsigned) (LINKS[l].latency_us / 1000), LINKS[l].loss_ppm / 1e4,
+            100.0 * rollbacks / ticks, rollbacks ? (double) resim / rollbacks : 0.0,
+            (unsigned) depth, (double) resim / ticks, (unsigned) stalls,
+            sent ? 100.0 * (sent - recv) / sent : 0.0,
+            steps ? t_step * 1e9 / steps : 0.0, plain ? t_plain * 1e9 / plain : 0.0,
+            bad);
+      desync += bad;
+   }
+   if (stuck)
+      printf("%d matches never settled\n", stuck);
+   printf("baud rate restored by end(): %d matches wrong\n", baud_bad);
+   return ((desync > 0 || stuck > 0 || baud_bad > 0) ? 1 : 0);
+}
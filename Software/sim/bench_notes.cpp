@@ -0,0 +1,154 @@
+/*****************************************************************//**
+ * @file bench_notes.cpp
+ *
+ * @brief host check and benchmark of the note fcw table
+ *
+ * Description:
+ *  - checks all 108 NOTE_FCW[] entries (C0..B8) against the
+ *    equal-temperament frequency from pow(): the fcw must be the
+ *    nearest word to the exact one, and the pitch error within the
+ *    bounds of note_table.h (0.51 cent from C3 up, 4.2 cents below)
+ *  - the NOTE_* constants of audio_manager.h must equal their table
+ *    entries (static_assert)
+ *  - prints host cycles per note of a table lookup, of a NOTE_* name
+ *    and of the run-time note_fcw() conversion (double precision);
+ *    built with -O0, a NOTE_* name must still cost a load, not the
+ *    conversion
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -Wno-int-to-pointer-cast -I. sim/bench_notes.cpp
+ *       -o bench_notes
+ *  - -O0 for the cost of the names in an unoptimized build; the
+ *    warning comes from the io macros of chu_io_rw.h
+ *  - exit status 1 on any mismatch or error out of bounds
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+#include "audio_manager.h"
+
+static const int NOTES = NOTE_OCTAVES * NOTE_PER_OCTAVE;
+static const int C3 = 3 * NOTE_PER_OCTAVE;
+static const int A4 = 4 * NOTE_PER_OCTAVE + 9;
+static const double MAX_CENTS = 0.51;          // from C3 up
+static const double MAX_CENTS_LOW = 4.2;       // octaves 0..2
+static const int REPS = 200000;
+
+/* the named notes, C3 to D6 in table order */
+#define NAMED_NOTES(X) \
+   X(NOTE_C3) X(NOTE_CS3) X(NOTE_D3) X(NOTE_DS3) X(NOTE_E3) X(NOTE_F3) \
+   X(NOTE_FS3) X(NOTE_G3) X(NOTE_GS3) X(NOTE_A3) X(NOTE_AS3) X(NOTE_B3) \
+   X(NOTE_C4) X(NOTE_CS4) X(NOTE_D4) X(NOTE_DS4) X(NOTE_E4) X(NOTE_F4) \
+   X(NOTE_FS4) X(NOTE_G4) X(NOTE_GS4) X(NOTE_A4) X(NOTE_AS4) X(NOTE_B4) \
+   X(NOTE_C5) X(NOTE_CS5) X(NOTE_D5) X(NOTE_DS5) X(NOTE_E5) X(NOTE_F5) \
+   X(NOTE_FS5) X(NOTE_G5) X(NOTE_GS5) X(NOTE_A5) X(NOTE_AS5) X(NOTE_B5) \
+   X(NOTE_C6) X(NOTE_CS6) X(NOTE_D6)
+
+#define NAMED_ELEM(n) n,
+#define NAMED_ADD(n) sink += n;
+
+constexpr uint32_t NAMED[] = { NAMED_NOTES(NAMED_ELEM) };
+
+constexpr int NAMED_LEN = sizeof(NAMED) / sizeof(NAMED[0]);
+
+constexpr bool named_ok(int i) {
+   return (i == NAMED_LEN) ? true :
+          (NAMED[i] == NOTE_FCW[C3 + i]) && named_ok(i + 1);
+}
+
+static_assert(named_ok(0), "NOTE_* constants match NOTE_FCW[]");
+
+// every named note, as the songs and effects use them
+__attribute__((noinline))
+static void named_notes(volatile uint32_t &sink) {
+   NAMED_NOTES(NAMED_ADD)
+}
+
+static uint64_t stamp() {
+#if defined(__x86_64__)
+   return (__rdtsc());
+#else
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return ((uint64_t) t.tv_sec * 1000000000u + t.tv_nsec);
+#endif
+}
+
+// fcw per Hz: 2^PHA_WIDTH / system clock
+static double fcw_per_hz() {
+   return ((double) (1UL << DdfsCore::PHA_WIDTH) / (SYS_CLK_FREQ * 1e6));
+}
+
+// returns the number of entries that fail
+static int check_table(double &max_cents, double &max_cents_low) {
+   double hz, exact, cents;
+   int i, bad = 0;
+
+   max_cents = max_cents_low = 0.0;
+   for (i = 0; i < NOTES; i++) {
+      hz = 440.0 * pow(2.0, (i - A4) / 12.0);
+      exact = hz * fcw_per_hz();
+      cents = fabs(1200.0 * log2(NOTE_FCW[i] / exact));
+      if (fabs(NOTE_FCW[i] - exact) > 0.5 + 1e-6) {
+         printf("%3d: fcw %u, exact %.3f\n", i, (unsigned) NOTE_FCW[i], exact);
+         bad++;
+      }
+      if (i >= C3) {
+         if (cents > max_cents)
+            max_cents = cents;
+         bad += (cents > MAX_CENTS);
+      } else {
+         if (cents > max_cents_low)
+            max_cents_low = cents;
+         bad += (cents > MAX_CENTS_LOW);
+      }
+   }
+   return (bad);
+}
+
+int main() {
+   volatile int idx;
+   volatile uint32_t sink = 0;
+   double max_cents, max_cents_low, t_table, t_named, t_conv;
+   uint64_t t0;
+   int r, i, bad;
+
+   bad = check_table(max_cents, max_cents_low);
+   printf("note table: %d entries, %d named, %d mismatches\n", NOTES,
+         NAMED_LEN, bad);
+   printf("pitch error: max %.3f cents from C3, %.3f cents below\n",
+         max_cents, max_cents_low);
+
+   t0 = stamp();
+   for (r = 0; r < REPS; r++) {
+      for (i = 0; i < NOTES; i++) {
+         idx = i;
+         sink += NOTE_FCW[idx];
+      }
+   }
+   t_table = (double) (stamp() - t0) / ((double) REPS * NOTES);
+   t0 = stamp();
+   for (r = 0; r < REPS; r++)
+      named_notes(sink);
+   t_named = (double) (stamp() - t0) / ((double) REPS * NAMED_LEN);
+   t0 = stamp();
+   for (r = 0; r < REPS / 10; r++) {
+      for (i = 0; i < NOTES; i++) {
+         idx = i;
+         sink += note_fcw(idx / NOTE_PER_OCTAVE, idx % NOTE_PER_OCTAVE);
+      }
+   }
+   t_conv = (double) (stamp() - t0) / ((double) (REPS / 10) * NOTES);
+   printf(BENCH_UNIT " per note: table lookup %.2f, NOTE_* name %.2f, "
+         "run-time note_fcw() %.2f\n", t_table, t_named, t_conv);
+   return (bad > 0 ? 1 : 0);
+}
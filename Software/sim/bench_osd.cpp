@@ -0,0 +1,154 @@
+/*****************************************************************//**
+ * @file bench_osd.cpp
+ *
+ * @brief host check of the osd writes of the scoreboard redraw
+ *
+ * Description:
+ *  - runs the firmware main() on the virtual bus, like bhs_sim, with a
+ *    script that starts a match every few seconds and keeps both
+ *    players moving
+ *  - at every vertical blanking reads the osd write counter of the bus
+ *  - within a stretch of play (from a kickoff or the end of a goal
+ *    pause, once the hud task has redrawn the board, to the next goal
+ *    or the match end) only the timer digits change: the hud task
+ *    (every 100 ms) may write at most TIMER_WRITES tiles in a frame,
+ *    and at most TIMER_WRITES per change of the displayed second plus
+ *    one per stretch in total; a redraw of an unchanged board writes
+ *    nothing
+ *  - prints osd writes per frame in play and outside play (kickoff,
+ *    goal message, menus)
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h -Dmain=game_main *.cpp
+ *       sim/sim_bus.cpp sim/bench_osd.cpp -o bench_osd
+ *  - exit status 1 if a redraw in play writes more than the timer
+ *
+ ********************************************************************/
+
+#undef main   // the firmware main() is game_main
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bus.h"
+#include "game_physics.h"
+
+int game_main();
+
+extern GameState game;
+extern bool game_over;
+
+static const int TIMER_WRITES = 4;       // MM:SS digits
+static const int HUD_PERIOD_MS = 100;    // HUD_TASK_US
+static const uint32_t SETTLE_TICKS = HUD_PERIOD_MS / PHYSICS_TICK_MS + 2;
+
+/* current stretch of play */
+static bool in_play = false;
+static uint32_t settle_until;            // tick to reach before a stretch
+static uint32_t last_tick, last_score, last_sec;
+static uint64_t last_wr;
+
+/* totals */
+static uint64_t play_frames, play_writes, busy_frames;
+static uint64_t other_frames, other_writes;
+static uint64_t sec_changes;
+static int stretches, worst_frame, over_frames;
+
+// displayed time, as the hud task shows it
+static uint32_t shown_sec(uint32_t match_ms) {
+   uint32_t s = match_ms / 1000;
+
+   return ((s < (uint32_t) MATCH_DURATION_SEC) ? MATCH_DURATION_SEC - s : 0);
+}
+
+// vertical blanking: osd writes since the previous frame
+static void sample(uint64_t frame) {
+   uint32_t tick = game.tick;
+   uint32_t score = game.score[0] + game.score[1];
+   uint32_t sec = shown_sec(game.match_ms);
+   uint64_t wr = sim_bus().count(SimBus::DEV_OSD).wr;
+   int n = (int) (wr - last_wr);
+
+   (void) frame;
+   if (tick < last_tick || score != last_score || game_over) {
+      in_play = false;                   // goal, match end or new match
+      settle_until = tick + SETTLE_TICKS;
+   } else if (in_play) {
+      play_frames++;
+      play_writes += n;
+      if (n > 0)
+         busy_frames++;
+      if (n > worst_frame)
+         worst_frame = n;
+      if (n > TIMER_WRITES)
+         over_frames++;
+      if (sec != last_sec)
+         sec_changes++;
+   } else if (tick > 0 && tick >= settle_until) {
+      in_play = true;
+      stretches++;
+   }
+   if (!in_play) {
+      other_frames++;
+      other_writes += n;
+   }
+   last_tick = tick;
+   last_score = score;
+   last_sec = sec;
+   last_wr = wr;
+}
+
+static void finish() {
+   // each shown second and each stretch start (hud lag) may cost one
+   // timer redraw; anything else is a redraw of an unchanged board
+   uint64_t budget = TIMER_WRITES * (sec_changes + stretches);
+   bool bad = over_frames > 0 || play_writes > budget || stretches == 0;
+
+   printf("play: %llu frames, %llu osd writes (%.3f per frame, budget %llu), "
+         "%llu frames with writes, worst %d\n",
+         (unsigned long long) play_frames, (unsigned long long) play_writes,
+         play_frames ? (double) play_writes / play_frames : 0.0,
+         (unsigned long long) budget, (unsigned long long) busy_frames,
+         worst_frame);
+   printf("other: %llu frames, %llu osd writes (%.1f per frame)\n",
+         (unsigned long long) other_frames, (unsigned long long) other_writes,
+         other_frames ? (double) other_writes / other_frames : 0.0);
+   printf("%d stretches, %llu frames over %d writes: %s\n", stretches,
+         (unsigned long long) over_frames, TIMER_WRITES, bad ? "FAIL" : "ok");
+   exit(bad ? 1 : 0);
+}
+
+// start a match every few seconds; both players run and jump
+static void script(SimBus &bus, int run_ms) {
+   int t;
+
+   for (t = 500; t < run_ms; t += 3000)
+      bus.press_key(t, 0x5a, 100);            // ENTER (menus)
+   for (t = 6000; t < run_ms; t += 1100) {
+      bus.press_key(t, 0x23, 400);            // D: p1 right
+      bus.press_key(t + 500, 0x1c, 300);      // A: p1 left
+      bus.press_key(t + 200, 0x29, 100);      // SPACE: p1 kick
+      bus.press_key(t + 100, 0xe06b, 500);    // LEFT: p2 left
+      bus.press_key(t + 700, 0xe074, 300);    // RIGHT: p2 right
+      bus.press_key(t + 50, 0x1d, 100);       // W: p1 jump
+   }
+}
+
+int main(int argc, char *argv[]) {
+   SimBus &bus = sim_bus();
+   int run_ms = 60000;
+
+   if (argc == 3 && !strcmp(argv[1], "--ms"))
+      run_ms = atoi(argv[2]);
+   else if (argc != 1) {
+      fprintf(stderr, "usage: %s [--ms N]\n", argv[0]);
+      return (1);
+   }
+   script(bus, run_ms);
+   bus.set_frame_hook(sample);
+   bus.set_limit_ms(run_ms, finish);
+   game_main();
+   finish();
+   return (0);
+}
@@ -0,0 +1,159 @@
+/*****************************************************************//**
+ * @file bench_prof.cpp
+ *
+ * @brief host check of the zone profiler on the sim's virtual timer
+ *
+ * Description:
+ *  - PROF_ZONE() reads the system timer of the simulated bus; the bus
+ *    cost is set to 0 and the zones let virtual time pass with
+ *    advance_us(), so every sample is known exactly
+ *  - random zone lengths (0..MAX_US us) in two zones: prof_stats()
+ *    count/min/max/total must match a model of the samples
+ *  - nested zones: the outer zone includes the inner one
+ *  - a zone across the wrap of the 32-bit lower counter
+ *  - prof_reset() clears every zone
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED -D_PROFILE
+ *       -include sim/sim_io_bus.h sim/bench_prof.cpp profiler.cpp
+ *       chu_init.cpp timer_core.cpp uart_core.cpp sim/sim_bus.cpp
+ *       -o bench_prof
+ *  - exit status 1 on any mismatch
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include "profiler.h"
+#include "sim_bus.h"
+
+#ifndef _PROFILE
+#error "bench_prof needs -D_PROFILE"
+#endif
+
+static const int ZONES = 20000;
+static const uint32_t MAX_US = 5000;
+static const uint32_t CLKS_PER_US = SYS_CLK_FREQ;
+
+/* expected statistics of a zone */
+struct Model {
+   uint32_t count, min, max;
+   uint64_t total;
+};
+
+static Model model[PROF_ZONE_COUNT];
+static int bad;
+
+static uint32_t rng = 0x2545f491;
+
+static uint32_t rnd(uint32_t n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((rng >> 1) % n);
+}
+
+static void expect(int zone, uint32_t clks) {
+   Model *m = &model[zone];
+
+   if (m->count == 0 || clks < m->min)
+      m->min = clks;
+   if (clks > m->max)
+      m->max = clks;
+   m->count++;
+   m->total += clks;
+}
+
+// advance_us() takes up to ~21 s at a time (int clocks)
+static void pass_us(uint64_t us) {
+   while (us > 1000000) {
+      sim_bus().advance_us(1000000);
+      us -= 1000000;
+   }
+   sim_bus().advance_us((uint32_t) us);
+}
+
+static void timed_zone(int zone, uint32_t us) {
+   {
+      PROF_ZONE(zone);
+      pass_us(us);
+   }
+   expect(zone, us * CLKS_PER_US);
+}
+
+static void nested_zone(uint32_t before_us, uint32_t inner_us,
+      uint32_t after_us) {
+   {
+      PROF_ZONE(PROF_FRAME);
+      pass_us(before_us);
+      {
+         PROF_ZONE(PROF_INPUT);
+         pass_us(inner_us);
+      }
+      pass_us(after_us);
+   }
+   expect(PROF_INPUT, inner_us * CLKS_PER_US);
+   expect(PROF_FRAME, (before_us + inner_us + after_us) * CLKS_PER_US);
+}
+
+// a zone that starts just below 2^32 on the lower counter
+static void wrap_zone() {
+   uint32_t left = (uint32_t) (0u - 50u - now_tick32());
+
+   pass_us(left / CLKS_PER_US);
+   if ((uint32_t) (0u - now_tick32()) > CLKS_PER_US + 50) {
+      printf("wrap: could not reach the end of the lower counter\n");
+      bad++;
+      return;
+   }
+   timed_zone(PROF_HUD, 3);
+   if (now_tick32() > 3 * CLKS_PER_US) {
+      printf("wrap: zone did not cross the wrap\n");
+      bad++;
+   }
+}
+
+static int compare(const char *what) {
+   int z, n = 0;
+
+   for (z = 0; z < PROF_ZONE_COUNT; z++) {
+      const ProfStats &s = prof_stats(z);
+      const Model &m = model[z];
+
+      if (s.count != m.count || s.total != m.total
+            || (m.count && (s.min != m.min || s.max != m.max))) {
+         printf("%s: zone %d: count %u min %u max %u total %llu, "
+               "expected %u %u %u %llu\n", what, z, (unsigned) s.count,
+               (unsigned) s.min, (unsigned) s.max,
+               (unsigned long long) s.total, (unsigned) m.count,
+               (unsigned) m.min, (unsigned) m.max,
+               (unsigned long long) m.total);
+         n++;
+      }
+   }
+   return (n);
+}
+
+int main() {
+   int i, z;
+
+   sim_bus().set_cost(0, 0);
+   prof_reset();
+   for (i = 0; i < ZONES; i++)
+      timed_zone((i & 1) ? PROF_PHYSICS : PROF_SPRITES, rnd(MAX_US + 1));
+   timed_zone(PROF_GOAL, 0);
+   for (i = 0; i < 100; i++)
+      nested_zone(rnd(100), rnd(MAX_US + 1), rnd(100));
+   wrap_zone();
+   bad += compare("zones");
+
+   prof_reset();
+   for (z = 0; z < PROF_ZONE_COUNT; z++)
+      model[z] = Model();
+   bad += compare("reset");
+   timed_zone(PROF_PHYSICS, 7);
+   bad += compare("after reset");
+
+   printf("profiler: %d zones of 0..%u us, 100 nested, 1 across the "
+         "counter wrap, %d mismatches\n", ZONES, (unsigned) MAX_US, bad);
+   return (bad > 0 ? 1 : 0);
+}
@@ -0,0 +1,223 @@
+/*****************************************************************//**
+ * @file bench_raster.cpp
+ *
+ * @brief host check and benchmark of the raster module
+ *
+ * Description:
+ *  - the frame buffer is host memory (sim/mem_io_bus.h)
+ *  - checks random clipped spans, rectangles, outlines, circles and
+ *    blits (with and without a chroma key) against a per-pixel
+ *    reference drawn into a separate array
+ *  - prints pixels per second for a full-frame clear in the original
+ *    column-major wr_pix() order and with clr_screen(), and for
+ *    rectangle fills, spans and blits
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/mem_io_bus.h sim/bench_raster.cpp raster.cpp
+ *       vga_core.cpp chu_init.cpp uart_core.cpp timer_core.cpp
+ *       -o bench_raster
+ *  - exit status 1 on any mismatch
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "raster.h"
+
+static const int W = Raster::W;
+static const int H = Raster::H;
+static const int OPS = 20000;
+static const int KEY = 0;
+static const int BMP_W = 48, BMP_H = 32;
+
+volatile uint32_t mem_io_space[MEM_IO_WORDS];
+
+static FrameCore frame(FRAME_BASE);
+static Raster raster(&frame);
+static uint32_t ref[H][W];
+static uint32_t bmp[BMP_W * BMP_H];
+static int cx0, cy0, cx1, cy1;          // reference clip window
+static uint32_t rng = 0x2545f491;
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+static volatile uint32_t *pixels() {
+   return (&mem_io_space[(FRAME_OFFSET) / 4]);
+}
+
+static void ref_pix(int x, int y, uint32_t c) {
+   if (x >= cx0 && x < cx1 && y >= cy0 && y < cy1)
+      ref[y][x] = c;
+}
+
+// draw one random primitive with both the raster module and the reference
+static void random_op() {
+   int x = rnd(W + 100) - 50, y = rnd(H + 100) - 50;
+   int w = rnd(200), h = rnd(120), r = rnd(80);
+   int c = 1 + rnd(511), key, i, j;
+
+   switch (rnd(6)) {
+   case 0:
+      raster.hspan(x, y, w, c);
+      for (i = 0; i < w; i++)
+         ref_pix(x + i, y, c);
+      break;
+   case 1:
+      raster.vspan(x, y, h, c);
+      for (j = 0; j < h; j++)
+         ref_pix(x, y + j, c);
+      break;
+   case 2:
+      if (rnd(4) == 0) {        // full-width fast path
+         x = 0;
+         w = W;
+      }
+      raster.fill_rect(x, y, w, h, c);
+      for (j = 0; j < h; j++)
+         for (i = 0; i < w; i++)
+            ref_pix(x + i, y + j, c);
+      break;
+   case 3:
+      raster.rect(x, y, w, h, c);
+      for (j = 0; j < h; j++)
+         for (i = 0; i < w; i++)
+            if (i == 0 || j == 0 || i == w - 1 || j == h - 1)
+               ref_pix(x + i, y + j, c);
+      break;
+   case 4:
+      raster.fill_circle(x, y, r, c);
+      for (j = -r; j <= r; j++)
+         for (i = -r; i <= r; i++)
+            if (i * i + j * j <= r * r)
+               ref_pix(x + i, y + j, c);
+      break;
+   default:
+      key = rnd(2) ? KEY : Raster::NO_KEY;
+      raster.blit(x, y, bmp, BMP_W, BMP_H, key);
+      for (j = 0; j < BMP_H; j++)
+         for (i = 0; i < BMP_W; i++)
+            if (key == Raster::NO_KEY || bmp[j * BMP_W + i] != (uint32_t) key)
+               ref_pix(x + i, y + j, bmp[j * BMP_W + i]);
+      break;
+   }
+}
+
+static int compare() {
+   volatile uint32_t *p = pixels();
+   int x, y, bad = 0;
+
+   for (y = 0; y < H; y++)
+      for (x = 0; x < W; x++)
+         bad += (p[y * W + x] != ref[y][x]);
+   return (bad);
+}
+
+// the original clr_screen(): column by column, one wr_pix() each
+static void clear_by_column(int color) {
+   int x, y;
+
+   for (x = 0; x < W; x++)
+      for (y = 0; y < H; y++)
+         frame.wr_pix(x, y, color);
+}
+
+static double mpix(double pix, double t) {
+   return (pix / t / 1e6);
+}
+
+int main() {
+   double t0, t, pix;
+   int i, k, bad = 0, x, y, reps = 50;
+
+   // a bitmap with a keyed border, a hole and an opaque core
+   for (i = 0; i < BMP_W * BMP_H; i++) {
+      x = i % BMP_W;
+      y = i / BMP_W;
+      bmp[i] = ((x + y) % 7 == 0 || (x > 20 && x < 26)) ? KEY : (uint32_t) (1 + (x * 9 + y) % 511);
+   }
+
+   // correctness: random primitives, random clip windows
+   for (k = 0; k < 8; k++) {
+      raster.reset_clip();
+      raster.clear(0);
+      memset(ref, 0, sizeof(ref));
+      cx0 = cy0 = 0;
+      cx1 = W;
+      cy1 = H;
+      if (k > 0) {
+         cx0 = rnd(W / 2);
+         cy0 = rnd(H / 2);
+         cx1 = W / 2 + rnd(W / 2 + 40);
+         cy1 = H / 2 + rnd(H / 2 + 40);
+         raster.set_clip(cx0, cy0, cx1, cy1);
+         cx1 = (cx1 > W) ? W : cx1;
+         cy1 = (cy1 > H) ? H : cy1;
+      }
+      for (i = 0; i < OPS / 8; i++)
+         random_op();
+      bad += compare();
+   }
+   raster.reset_clip();
+
+   printf("mismatched pixels: %d\n", bad);
+   printf("%-28s %10s\n", "operation", "Mpixel/s");
+
+   t0 = seconds();
+   for (i = 0; i < reps; i++)
+      clear_by_column(i);
+   t = seconds() - t0;
+   printf("%-28s %10.1f\n", "clear, column-major wr_pix", mpix((double) reps * W * H, t));
+
+   t0 = seconds();
+   for (i = 0; i < reps; i++)
+      frame.clr_screen(i);
+   t = seconds() - t0;
+   printf("%-28s %10.1f\n", "clear, clr_screen", mpix((double) reps * W * H, t));
+
+   t0 = seconds();
+   for (i = 0, pix = 0; i < reps * 100; i++) {
+      raster.fill_rect(i % 300, i % 200, 300, 200, i);
+      pix += 300 * 200;
+   }
+   t = seconds() - t0;
+   printf("%-28s %10.1f\n", "fill_rect 300x200", mpix(pix, t));
+
+   t0 = seconds();
+   for (i = 0, pix = 0; i < reps * 20000; i++) {
+      raster.hspan(i % 600, i % H, 40, i);
+      pix += 40;
+   }
+   t = seconds() - t0;
+   printf("%-28s %10.1f\n", "hspan 40", mpix(pix, t));
+
+   t0 = seconds();
+   for (i = 0, pix = 0; i < reps * 2000; i++) {
+      raster.blit(i % 590, i % 440, bmp, BMP_W, BMP_H);
+      pix += BMP_W * BMP_H;
+   }
+   t = seconds() - t0;
+   printf("%-28s %10.1f\n", "blit 48x32", mpix(pix, t));
+
+   t0 = seconds();
+   for (i = 0, pix = 0; i < reps * 2000; i++) {
+      raster.blit(i % 590, i % 440, bmp, BMP_W, BMP_H, KEY);
+      pix += BMP_W * BMP_H;
+   }
+   t = seconds() - t0;
+   printf("%-28s %10.1f\n", "blit 48x32, chroma key", mpix(pix, t));
+   return ((bad > 0) ? 1 : 0);
+}
@@ -0,0 +1,123 @@
+/*****************************************************************//**
+ * @file bench_sprite_art.cpp
+ *
+ * @brief host check and benchmark of the run-length-encoded sprite art
+ *
+ * Description:
+ *  - sprite rams are host memory (sim/mem_io_bus.h)
+ *  - uploads every asset of sprite_art.h with rle_upload() and checks
+ *    the ram against the .mem file it was generated from (mem_file.h),
+ *    and the goalpost against the border pattern the game used to
+ *    write procedurally
+ *  - prints per asset: pixels, bytes as .mem text, packed in bram and
+ *    as runs, host ns per upload, bus writes and their time on the
+ *    board at the virtual bus cost (10 clocks per access)
+ *
+ * Build and run (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/mem_io_bus.h sim/bench_sprite_art.cpp rle_sprite.cpp
+ *       vga_core.cpp chu_init.cpp uart_core.cpp timer_core.cpp
+ *       -o bench_sprite_art
+ *   ./bench_sprite_art
+ *  - reads the .mem files in ../Hardware/; exit status 1 on any mismatch
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "mem_file.h"
+#include "sprite_art.h"
+
+static const int REPS = 2000;
+static const int BUS_CLKS = 10;          // SimBus access cost
+static const int GP_W = 8, GP_H = 80;
+
+volatile uint32_t mem_io_space[MEM_IO_WORDS];
+
+struct Asset {
+   const char *name;
+   const RleSprite *art;
+   const char *path;
+   bool digits;
+   int slot;
+   int bits;                            // ram data width
+};
+
+static const Asset ASSETS[] = {
+   { "player1", &PLAYER1_ART, "../Hardware/player1_map.mem", false, V3_PLAYER1, 3 },
+   { "player2", &PLAYER2_ART, "../Hardware/player2_map.mem", false, V4_PLAYER2, 3 },
+   { "ball", &BALL_ART, "../Hardware/soccerball.mem", false, V2_BALL, 2 },
+   { "powerup", &POWERUP_ART, "../Hardware/powerup_map.mem", false, V8_POWERUP, 2 },
+   { "goalpost", &GOALPOST_ART, "../Hardware/goalpost_map.mem", true, V6_GOALPOST1, 2 }
+};
+
+static uint8_t pix[65536];
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+static volatile uint32_t *ram(int slot) {
+   return (&mem_io_space[(get_sprite_addr(BRIDGE_BASE, slot) - BRIDGE_BASE) / 4]);
+}
+
+// the pattern of the former load_goalposts()
+static int goalpost_diffs(volatile uint32_t *p) {
+   int row, col, edge, bad = 0;
+
+   for (row = 0; row < GP_H; row++) {
+      for (col = 0; col < GP_W; col++) {
+         edge = (row == 0 || row == GP_H - 1 || col == 0 || col == GP_W - 1);
+         if (p[row * GP_W + col] != (uint32_t) (edge ? 1 : 2))
+            bad++;
+      }
+   }
+   return (bad);
+}
+
+int main() {
+   long text, text_all = 0, packed_all = 0, rle_all = 0;
+   double t0, ns;
+   int a, i, r, n, bad, fail = 0;
+
+   printf("%-9s %6s %9s %7s %6s %9s %7s %8s\n", "asset", "pixels", "mem text",
+         "packed", "rle", "ns/upload", "writes", "board us");
+   for (a = 0; a < (int) (sizeof(ASSETS) / sizeof(ASSETS[0])); a++) {
+      const Asset &s = ASSETS[a];
+      SpriteCore core(get_sprite_addr(BRIDGE_BASE, s.slot), s.art->pixels);
+      volatile uint32_t *p = ram(s.slot);
+
+      n = s.art->pixels;
+      if (read_mem(s.path, s.digits, pix, n, &text) < 0) {
+         printf("%s: cannot read %s\n", s.name, s.path);
+         fail++;
+         continue;
+      }
+      for (i = 0; i < n; i++)
+         p[i] = 0xdead;
+      bad = (rle_upload(&core, *s.art) != n);
+      for (i = 0; i < n; i++) {
+         if (p[i] != pix[i])
+            bad++;
+      }
+      if (s.digits)
+         bad += goalpost_diffs(p);
+      t0 = seconds();
+      for (r = 0; r < REPS; r++)
+         rle_upload(&core, *s.art);
+      ns = (seconds() - t0) * 1e9 / REPS;
+      printf("%-9s %6d %9ld %7d %6d %9.0f %7d %8.1f%s\n", s.name, n, text,
+            (n * s.bits + 7) / 8, s.art->len, ns, n,
+            (double) n * BUS_CLKS / SYS_CLK_FREQ, bad ? "  MISMATCH" : "");
+      text_all += text;
+      packed_all += (n * s.bits + 7) / 8;
+      rle_all += s.art->len;
+      fail += bad;
+   }
+   printf("%-9s %6s %9ld %7ld %6ld\n", "total", "", text_all, packed_all, rle_all);
+   return ((fail > 0) ? 1 : 0);
+}
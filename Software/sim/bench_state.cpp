@@ -0,0 +1,112 @@
+/*****************************************************************//**
+ * @file bench_state.cpp
+ *
+ * @brief host benchmark of the GameState snapshot and game_step()
+ *
+ * Description:
+ *  - plays matches with random held inputs through game_step()
+ *  - per tick: copies the state into a ring of RING_LEN snapshots (as
+ *    a rollback engine would) and, every 8th tick, restores an older
+ *    one and re-simulates back up to the present
+ *  - prints the state size, ns per snapshot, per restore and per
+ *    game_step(), and checks that every re-simulation lands on the
+ *    same state (memcmp) as the first run
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h sim/bench_state.cpp game_physics.cpp
+ *       collision_world.cpp -o bench_state
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "game_physics.h"
+
+static const int TICKS = 200000;
+static const int RING_LEN = 16;
+static const int COPIES = 10000000;
+
+static GameState ring[RING_LEN];
+static uint8_t inputs[RING_LEN][2];
+static uint32_t rng = 0x2545f491;
+
+void play_kick_sound() {
+}
+
+void play_collision_sound() {
+}
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+// inputs held for a few ticks, like keys
+static uint8_t next_input(uint8_t held) {
+   return ((rnd(6) == 0) ? (uint8_t) rnd(16) : held);
+}
+
+int main() {
+   GameState s, back;
+   volatile uint32_t sink = 0;
+   uint8_t in1 = 0, in2 = 0;
+   double t0, t_copy, t_step;
+   int i, k, slot, depth, resims = 0, steps = 0, diverged = 0;
+
+   // snapshot cost alone: copy into the ring and back
+   game_init(s, 1);
+   t0 = seconds();
+   for (i = 0; i < COPIES; i++) {
+      ring[i % RING_LEN] = s;
+      s.tick = ring[(i * 7) % RING_LEN].tick + 1;   // keep the copies live
+   }
+   t_copy = (seconds() - t0) * 1e9 / COPIES;
+   sink += s.tick;
+
+   // matches with snapshots and re-simulation
+   game_init(s, 1);
+   t0 = seconds();
+   for (i = 0; i < TICKS; i++) {
+      slot = i % RING_LEN;
+      ring[slot] = s;                       // state before tick i
+      in1 = next_input(in1);
+      in2 = next_input(in2);
+      inputs[slot][0] = in1;
+      inputs[slot][1] = in2;
+      if (game_step(s, in1, in2) & EV_MATCH_OVER)
+         game_init(s, (uint32_t) i + 1);
+      steps++;
+      if ((i & 7) != 7 || i < RING_LEN)
+         continue;
+      // restore an older tick and run forward again with the same inputs
+      depth = 1 + rnd(RING_LEN - 1);
+      back = ring[(i - depth + 1) % RING_LEN];
+      for (k = i - depth + 1; k <= i; k++) {
+         if (game_step(back, inputs[k % RING_LEN][0], inputs[k % RING_LEN][1]) & EV_MATCH_OVER)
+            game_init(back, (uint32_t) k + 1);
+         steps++;
+      }
+      resims++;
+      if (memcmp(&back, &s, sizeof(s)) != 0)
+         diverged++;
+   }
+   t_step = (seconds() - t0) * 1e9 / steps;
+   sink += s.tick;
+
+   printf("GameState: %d bytes\n", (int) sizeof(GameState));
+   printf("snapshot or restore: %.1f ns\n", t_copy);
+   printf("game_step: %.0f ns (%d steps, %d re-simulations, %d diverged)\n",
+         t_step, steps, resims, diverged);
+   return ((diverged > 0 || sink == 0) ? 1 : 0);
+}
@@ -0,0 +1,285 @@
+/*****************************************************************//**
+ * @file bench_tick_div.cpp
+ *
+ * @brief host check and benchmark of the division-free tick conversion
+ *
+ * Description:
+ *  - checks TickToUs::div() and UsToMs::div() against '/' for all 2^32
+ *    inputs, and div64() against '/' for random 48-bit tick counts
+ *    (42-bit us counts for UsToMs) and the edges of each 32-bit word
+ *  - TimerCore and now_us()/now_ms() run on sim/rec_io_bus.h over a
+ *    virtual 48-bit timer that advances STEP clocks on every bus read;
+ *    the read starts next to each lower-word rollover, so the carry
+ *    falls between any two of the upper/lower/upper reads: the result
+ *    must lie between the counter before and after the call (the old
+ *    lower-then-upper read is counted alongside: torn reads)
+ *  - prints host cycles per now_us()/now_ms() call, new and old, and
+ *    per conversion alone; the old conversion is timed twice: with the
+ *    constant divisor (x86-64 turns it into a multiply) and with the
+ *    divisor hidden from the compiler (a real 64-bit divide, as
+ *    __udivdi3 on the MCS)
+ *
+ * Build (from Software/; separate program, not part of the game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/rec_io_bus.h sim/bench_tick_div.cpp chu_init.cpp
+ *       timer_core.cpp uart_core.cpp -o bench_tick_div
+ *  - exit status 1 on any mismatch
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+#include "chu_init.h"
+#include "tick_div.h"
+
+static const int RANDOM_COUNTS = 100000000;
+static const int REPS = 10000000;
+static const uint64_t TICK_MASK = 0xffffffffffffULL;   // 48-bit counter
+static const uint32_t TIMER_BASE = get_slot_addr(BRIDGE_BASE, TIMER_SLOT);
+static const uint32_t STEPS[] = { 1, 3, 10, 100 };     // clocks per read
+
+/* virtual timer */
+static uint64_t mock_tick;
+static uint32_t mock_step = 1;
+
+extern "C" {
+
+// noinline: the old read below pays the same call per access as the
+// drivers (separate units)
+__attribute__((noinline))
+uint32_t rec_io_read(uint32_t addr) {
+   uint32_t v = 0;
+
+   if (addr == TIMER_BASE + 4 * TimerCore::COUNTER_LOWER_REG)
+      v = (uint32_t) mock_tick;
+   else if (addr == TIMER_BASE + 4 * TimerCore::COUNTER_UPPER_REG)
+      v = (uint32_t) (mock_tick >> 32);
+   mock_tick = (mock_tick + mock_step) & TICK_MASK;
+   return (v);
+}
+
+void rec_io_write(uint32_t addr, uint32_t data) {
+   (void) addr;
+   (void) data;
+}
+
+}  // extern "C"
+
+static uint32_t rng = 0x2545f491;
+
+static uint32_t rnd() {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return (rng);
+}
+
+static uint64_t stamp() {
+#if defined(__x86_64__)
+   return (__rdtsc());
+#else
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return ((uint64_t) t.tv_sec * 1000000000u + t.tv_nsec);
+#endif
+}
+
+/**********************************************************************
+ * the conversion before tick_div.h
+ *********************************************************************/
+static volatile uint32_t hidden_clk_freq = SYS_CLK_FREQ;
+static volatile uint32_t hidden_thousand = 1000;
+
+// lower word, then upper word: torn across a carry
+static uint64_t old_read_tick() {
+   uint64_t upper, lower;
+
+   lower = (uint64_t) io_read(TIMER_BASE, TimerCore::COUNTER_LOWER_REG);
+   upper = (uint64_t) io_read(TIMER_BASE, TimerCore::COUNTER_UPPER_REG);
+   return ((upper << 32) | lower);
+}
+
+static unsigned long old_now_us() {
+   return ((unsigned long) (old_read_tick() / SYS_CLK_FREQ));
+}
+
+static unsigned long old_now_ms() {
+   return ((unsigned long) (old_read_tick() / SYS_CLK_FREQ) / 1000);
+}
+
+static unsigned long old_now_us_div() {
+   return ((unsigned long) (old_read_tick() / hidden_clk_freq));
+}
+
+static unsigned long old_now_ms_div() {
+   return ((unsigned long) (old_read_tick() / hidden_clk_freq) / hidden_thousand);
+}
+
+/**********************************************************************
+ * conversion checks
+ *********************************************************************/
+// every 32-bit input of div()
+template<typename R, uint32_t D>
+static uint64_t check_div32() {
+   uint64_t bad = 0;
+   uint32_t x = 0;
+
+   do {
+      bad += (R::div(x) != x / D);
+   } while (++x != 0);
+   return (bad);
+}
+
+template<typename R, uint32_t D>
+static uint64_t check_div64_at(uint64_t x) {
+   return (R::div64(x) != x / D);
+}
+
+// random counts below 2^bits, plus the edges of every upper word
+template<typename R, uint32_t D>
+static uint64_t check_div64(int bits) {
+   uint64_t bad = 0, x, hi;
+   int i;
+
+   for (i = 0; i < RANDOM_COUNTS; i++) {
+      x = (((uint64_t) rnd() << 32) | rnd()) & (((uint64_t) 1 << bits) - 1);
+      bad += check_div64_at<R, D>(x);
+   }
+   for (hi = 0; hi < ((uint64_t) 1 << (bits - 32)); hi++) {
+      x = hi << 32;
+      bad += check_div64_at<R, D>(x);
+      bad += check_div64_at<R, D>(x | 0xffffffffu);
+      bad += check_div64_at<R, D>(x | (D - 1));
+      bad += check_div64_at<R, D>(x | D);
+   }
+   return (bad);
+}
+
+/**********************************************************************
+ * reads across a carry
+ *********************************************************************/
+struct ReadResult {
+   uint64_t reads, bad, old_torn;
+};
+
+// 'got' must lie in [before, after) of the virtual counter
+static bool within(uint64_t got, uint64_t before, uint64_t after) {
+   return (got >= before && got < after);
+}
+
+static void check_reads(ReadResult &r) {
+   uint64_t before, after, got, hi;
+   int s, off;
+
+   for (s = 0; s < (int) (sizeof(STEPS) / sizeof(STEPS[0])); s++) {
+      mock_step = STEPS[s];
+      for (hi = 1; hi <= 0xffff; hi += 0x111) {
+         for (off = -4 * (int) mock_step; off < 4 * (int) mock_step; off++) {
+            // raw tick count
+            before = mock_tick = (hi << 32) + off;
+            got = now_tick();
+            after = mock_tick;
+            r.bad += !within(got, before, after);
+            before = mock_tick = (hi << 32) + off;
+            got = old_read_tick();
+            after = mock_tick;
+            r.old_torn += !within(got, before, after);
+            // us and ms; the division only ever rounds down
+            before = mock_tick = (hi << 32) + off;
+            got = now_us();
+            after = mock_tick;
+            r.bad += !within(got, before / SYS_CLK_FREQ,
+                  after / SYS_CLK_FREQ + 1);
+            before = mock_tick = (hi << 32) + off;
+            got = now_ms();
+            after = mock_tick;
+            r.bad += !within(got, before / SYS_CLK_FREQ / 1000,
+                  after / SYS_CLK_FREQ / 1000 + 1);
+            r.reads += 3;
+         }
+      }
+   }
+   mock_step = 1;
+}
+
+/**********************************************************************
+ * timing
+ *********************************************************************/
+static double per_call(unsigned long (*fn)()) {
+   volatile unsigned long sink = 0;
+   uint64_t t0;
+   int i;
+
+   mock_tick = 0x123456789aULL;
+   t0 = stamp();
+   for (i = 0; i < REPS; i++)
+      sink += fn();
+   return ((double) (stamp() - t0) / REPS);
+}
+
+// conversion only: 48-bit counts to us
+static uint64_t counts[4096];
+
+template<typename F>
+static double per_count(F conv) {
+   volatile uint64_t sink = 0;
+   uint64_t t0;
+   int r, i;
+
+   t0 = stamp();
+   for (r = 0; r < REPS / 4096; r++) {
+      for (i = 0; i < 4096; i++)
+         sink += conv(counts[i]);
+   }
+   return ((double) (stamp() - t0) / ((double) (REPS / 4096) * 4096));
+}
+
+static uint64_t conv_new(uint64_t x) {
+   return (TickToUs::div64(x));
+}
+
+static uint64_t conv_old(uint64_t x) {
+   return (x / SYS_CLK_FREQ);
+}
+
+static uint64_t conv_old_div(uint64_t x) {
+   return (x / hidden_clk_freq);
+}
+
+int main() {
+   uint64_t bad32, bad64;
+   int i;
+   ReadResult r = { 0, 0, 0 };
+
+   bad32 = check_div32<TickToUs, SYS_CLK_FREQ>();
+   bad32 += check_div32<UsToMs, 1000>();
+   printf("div: 2 x 2^32 inputs, %llu mismatches\n", (unsigned long long) bad32);
+   bad64 = check_div64<TickToUs, SYS_CLK_FREQ>(48);
+   bad64 += check_div64<UsToMs, 1000>(42);
+   printf("div64: 2 x %d random counts + word edges, %llu mismatches\n",
+         RANDOM_COUNTS, (unsigned long long) bad64);
+   check_reads(r);
+   printf("carry: %llu reads next to a lower-word rollover, %llu wrong "
+         "(old read: %llu torn)\n", (unsigned long long) r.reads,
+         (unsigned long long) r.bad, (unsigned long long) r.old_torn);
+
+   printf(BENCH_UNIT " per call: now_us() %.1f, now_ms() %.1f\n",
+         per_call(now_us), per_call(now_ms));
+   printf(BENCH_UNIT " per call, old: now_us() %.1f, now_ms() %.1f; "
+         "with a real divide %.1f, %.1f\n", per_call(old_now_us),
+         per_call(old_now_ms), per_call(old_now_us_div),
+         per_call(old_now_ms_div));
+   for (i = 0; i < 4096; i++)
+      counts[i] = (((uint64_t) rnd() << 32) | rnd()) & TICK_MASK;
+   printf(BENCH_UNIT " per 48-bit count to us, no bus read: TickToUs::div64 "
+         "%.1f, '/' constant %.1f, '/' real divide %.1f\n",
+         per_count(conv_new), per_count(conv_old), per_count(conv_old_div));
+   return (bad32 + bad64 + r.bad > 0 ? 1 : 0);
+}
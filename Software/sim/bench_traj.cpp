@@ -0,0 +1,319 @@
+/*****************************************************************//**
+ * @file bench_traj.cpp
+ *
+ * @brief golden-trajectory regression of Q16.16 against float physics
+ *
+ * Description:
+ *  - plays MATCHES matches through game_step() with random held
+ *    inputs (the same in every build) and records the state before
+ *    every tick
+ *  - built twice: the -DPHYSICS_FLOAT build writes the golden
+ *    trajectory (--save), the default Q16.16 build compares with it
+ *    (--check)
+ *  - anchored check: every SEG_TICKS ticks the Q16.16 state is set to
+ *    the golden one, then runs SEG_TICKS ticks on its own; the sprite
+ *    positions may differ by at most TOL_PX per axis at any tick
+ *    (fixed_point.h: "at most 1 px per axis at any frame")
+ *  - free run: each match also runs from kickoff with no re-anchoring;
+ *    a collision decided the other way makes the matches part (the
+ *    game is chaotic), so the ticks before the first difference over
+ *    TOL_PX and the final scores are reported, not checked
+ *  - prints host cycles (rdtsc; ns elsewhere) per game_step() of the
+ *    build
+ *
+ * Build and run (from Software/; separate programs, not part of the
+ * game):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED
+ *       -include sim/sim_io_bus.h -DPHYSICS_FLOAT sim/bench_traj.cpp
+ *       game_physics.cpp collision_world.cpp -o traj_float
+ *   g++ (same, without -DPHYSICS_FLOAT) -o traj_fixed
+ *   ./traj_float --save traj.bin && ./traj_fixed --check traj.bin
+ *  - exit status 1 if an anchored segment deviates over TOL_PX or the
+ *    file does not match the scenario
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+#include "game_physics.h"
+
+static const int MATCHES = 40;
+static const int MAX_TICKS = 2000;        // a match ends well before
+static const int SEG_TICKS = 30;          // anchored segment (0.9 s)
+static const int TOL_PX = 1;
+static const int TIMED_REPS = 20;
+static const uint32_t MAGIC = 0x6a725442;
+
+/* state before one tick, backend-neutral */
+struct Rec {
+   double vx[ENT_COUNT], vy[ENT_COUNT];
+   uint32_t tick, match_ms, last_hit_ms[2], rng;
+   int16_t x[ENT_COUNT], y[ENT_COUNT];
+   uint8_t on_ground[ENT_COUNT], score[2];
+   uint8_t in[2];                          // inputs of the tick
+   uint8_t ev;                             // events of the tick
+};
+
+static Rec golden[MATCHES][MAX_TICKS];
+static int n_ticks[MATCHES];
+static uint32_t rng = 0x2545f491;
+
+void play_kick_sound() {
+}
+
+void play_collision_sound() {
+}
+
+static int rnd(int n) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return ((int) ((rng >> 1) % (uint32_t) n));
+}
+
+// inputs held for a few ticks, like keys
+static uint8_t next_input(uint8_t held) {
+   return ((rnd(6) == 0) ? (uint8_t) rnd(16) : held);
+}
+
+#ifdef PHYSICS_FLOAT
+static double to_double(float v) {
+   return (v);
+}
+#else
+static double to_double(Q16_16 v) {
+   return (v.raw / 65536.0);
+}
+#endif
+
+static uint64_t stamp() {
+#if defined(__x86_64__) || defined(__i386__)
+   return (__rdtsc());
+#else
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return ((uint64_t) t.tv_sec * 1000000000u + t.tv_nsec);
+#endif
+}
+
+static void save_rec(Rec &r, const GameState &s) {
+   int e;
+
+   for (e = 0; e < ENT_COUNT; e++) {
+      r.vx[e] = to_double(s.vx[e]);
+      r.vy[e] = to_double(s.vy[e]);
+      r.x[e] = s.x[e];
+      r.y[e] = s.y[e];
+      r.on_ground[e] = s.on_ground[e];
+   }
+   r.tick = s.tick;
+   r.match_ms = s.match_ms;
+   r.last_hit_ms[0] = s.last_hit_ms[0];
+   r.last_hit_ms[1] = s.last_hit_ms[1];
+   r.rng = s.rng;
+   r.score[0] = s.score[0];
+   r.score[1] = s.score[1];
+}
+
+// golden state into this build's state (velocities rounded to the
+// scalar type)
+static void load_rec(GameState &s, const Rec &r) {
+   int e;
+
+   s = GameState();
+   for (e = 0; e < ENT_COUNT; e++) {
+      s.vx[e] = phys_t(r.vx[e]);
+      s.vy[e] = phys_t(r.vy[e]);
+      s.x[e] = r.x[e];
+      s.y[e] = r.y[e];
+      s.on_ground[e] = r.on_ground[e];
+   }
+   s.tick = r.tick;
+   s.match_ms = r.match_ms;
+   s.last_hit_ms[0] = r.last_hit_ms[0];
+   s.last_hit_ms[1] = r.last_hit_ms[1];
+   s.rng = r.rng;
+   s.score[0] = r.score[0];
+   s.score[1] = r.score[1];
+}
+
+static int deviation(const GameState &s, const Rec &r) {
+   int e, d, worst = 0;
+
+   for (e = 0; e < ENT_COUNT; e++) {
+      d = abs(s.x[e] - r.x[e]);
+      if (d > worst)
+         worst = d;
+      d = abs(s.y[e] - r.y[e]);
+      if (d > worst)
+         worst = d;
+   }
+   return (worst);
+}
+
+// the scenario: the same matches and inputs in every build
+static void play(Rec (*out)[MAX_TICKS], int *len) {
+   GameState s;
+   uint8_t in1, in2;
+   int m, k, ev;
+
+   rng = 0x2545f491;
+   for (m = 0; m < MATCHES; m++) {
+      game_init(s, (uint32_t) m + 1);
+      game_reset_positions(s, false);
+      in1 = in2 = 0;
+      for (k = 0; k < MAX_TICKS; k++) {
+         in1 = next_input(in1);
+         in2 = next_input(in2);
+         save_rec(out[m][k], s);
+         out[m][k].in[0] = in1;
+         out[m][k].in[1] = in2;
+         ev = game_step(s, in1, in2);
+         out[m][k].ev = (uint8_t) ev;
+         if (ev & EV_MATCH_OVER) {
+            k++;
+            break;
+         }
+      }
+      save_rec(out[m][k < MAX_TICKS ? k : MAX_TICKS - 1], s);
+      len[m] = k;
+   }
+}
+
+static double time_steps() {
+   GameState s;
+   uint64_t t0, t = 0, n = 0;
+   int r, m, k;
+
+   for (r = 0; r < TIMED_REPS; r++) {
+      for (m = 0; m < MATCHES; m++) {
+         load_rec(s, golden[m][0]);
+         for (k = 0; k < n_ticks[m]; k++) {
+            t0 = stamp();
+            game_step(s, golden[m][k].in[0], golden[m][k].in[1]);
+            t += stamp() - t0;
+            n++;
+         }
+      }
+   }
+   return ((double) t / n);
+}
+
+static int save(const char *path) {
+   FILE *fp = fopen(path, "wb");
+   uint32_t hdr[3] = { MAGIC, (uint32_t) MATCHES, (uint32_t) sizeof(Rec) };
+   int m, total = 0;
+
+   if (!fp) {
+      perror(path);
+      return (1);
+   }
+   play(golden, n_ticks);
+   fwrite(hdr, sizeof(hdr), 1, fp);
+   fwrite(n_ticks, sizeof(n_ticks), 1, fp);
+   for (m = 0; m < MATCHES; m++) {
+      fwrite(golden[m], sizeof(Rec), n_ticks[m] + 1, fp);
+      total += n_ticks[m];
+   }
+   fclose(fp);
+   printf("golden: %d matches, %d ticks\n", MATCHES, total);
+   printf("float game_step: %.0f %s\n", time_steps(), BENCH_UNIT);
+   return (0);
+}
+
+static int check(const char *path) {
+   static Rec mine[MATCHES][MAX_TICKS];
+   static int my_ticks[MATCHES];
+   FILE *fp = fopen(path, "rb");
+   uint32_t hdr[3];
+   GameState s;
+   int m, k, j, d, worst = 0, bad = 0, segs = 0, total = 0;
+   int parted = 0, part_sum = 0, scores = 0, histo[4] = { 0 };
+
+   if (!fp) {
+      perror(path);
+      return (1);
+   }
+   if (fread(hdr, sizeof(hdr), 1, fp) != 1 || hdr[0] != MAGIC
+         || hdr[1] != (uint32_t) MATCHES || hdr[2] != sizeof(Rec)
+         || fread(n_ticks, sizeof(n_ticks), 1, fp) != 1) {
+      printf("%s: not a trajectory of this scenario\n", path);
+      fclose(fp);
+      return (1);
+   }
+   for (m = 0; m < MATCHES; m++) {
+      if (n_ticks[m] < 1 || n_ticks[m] >= MAX_TICKS
+            || fread(golden[m], sizeof(Rec), n_ticks[m] + 1, fp)
+                  != (size_t) n_ticks[m] + 1) {
+         printf("%s: truncated\n", path);
+         fclose(fp);
+         return (1);
+      }
+   }
+   fclose(fp);
+
+   // anchored segments
+   for (m = 0; m < MATCHES; m++) {
+      for (k = 0; k < n_ticks[m]; k += SEG_TICKS) {
+         load_rec(s, golden[m][k]);
+         segs++;
+         for (j = k; j < k + SEG_TICKS && j < n_ticks[m]; j++) {
+            game_step(s, golden[m][j].in[0], golden[m][j].in[1]);
+            d = deviation(s, golden[m][j + 1]);
+            histo[d < 3 ? d : 3]++;
+            total++;
+            if (d > worst)
+               worst = d;
+            if (d > TOL_PX) {
+               bad++;
+               break;
+            }
+         }
+      }
+   }
+
+   // free run from kickoff
+   play(mine, my_ticks);
+   for (m = 0; m < MATCHES; m++) {
+      for (k = 0; k <= n_ticks[m] && k <= my_ticks[m]; k++) {
+         load_rec(s, mine[m][k]);
+         if (deviation(s, golden[m][k]) > TOL_PX)
+            break;
+      }
+      if (k <= n_ticks[m] || my_ticks[m] != n_ticks[m]) {
+         parted++;
+         part_sum += k;
+      }
+      if (mine[m][my_ticks[m]].score[0] == golden[m][n_ticks[m]].score[0]
+            && mine[m][my_ticks[m]].score[1] == golden[m][n_ticks[m]].score[1])
+         scores++;
+   }
+
+   printf("anchored: %d segments of %d ticks, %d ticks: %d / %d / %d / %d "
+         "at 0 / 1 / 2 / >2 px, worst %d px, %d over %d px\n", segs,
+         SEG_TICKS, total, histo[0], histo[1], histo[2], histo[3], worst,
+         bad, TOL_PX);
+   printf("free run: %d of %d matches part (after %.0f ticks on average), "
+         "%d final scores equal\n", parted, MATCHES,
+         parted ? (double) part_sum / parted : 0.0, scores);
+   printf("fixed game_step: %.0f %s\n", time_steps(), BENCH_UNIT);
+   return (bad > 0 ? 1 : 0);
+}
+
+int main(int argc, char *argv[]) {
+   if (argc == 3 && strcmp(argv[1], "--save") == 0)
+      return (save(argv[2]));
+   if (argc == 3 && strcmp(argv[1], "--check") == 0)
+      return (check(argv[2]));
+   fprintf(stderr, "usage: %s --save FILE | --check FILE\n", argv[0]);
+   return (1);
+}
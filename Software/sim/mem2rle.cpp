@@ -0,0 +1,147 @@
+/*****************************************************************//**
+ * @file mem2rle.cpp
+ *
+ * @brief host tool: sprite .mem files to run-length-encoded arrays
+ *
+ * Description:
+ *  - reads each .mem file as its sprite ram would be filled (see
+ *    mem_file.h) and writes a header of constexpr run arrays and
+ *    RleSprite descriptors (format in rle_sprite.h) to stdout
+ *  - per asset: NAME (identifier prefix), .mem file, ram depth in
+ *    pixels; -d ahead of an asset reads one pixel per hex digit
+ *  - prints the size of every asset to stderr: .mem text, pixels
+ *    packed at the bits of their highest code (as held in bram) and
+ *    run bytes
+ *
+ * Build and run (from Software/; host tool, not part of the game):
+ *   g++ -std=gnu++11 -O2 -Isim sim/mem2rle.cpp -o mem2rle
+ *   ./mem2rle PLAYER1 ../Hardware/player1_map.mem 2048
+ *       PLAYER2 ../Hardware/player2_map.mem 2048
+ *       BALL ../Hardware/soccerball.mem 256
+ *       POWERUP ../Hardware/powerup_map.mem 256
+ *       -d GOALPOST ../Hardware/goalpost_map.mem 640 > sprite_art.h
+ *  - exit status 1 on a bad argument, an unreadable file or a code
+ *    that does not fit the code field
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mem_file.h"
+
+/* run byte format of rle_sprite.h */
+static const int CODE_BITS = 3;
+static const int RUN_MAX = 256 >> CODE_BITS;
+static const int MAX_PIXELS = 65535;
+
+static uint8_t pix[MAX_PIXELS];
+static uint8_t rle[MAX_PIXELS];
+
+static int encode(const uint8_t *p, int n, uint8_t *out) {
+   int i = 0, len = 0, run;
+
+   while (i < n) {
+      for (run = 1; i + run < n && run < RUN_MAX && p[i + run] == p[i]; run++) {
+      }
+      out[len++] = (uint8_t) (((run - 1) << CODE_BITS) | p[i]);
+      i += run;
+   }
+   return (len);
+}
+
+// the tool's own check of its output; the firmware decoder is
+// checked by bench_sprite_art
+static bool decodes_to(const uint8_t *r, int len, const uint8_t *p, int n) {
+   int i, k, at = 0;
+
+   for (i = 0; i < len; i++) {
+      for (k = 0; k <= (r[i] >> CODE_BITS); k++, at++) {
+         if (at >= n || p[at] != (r[i] & ((1 << CODE_BITS) - 1)))
+            return (false);
+      }
+   }
+   return (at == n);
+}
+
+static int code_bits(const uint8_t *p, int n) {
+   int i, top = 0, bits = 1;
+
+   for (i = 0; i < n; i++) {
+      if (p[i] > top)
+         top = p[i];
+   }
+   while ((1 << bits) <= top)
+      bits++;
+   return (bits);
+}
+
+static void usage() {
+   fprintf(stderr, "usage: mem2rle [-d] NAME FILE.mem PIXELS ... > sprite_art.h\n");
+   exit(1);
+}
+
+int main(int argc, char *argv[]) {
+   const char *name, *path;
+   bool digits;
+   long text, text_all = 0, packed_all = 0, rle_all = 0;
+   int a, i, n, len, bits;
+
+   if (argc < 4)
+      usage();
+   printf("/*****************************************************************//**\n");
+   printf(" * @file sprite_art.h\n");
+   printf(" *\n");
+   printf(" * @brief sprite art as run-length-encoded arrays (see rle_sprite.h)\n");
+   printf(" *\n");
+   printf(" * Generated by sim/mem2rle from the .mem files in Hardware/; do not edit.\n");
+   printf(" *\n");
+   printf(" ********************************************************************/\n\n");
+   printf("#ifndef _SPRITE_ART_H_INCLUDED\n");
+   printf("#define _SPRITE_ART_H_INCLUDED\n\n");
+   printf("#include \"rle_sprite.h\"\n");
+   fprintf(stderr, "%-10s %7s %10s %10s %9s %7s\n", "asset", "pixels", "mem text",
+         "packed", "rle", "ratio");
+   for (a = 1; a < argc; a += 3) {
+      digits = false;
+      if (strcmp(argv[a], "-d") == 0) {
+         digits = true;
+         a++;
+      }
+      if (a + 2 >= argc)
+         usage();
+      name = argv[a];
+      path = argv[a + 1];
+      n = atoi(argv[a + 2]);
+      if (n <= 0 || n > MAX_PIXELS)
+         usage();
+      if (read_mem(path, digits, pix, n, &text) < 0) {
+         fprintf(stderr, "mem2rle: cannot read %s\n", path);
+         return (1);
+      }
+      bits = code_bits(pix, n);
+      if (bits > CODE_BITS) {
+         fprintf(stderr, "mem2rle: %s: code wider than %d bits\n", path, CODE_BITS);
+         return (1);
+      }
+      len = encode(pix, n, rle);
+      if (!decodes_to(rle, len, pix, n)) {
+         fprintf(stderr, "mem2rle: %s: encoding check failed\n", path);
+         return (1);
+      }
+      printf("\n/* %s: %d pixels, %d run bytes */\n", path, n, len);
+      printf("constexpr uint8_t %s_RLE[] = {", name);
+      for (i = 0; i < len; i++)
+         printf("%s0x%02x%s", (i % 12) ? " " : "\n   ", rle[i], (i + 1 < len) ? "," : "");
+      printf("\n};\n");
+      printf("constexpr RleSprite %s_ART = { %s_RLE, %d, %d };\n", name, name, len, n);
+      fprintf(stderr, "%-10s %7d %10ld %10d %9d %6.1fx\n", name, n, text,
+            (n * bits + 7) / 8, len, (double) text / len);
+      text_all += text;
+      packed_all += (n * bits + 7) / 8;
+      rle_all += len;
+   }
+   printf("\n#endif  // _SPRITE_ART_H_INCLUDED\n");
+   fprintf(stderr, "%-10s %7s %10ld %10ld %9ld %6.1fx\n", "total", "", text_all,
+         packed_all, rle_all, (double) text_all / rle_all);
+   return (0);
+}
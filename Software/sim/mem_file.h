@@ -0,0 +1,107 @@
+/*****************************************************************//**
+ * @file mem_file.h
+ *
+ * @brief host reader of the sprite .mem files in Hardware/
+ *
+ * Description:
+ *  - reads a file the way $readmemh fills a sprite ram: hex words
+ *    separated by white space, "//" comments, "@addr" jumps (hex);
+ *    words past the ram depth are dropped, cells never written read
+ *    as 0; radix 2 reads like $readmemb (font.mem)
+ *  - digit mode: every hex digit is one pixel; goalpost_map.mem is
+ *    written this way (one 8-pixel row per line), though $readmemh
+ *    reads each line as a single word
+ *  - shared by the mem2rle tool, bench_sprite_art and the video model
+ *
+ ********************************************************************/
+
+#ifndef _MEM_FILE_H_INCLUDED
+#define _MEM_FILE_H_INCLUDED
+
+#include <stdio.h>
+#include <ctype.h>
+#include <string.h>
+#include <inttypes.h>
+
+/* value of digit c in radix 2 or 16; -1: not a digit */
+static inline int mem_digit(int c, int radix) {
+   if (radix == 2)
+      return ((c == '0' || c == '1') ? c - '0' : -1);
+   if (!isxdigit(c))
+      return (-1);
+   return (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+}
+
+/**
+ * read a .mem file into a pixel array
+ * @param path file name
+ * @param digits one pixel per hex digit instead of one per word
+ * @param pix pixel codes (depth entries, cleared first)
+ * @param depth ram depth
+ * @param text_bytes size of the file (may be NULL)
+ * @param radix 16 ($readmemh) or 2 ($readmemb)
+ * @return highest address written + 1; -1 if the file cannot be read
+ *         or holds something other than hex words
+ */
+static inline int read_mem(const char *path, bool digits, uint8_t *pix,
+      int depth, long *text_bytes, int radix = 16) {
+   FILE *fp = fopen(path, "rb");
+   int c, v, addr = 0, top = 0, nd = 0;
+   uint32_t word = 0;
+   long n = 0;
+
+   if (fp == NULL)
+      return (-1);
+   memset(pix, 0, depth);
+   c = fgetc(fp);
+   while (c != EOF) {
+      n++;
+      if ((v = mem_digit(c, radix)) >= 0) {
+         if (digits) {
+            if (addr < depth)
+               pix[addr] = (uint8_t) v;
+            addr++;
+         } else {
+            word = word * radix + (uint32_t) v;
+            nd++;
+         }
+      } else if (c == '/' || c == '@' || isspace(c)) {
+         if (nd > 0) {
+            if (addr < depth)
+               pix[addr] = (uint8_t) word;
+            addr++;
+            word = 0;
+            nd = 0;
+         }
+         if (c == '/') {             // comment to the end of the line
+            while ((c = fgetc(fp)) != EOF && c != '\n')
+               n++;
+            continue;
+         }
+         if (c == '@') {
+            addr = 0;
+            while ((c = fgetc(fp)) != EOF && (v = mem_digit(c, 16)) >= 0) {
+               n++;
+               addr = addr * 16 + v;
+            }
+            continue;
+         }
+      } else {
+         fclose(fp);
+         return (-1);
+      }
+      if (addr > top)
+         top = addr;
+      c = fgetc(fp);
+   }
+   if (nd > 0 && addr++ < depth)
+      pix[addr - 1] = (uint8_t) word;
+   if (addr > top)
+      top = addr;
+   fclose(fp);
+   if (text_bytes)
+      *text_bytes = n;
+   return ((top < depth) ? top : depth);
+}
+
+#endif  // _MEM_FILE_H_INCLUDED
@@ -0,0 +1,37 @@
+/*****************************************************************//**
+ * @file mem_io_bus.h
+ *
+ * @brief vendor io access macros over plain host memory
+ *
+ * Description:
+ *  - force-included (-include) with -D_VENDOR_IO_ACCESS_USED, like
+ *    sim_io_bus.h, but with no device models and no virtual time:
+ *    every io word from BRIDGE_BASE on is a word of mem_io_space[]
+ *  - for host benchmarks of memory-like slots (the frame buffer),
+ *    where the bus model would cost more than the code under test
+ *  - accesses stay volatile, so each pixel write is still one store
+ *
+ ********************************************************************/
+
+#ifndef _MEM_IO_BUS_H_INCLUDED
+#define _MEM_IO_BUS_H_INCLUDED
+
+#include <inttypes.h>
+#include "chu_io_map.h"    // BRIDGE_BASE
+
+/* io space below the 16 MB window (frame buffer at 0x00c00000) */
+#define MEM_IO_WORDS (0x01000000 / 4)
+
+/**
+ * io words from BRIDGE_BASE (defined by the benchmark)
+ */
+extern volatile uint32_t mem_io_space[MEM_IO_WORDS];
+
+#define io_read(base_addr, offset) \
+   (mem_io_space[((uint32_t) (base_addr) - BRIDGE_BASE) / 4 + (offset)])
+
+#define io_write(base_addr, offset, data) \
+   (mem_io_space[((uint32_t) (base_addr) - BRIDGE_BASE) / 4 + (offset)] = \
+         (uint32_t) (data))
+
+#endif  // _MEM_IO_BUS_H_INCLUDED
@@ -0,0 +1,49 @@
+/*****************************************************************//**
+ * @file rec_io_bus.h
+ *
+ * @brief vendor io access macros over a recording mock
+ *
+ * Description:
+ *  - force-included (-include) with -D_VENDOR_IO_ACCESS_USED, like
+ *    sim_io_bus.h, but with no device models and no virtual time:
+ *    every access calls two functions of the host test, which
+ *    records the writes and answers the reads
+ *  - for unit tests of the code above a driver (audio sequencer over
+ *    DdfsCore/AdsrCore), where the test owns the clock (now_ms())
+ *
+ ********************************************************************/
+
+#ifndef _REC_IO_BUS_H_INCLUDED
+#define _REC_IO_BUS_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * read a word (defined by the test).
+ * @param addr byte address
+ * @return 32-bit data
+ */
+uint32_t rec_io_read(uint32_t addr);
+
+/**
+ * write a word (defined by the test).
+ * @param addr byte address
+ * @param data 32-bit data
+ */
+void rec_io_write(uint32_t addr, uint32_t data);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#define io_read(base_addr, offset) \
+   rec_io_read((uint32_t) ((base_addr) + 4*(offset)))
+
+#define io_write(base_addr, offset, data) \
+   rec_io_write((uint32_t) ((base_addr) + 4*(offset)), (uint32_t) (data))
+
+#endif  // _REC_IO_BUS_H_INCLUDED
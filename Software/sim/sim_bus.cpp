@@ -0,0 +1,441 @@
+/*****************************************************************//**
+ * @file sim_bus.cpp
+ *
+ * @brief implementation of the virtual MMIO bus
+ *
+ * Register layouts follow the firmware drivers:
+ *  - timer: lower/upper counter, ctrl (go, clear)
+ *  - uart/ps2: rd_data with rx-empty (bit 8) and tx status (bit 9)
+ *  - linked uarts: dvsr sets the byte time (10 bits of 16*(dvsr+1)
+ *    clocks); the tx fifo never fills, bytes queue on the wire
+ *  - ddfs/adsr: register files; adsr start writes are counted as notes
+ *  - video slot: word 0x2000+ registers, ram below; slot #0 (sync)
+ *    reads return the raster status
+ *  - video reset values: bar bypass 1 (chu_vga_bar_core), osd
+ *    foreground 0xfff (chu_vga_osd_core); all others 0
+ *
+ ********************************************************************/
+
+#include <string.h>
+#include "sim_bus.h"
+#include "sim_io_bus.h"
+#include "timer_core.h"
+#include "ps2_core.h"
+#include "adsr_core.h"
+
+// uart register map (private in UartCore)
+static const int UART_DVSR_REG = 1;
+static const int UART_WR_DATA_REG = 2;
+static const int UART_RM_RD_DATA_REG = 3;
+static const uint32_t UART_RX_EMPT_FIELD = 0x00000100;
+static const int UART_BYTE_BITS = 10;    // start, 8 data, stop
+
+SimBus &sim_bus() {
+   static SimBus bus;
+   return bus;
+}
+
+uint32_t sim_io_read(uint32_t addr) {
+   return sim_bus().read(addr);
+}
+
+void sim_io_write(uint32_t addr, uint32_t data) {
+   sim_bus().write(addr, data);
+}
+
+SimBus::SimBus() :
+      clk(0), access_clks(10), idle_clks(1000), wr_since_timer(true),
+      limit_clk(0), limit_hook(0),
+      vblank_clk((uint64_t) RASTER_VD * RASTER_LINE_CLKS), frame_hook(0),
+      timer_zero(0), timer_frozen(0),
+      timer_go(true), uart_echo(false), uart_file(0), link_on(false),
+      link_latency(0), link_loss(0), link_rng(1), link_tx(0),
+      link_lost(0), adsr_starts(0), fbuf(FRAME_W * FRAME_H, 0),
+      fbuf_bypass(0), moves_active(0), moves_frames(0),
+      last_move_frame(~0ULL) {
+   int i;
+
+   for (i = 0; i < 2; i++) {
+      link[i].slot = -1;
+      link[i].dvsr = 0;
+      link[i].line_free = 0;
+   }
+   memset(cnt, 0, sizeof(cnt));
+   memset(ddfs_reg, 0, sizeof(ddfs_reg));
+   memset(adsr_reg, 0, sizeof(adsr_reg));
+   memset(io_reg, 0, sizeof(io_reg));
+   memset(vid, 0, sizeof(vid));
+   vid[V7_BAR].reg[0] = 1;
+   vid[V1_OSD].reg[1] = 0xfff;
+}
+
+void SimBus::init_video_ram(int slot, const uint8_t *data, int n) {
+   int i;
+
+   for (i = 0; i < n && i < VIDEO_MEM_WORDS; i++)
+      vid[slot].mem[i] = data[i];
+}
+
+void SimBus::set_frame_hook(void (*hook)(uint64_t frame)) {
+   frame_hook = hook;
+}
+
+void SimBus::set_limit_ms(uint64_t ms, void (*hook)()) {
+   limit_clk = ms * SYS_CLK_FREQ * 1000;
+   limit_hook = hook;
+}
+
+void SimBus::set_cost(int access, int idle) {
+   access_clks = access;
+   idle_clks = idle;
+}
+
+void SimBus::press_key(uint64_t t_ms, int code, int hold_ms) {
+   uint64_t t0 = t_ms * SYS_CLK_FREQ * 1000;
+   uint64_t t1 = (t_ms + hold_ms) * SYS_CLK_FREQ * 1000;
+   bool ext = (code & 0xff00) == 0xe000;
+
+   if (ext)
+      ps2_sched.insert(std::make_pair(t0, (uint8_t) 0xe0));
+   ps2_sched.insert(std::make_pair(t0, (uint8_t) code));
+   if (ext)
+      ps2_sched.insert(std::make_pair(t1, (uint8_t) 0xe0));
+   ps2_sched.insert(std::make_pair(t1, (uint8_t) 0xf0));
+   ps2_sched.insert(std::make_pair(t1, (uint8_t) code));
+}
+
+void SimBus::link_uart(int slot, uint32_t latency_us, uint32_t loss_ppm,
+      uint32_t seed) {
+   link[0].slot = S1_UART1;
+   link[1].slot = slot;
+   link_latency = (uint64_t) latency_us * SYS_CLK_FREQ;
+   link_loss = loss_ppm;
+   link_rng = seed ? seed : 1;
+   link_on = true;
+}
+
+void SimBus::advance_us(uint32_t us) {
+   tick((int) (us * SYS_CLK_FREQ));
+}
+
+void SimBus::tick(int clks) {
+   clk += clks;
+   while (clk >= vblank_clk) {
+      if (frame_hook)
+         frame_hook(vblank_clk / ((uint64_t) RASTER_LINE_CLKS * RASTER_LINES));
+      vblank_clk += (uint64_t) RASTER_LINE_CLKS * RASTER_LINES;
+   }
+   if (limit_hook && limit_clk && clk >= limit_clk) {
+      void (*hook)() = limit_hook;
+      limit_hook = 0;   // report once
+      hook();
+   }
+}
+
+uint64_t SimBus::timer_count() const {
+   return timer_go ? clk - timer_zero : timer_frozen;
+}
+
+void SimBus::ps2_arrivals() {
+   while (!ps2_sched.empty() && ps2_sched.begin()->first <= clk) {
+      ps2_rx.push_back(ps2_sched.begin()->second);
+      ps2_sched.erase(ps2_sched.begin());
+   }
+}
+
+/**********************************************************************
+ * uart link
+ *********************************************************************/
+int SimBus::link_end(int slot) const {
+   if (!link_on)
+      return (-1);
+   if (slot == link[0].slot)
+      return (0);
+   if (slot == link[1].slot)
+      return (1);
+   return (-1);
+}
+
+// bytes of the other end's wire that have arrived by now
+void SimBus::link_arrivals(int end) {
+   LinkEnd &src = link[1 - end];
+
+   while (!src.wire.empty() && src.wire.front().first <= clk) {
+      link[end].rx.push_back(src.wire.front().second);
+      src.wire.pop_front();
+   }
+}
+
+uint32_t SimBus::link_read(int end, int reg) {
+   LinkEnd &e = link[end];
+
+   (void) reg;
+   link_arrivals(end);
+   if (e.rx.empty())
+      return (UART_RX_EMPT_FIELD);   // tx never full
+   return (e.rx.front());
+}
+
+void SimBus::link_write(int end, int reg, uint32_t data) {
+   LinkEnd &e = link[end];
+   uint64_t start;
+
+   if (reg == UART_DVSR_REG) {
+      e.dvsr = data;
+   } else if (reg == UART_RM_RD_DATA_REG) {
+      link_arrivals(end);
+      if (!e.rx.empty())
+         e.rx.pop_front();
+   } else if (reg == UART_WR_DATA_REG) {
+      // serialized behind the bytes already on the line
+      start = (clk > e.line_free) ? clk : e.line_free;
+      e.line_free = start + (uint64_t) UART_BYTE_BITS * 16 * (e.dvsr + 1);
+      link_tx++;
+      link_rng ^= link_rng << 13;
+      link_rng ^= link_rng >> 17;
+      link_rng ^= link_rng << 5;
+      if (link_rng % 1000000 < link_loss)
+         link_lost++;
+      else
+         e.wire.push_back(std::make_pair(e.line_free + link_latency,
+               (uint8_t) data));
+   }
+}
+
+/**********************************************************************
+ * io slots
+ *********************************************************************/
+uint32_t SimBus::io_slot_read(int slot, int reg) {
+   uint32_t data;
+   int end = link_end(slot);
+
+   if (end >= 0) {
+      cnt[DEV_UART].rd++;
+      return (link_read(end, reg));
+   }
+   switch (slot) {
+   case S0_SYS_TIMER:
+      cnt[DEV_TIMER].rd++;
+      if (reg == TimerCore::COUNTER_LOWER_REG) {
+         // polling loop: nothing but reads since the last timer read
+         if (!wr_since_timer)
+            tick(idle_clks);
+         wr_since_timer = false;
+         return ((uint32_t) timer_count());
+      }
+      if (reg == TimerCore::COUNTER_UPPER_REG)
+         return ((uint32_t) (timer_count() >> 32) & 0xffff);
+      return (0);
+   case S1_UART1:
+      cnt[DEV_UART].rd++;
+      return (UART_RX_EMPT_FIELD);   // rx empty, tx never full
+   case S11_PS2:
+      cnt[DEV_PS2].rd++;
+      ps2_arrivals();
+      data = Ps2Core::TX_IDLE_FIELD;
+      if (ps2_rx.empty())
+         data |= Ps2Core::RX_EMPT_FIELD;
+      else
+         data |= ps2_rx.front();
+      return (data);
+   case S12_DDFS:
+      cnt[DEV_DDFS].rd++;
+      return (ddfs_reg[reg]);
+   case S13_ADSR:
+      cnt[DEV_ADSR].rd++;
+      return (adsr_reg[reg]);
+   default:
+      cnt[DEV_IO].rd++;
+      return (io_reg[slot][reg]);
+   }
+}
+
+void SimBus::io_slot_write(int slot, int reg, uint32_t data) {
+   int end = link_end(slot);
+
+   if (end >= 0) {
+      link_write(end, reg, data);
+      if (slot != S1_UART1) {
+         cnt[DEV_UART].wr++;
+         return;
+      }
+   }
+   switch (slot) {
+   case S0_SYS_TIMER:
+      cnt[DEV_TIMER].wr++;
+      if (reg == TimerCore::CTRL_REG) {
+         bool go = data & TimerCore::GO_FIELD;
+         uint64_t count = timer_count();
+         if (data & TimerCore::CLR_FIELD)
+            count = 0;
+         timer_go = go;
+         timer_frozen = count;
+         timer_zero = clk - count;
+      }
+      break;
+   case S1_UART1:
+      cnt[DEV_UART].wr++;
+      if (reg == UART_WR_DATA_REG && uart_echo)
+         putchar((int) (data & 0xff));
+      if (reg == UART_WR_DATA_REG && uart_file)
+         fputc((int) (data & 0xff), uart_file);
+      break;
+   case S11_PS2:
+      cnt[DEV_PS2].wr++;
+      if (reg == Ps2Core::RM_RD_DATA_REG && !ps2_rx.empty())
+         ps2_rx.pop_front();
+      else if (reg == Ps2Core::PS2_WR_DATA_REG && (data & 0xff) == 0xff) {
+         // keyboard reset: acknowledge and pass self-test
+         ps2_rx.push_back(0xfa);
+         ps2_rx.push_back(0xaa);
+      }
+      break;
+   case S12_DDFS:
+      cnt[DEV_DDFS].wr++;
+      ddfs_reg[reg] = data;
+      break;
+   case S13_ADSR:
+      cnt[DEV_ADSR].wr++;
+      adsr_reg[reg] = data;
+      if (reg == AdsrCore::START_REG)
+         adsr_starts++;
+      break;
+   default:
+      cnt[DEV_IO].wr++;
+      io_reg[slot][reg] = data;
+      break;
+   }
+}
+
+/**********************************************************************
+ * raster
+ *********************************************************************/
+// frames counted at the start of vertical blanking, as in hardware
+uint64_t SimBus::raster_frame() const {
+   uint64_t frame_clks = (uint64_t) RASTER_LINE_CLKS * RASTER_LINES;
+
+   return ((clk + (RASTER_LINES - RASTER_VD) * RASTER_LINE_CLKS) / frame_clks);
+}
+
+uint32_t SimBus::raster_line() const {
+   return ((uint32_t) ((clk / RASTER_LINE_CLKS) % RASTER_LINES));
+}
+
+uint32_t SimBus::raster_status() const {
+   uint32_t line = raster_line();
+   uint32_t vblank = (line >= RASTER_VD) ? 1 : 0;
+
+   return (((uint32_t) raster_frame() & 0xffff) << 16 | vblank << 11 | line);
+}
+
+/**********************************************************************
+ * bus decode
+ *********************************************************************/
+int SimBus::video_dev(int slot) const {
+   return (slot == V1_OSD) ? DEV_OSD : DEV_SPRITE;
+}
+
+uint32_t SimBus::read(uint32_t addr) {
+   uint32_t off = addr - BRIDGE_BASE;
+   uint32_t word;
+   int slot;
+
+   tick(access_clks);
+   if (addr < BRIDGE_BASE || off >= 0x01000000) {
+      cnt[DEV_UNMAPPED].rd++;
+      return (0);
+   }
+   if (off < 0x00800000) {
+      word = off >> 2;
+      if (word / IO_REGS >= IO_SLOTS) {
+         cnt[DEV_UNMAPPED].rd++;
+         return (0);
+      }
+      return (io_slot_read(word / IO_REGS, word % IO_REGS));
+   }
+   // video side is write-only in hardware, except the sync status
+   if (off < FRAME_OFFSET) {
+      slot = (off - 0x00800000) >> 16;
+      if (slot >= VIDEO_SLOTS) {
+         cnt[DEV_UNMAPPED].rd++;
+         return (0);
+      }
+      cnt[video_dev(slot)].rd++;
+      return (slot == V0_SYNC ? raster_status() : 0);
+   }
+   cnt[DEV_FRAME].rd++;
+   return (0);
+}
+
+void SimBus::write(uint32_t addr, uint32_t data) {
+   uint32_t off = addr - BRIDGE_BASE;
+   uint32_t word;
+   int slot;
+
+   tick(access_clks);
+   wr_since_timer = true;
+   if (addr < BRIDGE_BASE || off >= 0x01000000) {
+      cnt[DEV_UNMAPPED].wr++;
+      return;
+   }
+   if (off < 0x00800000) {
+      word = off >> 2;
+      if (word / IO_REGS >= IO_SLOTS) {
+         cnt[DEV_UNMAPPED].wr++;
+         return;
+      }
+      io_slot_write(word / IO_REGS, word % IO_REGS, data);
+      return;
+   }
+   if (off < FRAME_OFFSET) {
+      slot = (off - 0x00800000) >> 16;
+      word = (off >> 2) & 0x3fff;
+      if (slot >= VIDEO_SLOTS) {
+         cnt[DEV_UNMAPPED].wr++;
+         return;
+      }
+      cnt[video_dev(slot)].wr++;
+      if (word < VIDEO_MEM_WORDS) {
+         vid[slot].mem[word] = data;
+      } else if (word - VIDEO_REG_BASE < VIDEO_REGS) {
+         vid[slot].reg[word - VIDEO_REG_BASE] = data;
+         if ((word == VIDEO_REG_BASE + 1 || word == VIDEO_REG_BASE + 2)
+               && video_dev(slot) == DEV_SPRITE) {
+            vid[slot].pos_wr++;
+            if (raster_line() < RASTER_VD)
+               moves_active++;
+            if (raster_frame() != last_move_frame) {
+               last_move_frame = raster_frame();
+               moves_frames++;
+            }
+         }
+      }
+      return;
+   }
+   cnt[DEV_FRAME].wr++;
+   word = (off - FRAME_OFFSET) >> 2;
+   if (word == FRAME_BYPASS_WORD)
+      fbuf_bypass = data;
+   else if (word < fbuf.size())
+      fbuf[word] = data;
+}
+
+void SimBus::report(FILE *fp) const {
+   static const char *NAMES[DEV_COUNT] = { "timer", "uart", "ps2", "ddfs",
+         "adsr", "io", "osd", "sprite", "frame", "unmapped" };
+   uint64_t rd = 0, wr = 0;
+   int i;
+
+   fprintf(fp, "%-10s %14s %14s\n", "device", "reads", "writes");
+   for (i = 0; i < DEV_COUNT; i++) {
+      fprintf(fp, "%-10s %14llu %14llu\n", NAMES[i],
+            (unsigned long long) cnt[i].rd, (unsigned long long) cnt[i].wr);
+      rd += cnt[i].rd;
+      wr += cnt[i].wr;
+   }
+   fprintf(fp, "%-10s %14llu %14llu\n", "total", (unsigned long long) rd,
+         (unsigned long long) wr);
+   fprintf(fp, "notes started: %llu\n", (unsigned long long) adsr_starts);
+   fprintf(fp, "sprite moves in the visible area: %llu\n",
+         (unsigned long long) moves_active);
+}
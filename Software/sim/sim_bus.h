@@ -0,0 +1,247 @@
+/*****************************************************************//**
+ * @file sim_bus.h
+ *
+ * @brief virtual MMIO bus and device models for the host simulation
+ *
+ * Description:
+ *  - decodes byte addresses the way the FPro bridge does:
+ *    - BRIDGE_BASE + slot*32 words: io slots (chu_io_map.h)
+ *    - BRIDGE_BASE + 0x00800000 + slot*2^14 words: video slots
+ *    - BRIDGE_BASE + FRAME_OFFSET: frame buffer
+ *  - device models: timer, uart, ps2 keyboard, ddfs, adsr, generic
+ *    register slots (led, switch, ...), video slots, frame buffer
+ *  - virtual time in system clocks; every access costs access_clks,
+ *    a timer read with no write since the previous timer read
+ *    (a polling/sleep loop) skips ahead by idle_clks
+ *  - per-device read/write counters
+ *  - raster model of the vga sync core: 640x480 at 25 MHz (4 system
+ *    clocks per pixel, 800 x 525 pixels per frame) from virtual time
+ *    zero; video slot #0 reads return the sync core status word
+ *  - sprite x/y writes made while the raster is in the visible area
+ *    are counted (a tear-free frame loop keeps this at 0)
+ *  - video registers start at their hardware reset values (bar core
+ *    bypassed, osd foreground white); sprite rams can be given their
+ *    bitstream contents; an optional hook runs at the start of every
+ *    vertical blanking (see sim_video.h)
+ *  - optional uart link: the uart in slot #1 is cross-wired to a
+ *    second uart model in another io slot (two boards in one process);
+ *    bytes are serialized at the programmed baud rate, delivered after
+ *    a fixed latency and dropped at a pseudo-random rate
+ *
+ ********************************************************************/
+
+#ifndef _SIM_BUS_H_INCLUDED
+#define _SIM_BUS_H_INCLUDED
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <map>
+#include <deque>
+#include <vector>
+#include "chu_io_map.h"
+
+/**
+ * virtual bus:
+ *  - one instance, obtained by sim_bus()
+ *  - usable during static construction of the firmware globals
+ */
+class SimBus {
+public:
+   /**
+    * device classes (counter index)
+    */
+   enum {
+      DEV_TIMER = 0,
+      DEV_UART,
+      DEV_PS2,
+      DEV_DDFS,
+      DEV_ADSR,
+      DEV_IO,        /**< other io slots */
+      DEV_OSD,
+      DEV_SPRITE,    /**< sprite and gpv slots */
+      DEV_FRAME,
+      DEV_UNMAPPED,
+      DEV_COUNT
+   };
+
+   /**
+    * symbolic constants
+    */
+   enum {
+      IO_SLOTS = 64,
+      IO_REGS = 32,                /**< words per io slot */
+      VIDEO_SLOTS = 16,
+      VIDEO_MEM_WORDS = 0x2000,    /**< pixel/tile ram below the registers */
+      VIDEO_REG_BASE = 0x2000,     /**< bypass, x/fg, y/bg, ctrl */
+      VIDEO_REGS = 4,
+      FRAME_W = 640,
+      FRAME_H = 480,
+      FRAME_BYPASS_WORD = 0xfffff,
+      RASTER_LINE_CLKS = 3200,     /**< 800 pixels at 4 clocks */
+      RASTER_LINES = 525,
+      RASTER_VD = 480              /**< visible lines */
+   };
+
+   /* read/write count of a device class */
+   struct Counter {
+      uint64_t rd;
+      uint64_t wr;
+   };
+
+   /* video slot model: sprite/gpv/osd share the layout */
+   struct VideoSlot {
+      uint32_t mem[VIDEO_MEM_WORDS];
+      uint32_t reg[VIDEO_REGS];
+      uint64_t pos_wr;             // x/y register writes (sprite moves)
+   };
+
+   SimBus();
+
+   /* bus access */
+   uint32_t read(uint32_t addr);
+   void write(uint32_t addr, uint32_t data);
+
+   /* time */
+   uint64_t now_clk() const { return clk; }
+   uint64_t now_ms() const { return clk / (SYS_CLK_FREQ * 1000); }
+   void set_limit_ms(uint64_t ms, void (*hook)());
+   void set_cost(int access, int idle);
+
+   /**
+    * schedule a key press on the ps2 keyboard
+    * @param t_ms press time (ms of virtual time)
+    * @param code set-2 make code; 0xe0xx for extended keys
+    * @param hold_ms time before the break code is sent
+    */
+   void press_key(uint64_t t_ms, int code, int hold_ms);
+
+   /* uart tx bytes are copied to stdout when enabled */
+   void echo_uart(bool on) { uart_echo = on; }
+   /* uart tx bytes are also written to fp (0: off) */
+   void capture_uart(FILE *fp) { uart_file = fp; }
+   /* board switch positions (S3_SW) */
+   void set_switches(uint32_t sw) { io_reg[S3_SW][0] = sw; }
+
+   /**
+    * cross-wire the uart in slot S1_UART1 with a second uart model
+    * @param slot io slot of the second uart (e.g. S4_USER)
+    * @param latency_us one-way delay after the byte is on the wire
+    * @param loss_ppm bytes dropped per million (each direction)
+    * @param seed seed of the loss pattern
+    *
+    * @note echo/capture still see the slot #1 tx bytes
+    */
+   void link_uart(int slot, uint32_t latency_us, uint32_t loss_ppm,
+         uint32_t seed);
+   /* bytes sent / dropped over the link (both directions) */
+   uint64_t link_sent() const { return link_tx; }
+   uint64_t link_dropped() const { return link_lost; }
+
+   /**
+    * let virtual time pass without bus accesses (host harnesses that
+    * drive several firmware instances on one bus)
+    */
+   void advance_us(uint32_t us);
+
+   /**
+    * contents of a video slot ram at configuration (the .mem file of
+    * the bitstream); no bus access, no virtual time
+    * @param slot video slot
+    * @param data words from address 0
+    * @param n number of words
+    */
+   void init_video_ram(int slot, const uint8_t *data, int n);
+
+   /**
+    * call hook(frame) at the start of every vertical blanking, when
+    * the visible part of raster frame 'frame' has been scanned out
+    * (0: off)
+    */
+   void set_frame_hook(void (*hook)(uint64_t frame));
+
+   /* device state */
+   const Counter &count(int dev) const { return cnt[dev]; }
+   const VideoSlot &video(int slot) const { return vid[slot]; }
+   const std::vector<uint32_t> &frame() const { return fbuf; }
+   uint32_t frame_bypass() const { return fbuf_bypass; }
+   uint64_t notes_started() const { return adsr_starts; }
+   uint32_t carrier_fcw() const { return ddfs_reg[0]; }
+
+   /* raster */
+   uint32_t raster_line() const;
+   uint32_t raster_status() const;
+   uint64_t raster_frame() const;
+   /* sprite x/y writes during the visible area / frames with a move */
+   uint64_t active_moves() const { return moves_active; }
+   uint64_t move_frames() const { return moves_frames; }
+
+   /* print the counters */
+   void report(FILE *fp) const;
+
+private:
+   uint64_t clk;
+   int access_clks;
+   int idle_clks;
+   bool wr_since_timer;
+   uint64_t limit_clk;
+   void (*limit_hook)();
+   uint64_t vblank_clk;            // next start of vertical blanking
+   void (*frame_hook)(uint64_t frame);
+   Counter cnt[DEV_COUNT];
+   /* timer */
+   uint64_t timer_zero;
+   uint64_t timer_frozen;
+   bool timer_go;
+   /* uart */
+   bool uart_echo;
+   FILE *uart_file;
+   /* uart link: end 0 is slot #1, end 1 the linked slot */
+   struct LinkEnd {
+      int slot;
+      uint32_t dvsr;
+      uint64_t line_free;          // clock the tx line is idle again
+      std::deque<std::pair<uint64_t, uint8_t> > wire;  // to the other end
+      std::deque<uint8_t> rx;
+   };
+   bool link_on;
+   LinkEnd link[2];
+   uint64_t link_latency;          // clocks
+   uint32_t link_loss;             // ppm
+   uint32_t link_rng;
+   uint64_t link_tx;
+   uint64_t link_lost;
+   /* ps2: pending bytes keyed by arrival clock, then rx fifo */
+   std::multimap<uint64_t, uint8_t> ps2_sched;
+   std::deque<uint8_t> ps2_rx;
+   /* audio */
+   uint32_t ddfs_reg[IO_REGS];
+   uint32_t adsr_reg[IO_REGS];
+   uint64_t adsr_starts;
+   /* other slots */
+   uint32_t io_reg[IO_SLOTS][IO_REGS];
+   /* video */
+   VideoSlot vid[VIDEO_SLOTS];
+   std::vector<uint32_t> fbuf;
+   uint32_t fbuf_bypass;
+   uint64_t moves_active;
+   uint64_t moves_frames;
+   uint64_t last_move_frame;
+
+   void tick(int clks);
+   uint64_t timer_count() const;
+   void ps2_arrivals();
+   int link_end(int slot) const;
+   void link_arrivals(int end);
+   uint32_t link_read(int end, int reg);
+   void link_write(int end, int reg, uint32_t data);
+   uint32_t io_slot_read(int slot, int reg);
+   void io_slot_write(int slot, int reg, uint32_t data);
+   int video_dev(int slot) const;
+};
+
+/**
+ * the bus instance (constructed on first use)
+ */
+SimBus &sim_bus();
+
+#endif  // _SIM_BUS_H_INCLUDED
@@ -0,0 +1,59 @@
+/*****************************************************************//**
+ * @file sim_io_bus.h
+ *
+ * @brief vendor io access macros for the host simulation build
+ *
+ * Description:
+ *  - force-included ahead of every firmware source (-include) together
+ *    with -D_VENDOR_IO_ACCESS_USED; chu_io_rw.h then skips its own
+ *    pointer-based io_read()/io_write()
+ *  - every register access becomes a call into the virtual bus
+ *    (sim_bus.cpp), which decodes BRIDGE_BASE slots, the 0x00800000
+ *    video window and the frame buffer onto device models
+ *
+ * Host build (from Software/):
+ *   g++ -std=gnu++11 -O2 -I. -Isim -D_VENDOR_IO_ACCESS_USED \
+ *       -include sim/sim_io_bus.h -Dmain=game_main \
+ *       *.cpp sim/sim_*.cpp -o bhs_sim
+ *   ./bhs_sim --ms 60000                   # 60 s of game time
+ *   ./bhs_sim --press 500:5a --press 4000:e074:800 --uart
+ *  - -Dmain=game_main renames the firmware main(); sim_main.cpp
+ *    undoes the rename for the host entry point
+ *  - syscalls.c and lscript.ld are board-only and not compiled
+ *
+ ********************************************************************/
+
+#ifndef _SIM_IO_BUS_H_INCLUDED
+#define _SIM_IO_BUS_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * read a word from the virtual bus.
+ * @param addr byte address
+ * @return 32-bit data
+ */
+uint32_t sim_io_read(uint32_t addr);
+
+/**
+ * write a word to the virtual bus.
+ * @param addr byte address
+ * @param data 32-bit data
+ */
+void sim_io_write(uint32_t addr, uint32_t data);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#define io_read(base_addr, offset) \
+   sim_io_read((uint32_t) ((base_addr) + 4*(offset)))
+
+#define io_write(base_addr, offset, data) \
+   sim_io_write((uint32_t) ((base_addr) + 4*(offset)), (uint32_t) (data))
+
+#endif  // _SIM_IO_BUS_H_INCLUDED
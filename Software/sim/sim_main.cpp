@@ -0,0 +1,322 @@
+/*****************************************************************//**
+ * @file sim_main.cpp
+ *
+ * @brief host entry point of the simulation build
+ *
+ * Description:
+ *  - runs the firmware main() (renamed game_main by -Dmain=game_main)
+ *    on the virtual bus until the virtual time limit is reached
+ *  - keyboard input is a script of timed key presses; without --press
+ *    a demo script starts the game and moves/kicks with both players
+ *  - prints per-device access counters, virtual vs wall time and the
+ *    number of rendered frames (raster frames with a sprite move) per
+ *    wall second
+ *  - exit status 1 if the firmware paces by the sync status and still
+ *    moves a sprite while the visible area is scanned out (not checked
+ *    in --replay playback, which commits without waiting)
+ *  - optional video model (sim_video.h): composes raster frames from
+ *    the bus state at every vertical blanking, writes them as images
+ *    and checks them against golden hashes
+ *
+ * Options:
+ *  - --ms N              virtual run time in ms (default 30000)
+ *  - --press T:CODE[:H]  press set-2 key CODE (hex, e0xx extended) at
+ *                        T ms for H ms (default 100)
+ *  - --clks N            system clocks per bus access (default 10)
+ *  - --idle-us N         time skipped per idle timer poll (default 10);
+ *                        use 0 with -D_PROFILE builds, since a profiler
+ *                        zone with no bus write in it looks like a poll
+ *  - --uart              copy uart output to stdout
+ *  - --sw HEX            board switch positions (sw 3: frame buffer
+ *                        pitch); --record adds sw 0
+ *  - --record FILE       turn on sw 0 (match recording) and save the
+ *                        log dumped over uart at the end of the match
+ *  - --replay FILE       play a recorded match back without real-time
+ *                        pacing; stops at the end of the match and
+ *                        reports ticks per wall second and whether the
+ *                        state trace and scores match the recording
+ *  - --video             compose every raster frame and report frames
+ *                        composed per wall second of compositor time
+ *  - --every N           compose every Nth raster frame only (default 1)
+ *  - --png DIR, --ppm DIR  write the composed frames (DIR/fNNNNNN.png)
+ *  - --golden FILE       compare the hash of every composed frame with
+ *                        FILE ("frame hash" lines); exit status 1 on a
+ *                        mismatch or a listed frame never composed
+ *  - --golden-save FILE  write the hashes of the composed frames
+ *  - --hw DIR            .mem files of the bitstream: font and sprite
+ *                        rams at configuration (default ../Hardware)
+ *
+ * Golden-image regression (from Software/, after the host build):
+ *   ./bhs_sim --ms 20000 --sw 8 --every 20 --golden sim/golden_demo.txt
+ *  - on a mismatch, add --png DIR to look at the frames; after an
+ *    intended change to the picture, --golden-save rewrites the file
+ *
+ ********************************************************************/
+
+#undef main   // the firmware main() is game_main
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <map>
+#include <string>
+#include "sim_bus.h"
+#include "sim_video.h"
+#include "replay.h"
+
+int game_main();
+
+static struct timespec wall_start;
+static FILE *record_file = 0;
+
+/* video model */
+static SimVideo *video = 0;
+static int video_every = 1;
+static const char *png_dir = 0, *ppm_dir = 0;
+static std::map<uint64_t, uint32_t> golden;
+static FILE *golden_file = 0;
+static uint64_t video_frames = 0;
+static double video_wall = 0;
+static int golden_checked = 0, golden_bad = 0;
+
+static double wall_seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec - wall_start.tv_sec) + (t.tv_nsec - wall_start.tv_nsec) * 1e-9;
+}
+
+static void finish() {
+   const SimBus &bus = sim_bus();
+   double wall = wall_seconds();
+   bool failed = false;
+   double virt = bus.now_clk() / (SYS_CLK_FREQ * 1e6);
+   uint64_t frames = bus.move_frames();
+
+   fflush(stdout);
+   bus.report(stderr);
+   fprintf(stderr, "virtual time: %.3f s, wall time: %.3f s (%.1fx)\n",
+         virt, wall, (wall > 0) ? virt / wall : 0.0);
+   fprintf(stderr, "frames: %llu (%.0f per wall second)\n",
+         (unsigned long long) frames, (wall > 0) ? frames / wall : 0.0);
+   if (replay_mode() != REPLAY_OFF)
+      fprintf(stderr, "replay: %u ticks (%.0f per wall second), "
+            "%d events, trace %08x\n", (unsigned) replay_ticks(),
+            (wall > 0) ? replay_ticks() / wall : 0.0, replay_events(),
+            (unsigned) replay_trace());
+   if (video)
+      fprintf(stderr, "video: %llu frames composed (%.0f per wall second)\n",
+            (unsigned long long) video_frames,
+            (video_wall > 0) ? video_frames / video_wall : 0.0);
+   if (!golden.empty()) {
+      fprintf(stderr, "golden: %d of %d frames checked, %d mismatches\n",
+            golden_checked, (int) golden.size(), golden_bad);
+      failed = golden_bad > 0 || golden_checked < (int) golden.size();
+   }
+   // with the sync status (sprite-side reads) the commits wait for
+   // vertical blanking; replay playback commits at once by design
+   if (bus.count(SimBus::DEV_SPRITE).rd > 0 && replay_mode() != REPLAY_PLAY
+         && bus.active_moves() > 0) {
+      fprintf(stderr, "vsync: %llu sprite moves in the visible area\n",
+            (unsigned long long) bus.active_moves());
+      failed = true;
+   }
+   if (golden_file)
+      fclose(golden_file);
+   if (record_file)
+      fclose(record_file);
+   exit(failed ? 1 : 0);
+}
+
+// vertical blanking of raster frame f: compose it, then check / save
+static void compose_frame(uint64_t f) {
+   std::map<uint64_t, uint32_t>::const_iterator g;
+   char path[512];
+   double t0;
+   uint32_t h;
+
+   if (f % video_every != 0)
+      return;
+   t0 = wall_seconds();
+   video->render();
+   video_wall += wall_seconds() - t0;
+   video_frames++;
+   if (!golden.empty() || golden_file) {
+      h = video->hash();
+      g = golden.find(f);
+      if (g != golden.end()) {
+         golden_checked++;
+         if (g->second != h) {
+            golden_bad++;
+            fprintf(stderr, "golden: frame %llu is %08x, expected %08x\n",
+                  (unsigned long long) f, (unsigned) h, (unsigned) g->second);
+         }
+      }
+      if (golden_file)
+         fprintf(golden_file, "%llu %08x\n", (unsigned long long) f, (unsigned) h);
+   }
+   if (png_dir) {
+      snprintf(path, sizeof(path), "%s/f%06llu.png", png_dir, (unsigned long long) f);
+      if (!video->write_png(path))
+         perror(path);
+   }
+   if (ppm_dir) {
+      snprintf(path, sizeof(path), "%s/f%06llu.ppm", ppm_dir, (unsigned long long) f);
+      if (!video->write_ppm(path))
+         perror(path);
+   }
+}
+
+static void load_golden(const char *path) {
+   unsigned long long f;
+   unsigned h;
+   FILE *fp = fopen(path, "r");
+
+   if (!fp) {
+      perror(path);
+      exit(1);
+   }
+   while (fscanf(fp, "%llu %x", &f, &h) == 2)
+      golden[f] = h;
+   fclose(fp);
+}
+
+static void match_end(bool ok) {
+   if (replay_mode() == REPLAY_PLAY)
+      fprintf(stderr, "replay %s\n", ok ? "verified" : "MISMATCH");
+   finish();
+}
+
+// load a log saved by --record (uart text; other lines are ignored)
+static void load_replay(const char *path) {
+   char line[128];
+   FILE *fp = fopen(path, "r");
+
+   if (!fp) {
+      perror(path);
+      exit(1);
+   }
+   while (fgets(line, sizeof(line), fp))
+      replay_parse_line(line);
+   fclose(fp);
+   replay_begin(REPLAY_PLAY, 0);
+}
+
+// start, then keep both players busy until the limit
+static void demo_script(SimBus &bus, int run_ms) {
+   int t;
+
+   for (t = 500; t < run_ms; t += 3000)
+      bus.press_key(t, 0x5a, 100);            // ENTER (menus)
+   for (t = 6000; t < run_ms; t += 1200) {
+      bus.press_key(t, 0x23, 400);            // D: p1 right
+      bus.press_key(t + 500, 0x1c, 300);      // A: p1 left
+      bus.press_key(t + 200, 0x29, 100);      // SPACE: p1 kick
+      bus.press_key(t + 100, 0xe06b, 500);    // LEFT: p2 left
+      bus.press_key(t + 700, 0xe074, 300);    // RIGHT: p2 right
+      bus.press_key(t + 300, 0x4d, 100);      // P: p2 kick
+      if ((t / 1200) % 3 == 0) {
+         bus.press_key(t + 50, 0x1d, 100);    // W: p1 jump
+         bus.press_key(t + 650, 0xe075, 100); // UP: p2 jump
+      }
+   }
+}
+
+static void usage(const char *prog) {
+   fprintf(stderr, "usage: %s [--ms N] [--press T:CODE[:H]]... [--clks N] "
+         "[--idle-us N] [--uart] [--sw HEX]\n"
+         "       [--record FILE | --replay FILE] [--video] [--every N] "
+         "[--png DIR] [--ppm DIR]\n"
+         "       [--golden FILE] [--golden-save FILE] [--hw DIR]\n", prog);
+   exit(1);
+}
+
+int main(int argc, char *argv[]) {
+   SimBus &bus = sim_bus();
+   int run_ms = 30000;
+   int clks = 10, idle_us = 10;
+   bool scripted = false, video_on = false;
+   const char *hw_dir = "../Hardware";
+   std::string font;
+   unsigned sw = 0;
+   int i;
+
+   for (i = 1; i < argc; i++) {
+      if (!strcmp(argv[i], "--ms") && i + 1 < argc) {
+         run_ms = atoi(argv[++i]);
+      } else if (!strcmp(argv[i], "--press") && i + 1 < argc) {
+         unsigned t, code, hold = 100;
+         if (sscanf(argv[++i], "%u:%x:%u", &t, &code, &hold) < 2)
+            usage(argv[0]);
+         bus.press_key(t, (int) code, (int) hold);
+         scripted = true;
+      } else if (!strcmp(argv[i], "--clks") && i + 1 < argc) {
+         clks = atoi(argv[++i]);
+      } else if (!strcmp(argv[i], "--idle-us") && i + 1 < argc) {
+         idle_us = atoi(argv[++i]);
+      } else if (!strcmp(argv[i], "--uart")) {
+         bus.echo_uart(true);
+      } else if (!strcmp(argv[i], "--sw") && i + 1 < argc) {
+         if (sscanf(argv[++i], "%x", &sw) != 1)
+            usage(argv[0]);
+      } else if (!strcmp(argv[i], "--record") && i + 1 < argc) {
+         record_file = fopen(argv[++i], "w");
+         if (!record_file) {
+            perror(argv[i]);
+            exit(1);
+         }
+         bus.capture_uart(record_file);
+         sw |= 0x0001;
+         replay_set_end_hook(match_end);
+      } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+         load_replay(argv[++i]);
+         bus.press_key(500, 0x5a, 100);       // ENTER: start the match
+         scripted = true;
+         replay_set_end_hook(match_end);
+      } else if (!strcmp(argv[i], "--video")) {
+         video_on = true;
+      } else if (!strcmp(argv[i], "--every") && i + 1 < argc) {
+         video_every = atoi(argv[++i]);
+         if (video_every < 1)
+            usage(argv[0]);
+      } else if (!strcmp(argv[i], "--png") && i + 1 < argc) {
+         png_dir = argv[++i];
+         video_on = true;
+      } else if (!strcmp(argv[i], "--ppm") && i + 1 < argc) {
+         ppm_dir = argv[++i];
+         video_on = true;
+      } else if (!strcmp(argv[i], "--golden") && i + 1 < argc) {
+         load_golden(argv[++i]);
+         video_on = true;
+      } else if (!strcmp(argv[i], "--golden-save") && i + 1 < argc) {
+         golden_file = fopen(argv[++i], "w");
+         if (!golden_file) {
+            perror(argv[i]);
+            exit(1);
+         }
+         video_on = true;
+      } else if (!strcmp(argv[i], "--hw") && i + 1 < argc) {
+         hw_dir = argv[++i];
+      } else {
+         usage(argv[0]);
+      }
+   }
+   if (video_on) {
+      video = new SimVideo(&bus);
+      font = std::string(hw_dir) + "/font.mem";
+      if (!video->load_font(font.c_str()))
+         perror(font.c_str());
+      SimVideo::load_rams(&bus, hw_dir);
+      bus.set_frame_hook(compose_frame);
+   }
+   if (!scripted)
+      demo_script(bus, run_ms);
+   bus.set_switches(sw);
+   bus.set_cost(clks, idle_us * SYS_CLK_FREQ);
+   clock_gettime(CLOCK_MONOTONIC, &wall_start);
+   bus.set_limit_ms(run_ms, finish);
+   game_main();
+   finish();
+   return (0);
+}
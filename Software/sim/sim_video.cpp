@@ -0,0 +1,325 @@
+/*****************************************************************//**
+ * @file sim_video.cpp
+ *
+ * @brief implementation of the reference compositor
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "sim_video.h"
+#include "mem_file.h"
+
+/* a sprite core of the chain (*_src.sv) */
+struct SpriteLayer {
+   int slot;
+   int w, h;
+   int x_bits;              // ram address = {sel, yr, xr[x_bits-1:0]}
+   int code_mask;           // pixel_in width
+   bool sel;                // ctrl bit 1 selects the upper ram half
+   uint16_t palette[8];     // code 0 and unused codes: KEY_COLOR
+   const char *mem;         // $readmemh file
+};
+
+// back to front
+static const SpriteLayer LAYERS[] = {
+   { V6_GOALPOST1, 8, 80, 3, 3, false,
+         { 0, 0x100, 0xfff, 0, 0, 0, 0, 0 }, "goalpost_map.mem" },
+   { V5_GOALPOST2, 8, 80, 3, 3, false,
+         { 0, 0x100, 0xfff, 0, 0, 0, 0, 0 }, "goalpost_map.mem" },
+   { V4_PLAYER2, 32, 32, 5, 7, true,
+         { 0, 0x100, 0xfff, 0x543, 0x976, 0xfda, 0x4ad, 0 }, "player2_map.mem" },
+   { V3_PLAYER1, 32, 32, 5, 7, true,
+         { 0, 0x100, 0xfff, 0x543, 0x976, 0xfda, 0xe22, 0 }, "player1_map.mem" },
+   { V2_BALL, 16, 16, 4, 3, false,
+         { 0, 0xfff, 0x100, 0xf0f, 0, 0, 0, 0 }, "soccerball.mem" },
+   { V8_POWERUP, 16, 16, 4, 3, false,
+         { 0, 0x100, 0xff0, 0xfff, 0, 0, 0, 0 }, "powerup_map.mem" }
+};
+static const int N_LAYERS = sizeof(LAYERS) / sizeof(LAYERS[0]);
+
+SimVideo::SimVideo(const SimBus *bus) {
+   int c;
+
+   this->bus = bus;
+   // 3-bit channels widened to 4 by repeating the top bit
+   for (c = 0; c < 512; c++)
+      pal9[c] = (uint16_t) (((c >> 6) & 7) << 9 | ((c >> 8) & 1) << 8
+            | ((c >> 3) & 7) << 5 | ((c >> 5) & 1) << 4
+            | (c & 7) << 1 | ((c >> 2) & 1));
+   memset(font, 0, sizeof(font));
+   memset(pix, 0, sizeof(pix));
+   draw_bar_image();
+}
+
+bool SimVideo::load_font(const char *path) {
+   return (read_mem(path, false, font, sizeof(font), 0, 2) >= 0);
+}
+
+int SimVideo::load_rams(SimBus *bus, const char *hw_dir) {
+   uint8_t ram[SimBus::VIDEO_MEM_WORDS];
+   std::string path;
+   int i, k, depth, n = 0;
+
+   for (i = 0; i < N_LAYERS; i++) {
+      path = std::string(hw_dir) + "/" + LAYERS[i].mem;
+      depth = (LAYERS[i].sel ? 2 : 1) * LAYERS[i].h << LAYERS[i].x_bits;
+      if (read_mem(path.c_str(), false, ram, depth, 0) < 0)
+         continue;
+      // $readmemh keeps the low bits of a word wider than the ram
+      // (goalpost_map.mem: 8 digits into 2 bits), as does synthesis
+      for (k = 0; k < depth; k++)
+         ram[k] &= (uint8_t) LAYERS[i].code_mask;
+      bus->init_video_ram(LAYERS[i].slot, ram, depth);
+      n++;
+   }
+   return (n);
+}
+
+// bar_src.sv: hud strip, sky with sun and clouds, striped grass
+void SimVideo::draw_bar_image() {
+   const int HUD = 60, HORIZON = H - 80, STRIPE = 80 / 3;
+   uint16_t c;
+   int x, y, dx, dy;
+
+   for (y = 0; y < H; y++) {
+      for (x = 0; x < W; x++) {
+         if (y < HUD) {
+            c = 0x888;
+            if ((x >= 10 && x < 100) || (x >= W / 2 - 80 && x < W / 2 + 80)
+                  || (x >= W - 100 && x < W - 10))
+               c = 0x000;
+         } else if (y < HORIZON) {
+            c = 0x8cf;
+            dx = x - 550;
+            dy = y - 80;
+            if (dx * dx + dy * dy < 35 * 35)
+               c = 0xff0;
+            if ((x > 50 && x < 150 && y > 100 && y < 140)
+                  || (x > 220 && x < 320 && y > 60 && y < 100))
+               c = 0xdef;
+            if ((x > 300 && x < 380 && y > 130 && y < 160)
+                  || (x > 420 && x < 500 && y > 90 && y < 120))
+               c = 0xfff;
+         } else if (x == W / 2) {
+            c = 0xfff;
+         } else {
+            c = (y >= HORIZON + STRIPE && y < HORIZON + 2 * STRIPE) ? 0x0a8 : 0x074;
+         }
+         bar[y * W + x] = c;
+      }
+   }
+}
+
+void SimVideo::frame_layer() {
+   const std::vector<uint32_t> &fb = bus->frame();
+   int i;
+
+   if (bus->frame_bypass() & 1) {
+      for (i = 0; i < W * H; i++)
+         pix[i] = BLUE_SCREEN;
+      return;
+   }
+   for (i = 0; i < W * H; i++)
+      pix[i] = pal9[fb[i] & 0x1ff];
+}
+
+void SimVideo::sprite_layer(int layer) {
+   const SpriteLayer &l = LAYERS[layer];
+   const SimBus::VideoSlot &v = bus->video(l.slot);
+   const uint32_t *ram;
+   uint16_t c;
+   int x0, y0, x, y, xa, xb, ya, yb;
+
+   if (v.reg[0] & 1)
+      return;
+   x0 = (int) (v.reg[1] & 0x7ff);
+   y0 = (int) (v.reg[2] & 0x7ff);
+   ram = v.mem;
+   if (l.sel && (v.reg[3] & 2))
+      ram += l.h << l.x_bits;
+   xa = x0;
+   xb = (x0 + l.w < W) ? x0 + l.w : W;
+   ya = y0;
+   yb = (y0 + l.h < H) ? y0 + l.h : H;
+   for (y = ya; y < yb; y++) {
+      for (x = xa; x < xb; x++) {
+         c = l.palette[ram[(y - y0) << l.x_bits | (x - x0)] & l.code_mask];
+         if (c != KEY_COLOR)
+            pix[y * W + x] = c;
+      }
+   }
+}
+
+void SimVideo::osd_layer() {
+   const SimBus::VideoSlot &v = bus->video(V1_OSD);
+   uint16_t fg = (uint16_t) (v.reg[1] & 0xfff), bg = (uint16_t) (v.reg[2] & 0xfff);
+   uint16_t on, off, c, *p;
+   uint32_t ch;
+   uint8_t bits;
+   int xt, yt, r, b;
+
+   if (v.reg[0] & 1)
+      return;
+   for (yt = 0; yt < H / 16; yt++) {
+      for (xt = 0; xt < W / 8; xt++) {
+         ch = v.mem[yt << 7 | xt] & 0xff;
+         if ((ch & 0x7f) == 0)
+            continue;                     // null char: transparent
+         on = (ch & 0x80) ? bg : fg;
+         off = (ch & 0x80) ? fg : bg;
+         for (r = 0; r < 16; r++) {
+            bits = font[(ch & 0x7f) << 4 | r];
+            p = &pix[(yt * 16 + r) * W + xt * 8];
+            for (b = 0; b < 8; b++) {
+               c = ((bits >> (7 - b)) & 1) ? on : off;
+               if (c != KEY_COLOR)
+                  p[b] = c;
+            }
+         }
+      }
+   }
+}
+
+void SimVideo::render() {
+   int i;
+
+   if (bus->video(V7_BAR).reg[0] & 1)
+      frame_layer();
+   else
+      memcpy(pix, bar, sizeof(pix));
+   for (i = 0; i < N_LAYERS; i++)
+      sprite_layer(i);
+   osd_layer();
+}
+
+uint32_t SimVideo::hash() const {
+   uint32_t h = 2166136261u;
+   int i;
+
+   for (i = 0; i < W * H; i++) {
+      h = (h ^ (pix[i] & 0xff)) * 16777619u;
+      h = (h ^ (pix[i] >> 8)) * 16777619u;
+   }
+   return (h);
+}
+
+/**********************************************************************
+ * image files
+ *********************************************************************/
+// 12-bit pixel to 8-bit r, g, b
+static void rgb8(uint16_t c, uint8_t *out) {
+   out[0] = (uint8_t) (((c >> 8) & 0xf) * 17);
+   out[1] = (uint8_t) (((c >> 4) & 0xf) * 17);
+   out[2] = (uint8_t) ((c & 0xf) * 17);
+}
+
+bool SimVideo::write_ppm(const char *path, const uint16_t *p) {
+   static uint8_t row[W * 3];
+   FILE *fp = fopen(path, "wb");
+   bool ok;
+   int x, y;
+
+   if (fp == NULL)
+      return (false);
+   fprintf(fp, "P6\n%d %d\n255\n", W, H);
+   for (y = 0; y < H; y++) {
+      for (x = 0; x < W; x++)
+         rgb8(p[y * W + x], &row[x * 3]);
+      fwrite(row, 1, sizeof(row), fp);
+   }
+   ok = !ferror(fp);
+   return (fclose(fp) == 0 && ok);
+}
+
+static uint32_t crc_table[256];
+
+static uint32_t png_crc(uint32_t crc, const uint8_t *p, int n) {
+   uint32_t c;
+   int i, k;
+
+   if (crc_table[1] == 0) {
+      for (i = 0; i < 256; i++) {
+         for (c = (uint32_t) i, k = 0; k < 8; k++)
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+         crc_table[i] = c;
+      }
+   }
+   for (i = 0; i < n; i++)
+      crc = crc_table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+   return (crc);
+}
+
+static void put_be32(uint8_t *p, uint32_t v) {
+   p[0] = (uint8_t) (v >> 24);
+   p[1] = (uint8_t) (v >> 16);
+   p[2] = (uint8_t) (v >> 8);
+   p[3] = (uint8_t) v;
+}
+
+static void png_chunk(FILE *fp, const char *type, const uint8_t *data, int n) {
+   uint8_t b[4];
+   uint32_t crc;
+
+   put_be32(b, (uint32_t) n);
+   fwrite(b, 1, 4, fp);
+   fwrite(type, 1, 4, fp);
+   fwrite(data, 1, n, fp);
+   crc = png_crc(0xffffffffu, (const uint8_t *) type, 4);
+   crc = png_crc(crc, data, n) ^ 0xffffffffu;
+   put_be32(b, crc);
+   fwrite(b, 1, 4, fp);
+}
+
+// rgb, 8 bits per channel; the zlib stream is made of stored
+// (uncompressed) deflate blocks, so no zlib is needed
+bool SimVideo::write_png(const char *path, const uint16_t *p) {
+   static const uint8_t SIG[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+   static const int RAW = H * (1 + W * 3);
+   static const int BLOCK = 65535;
+   static uint8_t raw[RAW];
+   static uint8_t z[2 + RAW + (RAW / BLOCK + 1) * 5 + 4];
+   uint8_t ihdr[13];
+   uint32_t s1 = 1, s2 = 0;
+   FILE *fp;
+   bool ok;
+   int x, y, i, n, len = 0;
+
+   for (y = 0; y < H; y++) {
+      raw[y * (1 + W * 3)] = 0;              // filter: none
+      for (x = 0; x < W; x++)
+         rgb8(p[y * W + x], &raw[y * (1 + W * 3) + 1 + x * 3]);
+   }
+   z[len++] = 0x78;
+   z[len++] = 0x01;
+   for (i = 0; i < RAW; i += n) {
+      n = (RAW - i < BLOCK) ? RAW - i : BLOCK;
+      z[len++] = (i + n == RAW) ? 1 : 0;
+      z[len++] = (uint8_t) n;
+      z[len++] = (uint8_t) (n >> 8);
+      z[len++] = (uint8_t) ~n;
+      z[len++] = (uint8_t) (~n >> 8);
+      memcpy(&z[len], &raw[i], n);
+      len += n;
+   }
+   for (i = 0; i < RAW; i++) {
+      s1 = (s1 + raw[i]) % 65521;
+      s2 = (s2 + s1) % 65521;
+   }
+   put_be32(&z[len], s2 << 16 | s1);
+   len += 4;
+   put_be32(ihdr, W);
+   put_be32(ihdr + 4, H);
+   ihdr[8] = 8;         // bit depth
+   ihdr[9] = 2;         // rgb
+   ihdr[10] = ihdr[11] = ihdr[12] = 0;
+   if ((fp = fopen(path, "wb")) == NULL)
+      return (false);
+   fwrite(SIG, 1, sizeof(SIG), fp);
+   png_chunk(fp, "IHDR", ihdr, sizeof(ihdr));
+   png_chunk(fp, "IDAT", z, len);
+   png_chunk(fp, "IEND", ihdr, 0);
+   ok = !ferror(fp);
+   return (fclose(fp) == 0 && ok);
+}
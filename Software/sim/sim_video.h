@@ -0,0 +1,97 @@
+/*****************************************************************//**
+ * @file sim_video.h
+ *
+ * @brief reference compositor of the video subsystem (host model)
+ *
+ * Description:
+ *  - renders one 640x480 frame from the video state held by the
+ *    virtual bus, in the order of the daisy chain of
+ *    video_sys_daisy.sv (back to front):
+ *      frame buffer (blue screen when bypassed), bar (v7),
+ *      goalpost1 (v6), goalpost2 (v5), player2 (v4), player1 (v3),
+ *      ball (v2), powerup (v8), osd (v1)
+ *  - a core that is not bypassed replaces the pixel with its own
+ *    unless that is the chroma key (KEY_COLOR = 0); the bar core is
+ *    opaque, so the frame buffer is not rendered under it
+ *  - per core as in its *_src.sv: sprite size, ram address of a pixel
+ *    ({sel, yr, xr}), code width and palette; x0/y0 are 11-bit
+ *    registers, so a sprite moved to a negative position is not shown
+ *  - osd: 80x30 tiles of 8x16 from font.mem, reverse-video bit 7,
+ *    null char transparent, background color 0 transparent
+ *  - the pipeline delays of the cores are aligned in hardware and not
+ *    modeled; a frame is rendered from the state at the start of its
+ *    vertical blanking, so writes made during the visible area show
+ *    on the whole frame instead of tearing it
+ *  - pixels are 12-bit RGB; frames can be hashed (golden-image
+ *    regression) and written as PPM or PNG
+ *
+ ********************************************************************/
+
+#ifndef _SIM_VIDEO_H_INCLUDED
+#define _SIM_VIDEO_H_INCLUDED
+
+#include <inttypes.h>
+#include "sim_bus.h"
+
+/**
+ * compositor over the bus video state
+ */
+class SimVideo {
+public:
+   /**
+    * symbolic constants
+    */
+   enum {
+      W = SimBus::FRAME_W,
+      H = SimBus::FRAME_H,
+      BLUE_SCREEN = 0x008,     /**< frame buffer si_rgb */
+      KEY_COLOR = 0
+   };
+
+   SimVideo(const SimBus *bus);
+
+   /**
+    * load the font rom
+    * @param path font.mem ($readmemb, 128 chars x 16 rows)
+    * @return false if the file cannot be read
+    */
+   bool load_font(const char *path);
+
+   /**
+    * give the sprite rams their bitstream contents (*_map.mem)
+    * @param bus virtual bus
+    * @param hw_dir directory of the .mem files
+    * @return number of rams loaded
+    */
+   static int load_rams(SimBus *bus, const char *hw_dir);
+
+   /* compose the current state into the frame */
+   void render();
+
+   /* 12-bit RGB pixels, row-major */
+   const uint16_t *pixels() const { return pix; }
+   /* FNV-1a hash of the pixels */
+   uint32_t hash() const;
+
+   /* write the frame; false on an i/o error */
+   bool write_ppm(const char *path) const { return write_ppm(path, pix); }
+   bool write_png(const char *path) const { return write_png(path, pix); }
+
+   /* write any W x H frame of 12-bit pixels (e.g. a captured one) */
+   static bool write_ppm(const char *path, const uint16_t *p);
+   static bool write_png(const char *path, const uint16_t *p);
+
+private:
+   const SimBus *bus;
+   uint16_t pix[W * H];
+   uint16_t bar[W * H];       // bar_src image (static)
+   uint16_t pal9[512];        // frame_palette_9
+   uint8_t font[2048];
+
+   void draw_bar_image();
+   void frame_layer();
+   void sprite_layer(int layer);
+   void osd_layer();
+};
+
+#endif  // _SIM_VIDEO_H_INCLUDED
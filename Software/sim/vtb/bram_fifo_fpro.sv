@@ -0,0 +1,65 @@
+//======================================================================
+// Description: simulation model of bram_fifo_fpro (verilator build)
+// Design:
+//   * stands in for Hardware/bram_fifo_fpro.sv, whose xilinx
+//     FIFO_DUALCLOCK_MACRO has no verilator model
+//   * same ports and behavior as the macro as configured there:
+//     18Kb, 1024 words, first word fall through, almost full/empty
+//     128 words from the ends
+//   * the occupancy is computed from both pointers at once; the
+//     macro's flag latency across the clock domains is not modeled
+//   * a write to a full fifo / read of an empty one is ignored and
+//     flagged like WRERR / RDERR
+//======================================================================
+module bram_fifo_fpro 
+   #(parameter DW = 8)               // data width
+   (
+      input  logic reset,
+      // read port
+      input  logic clk_rd,           // read clock
+      output logic empty,            // read port empty
+      output logic almost_empty,     // read port almost empty
+      input  logic rd_ack,           // read acknowledgement
+      output logic [DW-1:0] rd_data, // read data
+      // write port
+      input  logic clk_wr,           // write clock
+      output logic full,             // write port full 
+      output logic almost_full,      // write port almost full 
+      input  logic wr_en,            // write enable 
+      input  logic [DW-1:0] wr_data, // write data
+      // occupancy of fifo
+      output logic [9:0] rdcount,    // read count
+      output logic [9:0] wrcount     // write count
+   );
+
+   // constant declaration
+   localparam DEPTH = 1024;
+   localparam OFFSET = 128;
+   // signal declaration
+   logic [DW-1:0] mem [0:DEPTH-1];
+   logic [10:0] wr_ptr, rd_ptr, count;
+
+   // write port
+   always_ff @(posedge clk_wr, posedge reset)
+      if (reset)
+         wr_ptr <= 0;
+      else if (wr_en && !full) begin
+         mem[wr_ptr[9:0]] <= wr_data;
+         wr_ptr <= wr_ptr + 1;
+      end
+   // read port (first word fall through)
+   always_ff @(posedge clk_rd, posedge reset)
+      if (reset)
+         rd_ptr <= 0;
+      else if (rd_ack && !empty)
+         rd_ptr <= rd_ptr + 1;
+   assign rd_data = mem[rd_ptr[9:0]];
+   // flags
+   assign count = wr_ptr - rd_ptr;
+   assign empty = (count == 0);
+   assign almost_empty = (count <= OFFSET);
+   assign full = (count == DEPTH);
+   assign almost_full = (count >= DEPTH - OFFSET);
+   assign rdcount = rd_ptr[9:0];
+   assign wrcount = wr_ptr[9:0];
+endmodule
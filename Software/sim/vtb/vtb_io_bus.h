@@ -0,0 +1,54 @@
+/*****************************************************************//**
+ * @file vtb_io_bus.h
+ *
+ * @brief vendor io access macros for the verilator co-simulation
+ *
+ * Description:
+ *  - force-included (-include) with -D_VENDOR_IO_ACCESS_USED, like
+ *    sim_io_bus.h, ahead of the firmware drivers built into
+ *    vtb_video
+ *  - every register access becomes one MicroBlaze io bus transaction
+ *    on the verilated design (vtb_video.cpp)
+ *  - sim_io_bus.h comes first, so the virtual bus linked alongside
+ *    keeps its declarations and the macros below win
+ *
+ ********************************************************************/
+
+#ifndef _VTB_IO_BUS_H_INCLUDED
+#define _VTB_IO_BUS_H_INCLUDED
+
+#include <inttypes.h>
+#include "sim_io_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * read a word over the io bus of the verilated design
+ * @param addr byte address
+ * @return 32-bit data
+ */
+uint32_t vtb_io_read(uint32_t addr);
+
+/**
+ * write a word over the io bus of the verilated design
+ * @param addr byte address
+ * @param data 32-bit data
+ */
+void vtb_io_write(uint32_t addr, uint32_t data);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#undef io_read
+#undef io_write
+
+#define io_read(base_addr, offset) \
+   vtb_io_read((uint32_t) ((base_addr) + 4*(offset)))
+
+#define io_write(base_addr, offset, data) \
+   vtb_io_write((uint32_t) ((base_addr) + 4*(offset)), (uint32_t) (data))
+
+#endif  // _VTB_IO_BUS_H_INCLUDED
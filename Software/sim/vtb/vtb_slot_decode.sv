@@ -0,0 +1,86 @@
+//======================================================================
+// Description: self-checking testbench of the video slot decode
+//              (chu_video_controller.sv)
+// Design:
+//   * every slot 0..15 at a few register addresses: exactly its
+//     slot_cs_array bit is set, frame_cs is clear, the register
+//     address reaches every slot
+//   * `V8_POWERUP (chu_io_map.svh) selects slot 8; with the 3-bit
+//     decode of video_addr[16:14] it selected slot 0
+//   * frame buffer addresses (bit 20) set frame_cs and no slot;
+//     video_cs low selects nothing
+//
+// Run (from Software/):
+//   make -C sim/vtb slot
+//   or: verilator --binary -Wno-fatal -I../Hardware --top-module
+//       vtb_slot_decode sim/vtb/vtb_slot_decode.sv
+//       ../Hardware/chu_video_controller.sv -o vtb_slot_decode
+//       && obj_dir/vtb_slot_decode
+//   or: iverilog -g2012 -I../Hardware (same sources) && vvp a.out
+//   * $fatal (non-zero exit status) on any error
+//======================================================================
+`include "chu_io_map.svh"
+module vtb_slot_decode;
+
+   // signal declaration
+   logic video_cs, video_wr;
+   logic [20:0] video_addr;
+   logic [31:0] video_wr_data;
+   logic frame_cs, frame_wr;
+   logic [19:0] frame_addr;
+   logic [31:0] frame_wr_data;
+   logic [15:0] slot_cs_array, slot_mem_wr_array;
+   logic [13:0] slot_reg_addr_array [15:0];
+   logic [31:0] slot_wr_data_array [15:0];
+   int errors = 0, checked = 0;
+
+   // device under test
+   chu_video_controller dut (.*);
+
+   function automatic void error(string what);
+      errors++;
+      if (errors <= 10)
+         $display("addr %h: %s (slot_cs %h, frame_cs %b)", video_addr, what,
+               slot_cs_array, frame_cs);
+   endfunction
+
+   // one access; expect: slot number, -1 frame buffer, -2 nothing
+   task automatic access(logic cs, logic [20:0] addr, int expect_slot);
+      video_cs = cs;
+      video_addr = addr;
+      #1;
+      checked++;
+      if (expect_slot >= 0) begin
+         if (slot_cs_array != (16'h1 << expect_slot) || frame_cs)
+            error($sformatf("slot %0d not selected alone", expect_slot));
+         for (int s = 0; s < 16; s++)
+            if (slot_reg_addr_array[s] != addr[13:0])
+               error("register address not broadcast");
+      end
+      else if (expect_slot == -1) begin
+         if (slot_cs_array != 0 || !frame_cs)
+            error("frame buffer not selected alone");
+      end
+      else if (slot_cs_array != 0 || frame_cs)
+         error("selected without video_cs");
+   endtask
+
+   initial begin
+      video_wr = 1;
+      video_wr_data = 32'h1234_5678;
+      for (int s = 0; s < 16; s++) begin
+         access(1, {3'b000, 4'(s), 14'h0000}, s);
+         access(1, {3'b000, 4'(s), 14'h0001}, s);
+         access(1, {3'b000, 4'(s), 14'h3fff}, s);
+         access(0, {3'b000, 4'(s), 14'h0000}, -2);
+      end
+      access(1, {3'b000, 4'(`V8_POWERUP), 14'h0002}, 8);
+      access(1, 21'h10_0000, -1);
+      access(1, 21'h1f_ffff, -1);
+      $display("slot decode: %0d accesses, %0d errors", checked, errors);
+      if (errors > 0)
+         $fatal(1, "slot decode: FAILED");
+      $finish;
+   end
+
+endmodule
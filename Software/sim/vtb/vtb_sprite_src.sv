@@ -0,0 +1,88 @@
+//======================================================================
+// Description: self-checking testbench of a sprite source module
+//              (ball_src.sv)
+// Design:
+//   * fills the sprite ram with code 01 (white) through the write
+//     port, places the sprite at (X0, Y0) and scans a window around
+//     it: sprite_rgb must be white inside the 16x16 region and the
+//     key color outside
+//   * the region is combinational in the scan position; declared
+//     "logic x = expr;" it is only an initial value and the scan
+//     sees a fixed region (the bug fixed by the wire declarations
+//     of the *_src and vga_sprite_*_core modules)
+//
+// Run (from Software/: make -C sim/vtb sprite), or from Hardware/
+// (the ram $readmems soccerball.mem):
+//   verilator --binary -Wno-fatal --top-module vtb_sprite_src
+//       ../Software/sim/vtb/vtb_sprite_src.sv ball_src.sv
+//       ball_ram_lut.sv -o vtb_sprite_src && obj_dir/vtb_sprite_src
+//   or: iverilog -g2012 (same sources) && vvp a.out
+//   * $fatal (non-zero exit status) on any error
+//======================================================================
+`timescale 1ns/1ps
+module vtb_sprite_src;
+
+   // constant declaration
+   localparam X0 = 100;
+   localparam Y0 = 50;
+   localparam KEY_COLOR = 12'h000;
+   localparam WHITE = 12'hfff;
+   // signal declaration
+   logic clk = 0;
+   logic [10:0] x, y;
+   logic [10:0] x0, y0;
+   logic we;
+   logic [7:0] addr_w;
+   logic [1:0] pixel_in;
+   logic [11:0] sprite_rgb;
+   int errors = 0, inside = 0, outside = 0;
+
+   always #5 clk = ~clk;
+
+   // device under test
+   ball_src #(.KEY_COLOR(KEY_COLOR)) dut (.*);
+
+   initial begin
+      x = 0;
+      y = 0;
+      x0 = X0;
+      y0 = Y0;
+      we = 1;
+      pixel_in = 2'b01;
+      for (int a = 0; a < 256; a++) begin
+         addr_w = a;
+         @(posedge clk);
+      end
+      we = 0;
+      // ram read and output register: hold each position 2 clocks
+      for (int j = Y0 - 4; j < Y0 + 20; j++)
+         for (int i = X0 - 4; i < X0 + 20; i++) begin
+            x = i;
+            y = j;
+            repeat (2) @(posedge clk);
+            #1;
+            if (i >= X0 && i < X0 + 16 && j >= Y0 && j < Y0 + 16) begin
+               inside++;
+               if (sprite_rgb != WHITE) begin
+                  errors++;
+                  if (errors <= 10)
+                     $display("(%0d,%0d) inside: rgb %h", i, j, sprite_rgb);
+               end
+            end
+            else begin
+               outside++;
+               if (sprite_rgb != KEY_COLOR) begin
+                  errors++;
+                  if (errors <= 10)
+                     $display("(%0d,%0d) outside: rgb %h", i, j, sprite_rgb);
+               end
+            end
+         end
+      $display("sprite src: %0d pixels inside, %0d outside, %0d errors",
+            inside, outside, errors);
+      if (errors > 0)
+         $fatal(1, "sprite src: FAILED");
+      $finish;
+   end
+
+endmodule
@@ -0,0 +1,127 @@
+//======================================================================
+// Description: self-checking testbench of the vga sync core status
+//              register (chu_vga_sync_core.sv)
+// Design:
+//   * clk_sys 100 MHz and clk_25M with a free-running phase (period
+//     40.014 ns), so the toggle synchronizer sees every phase
+//     relation between the two clocks within a few frames
+//   * the status word (rd_data) is sampled at every clk_sys edge for
+//     FRAMES frames and checked:
+//       - bit 11 (vblank) equals vcount >= 480, bits 15..12 are 0,
+//         vcount is below 525
+//       - each new word is the next line (524 wraps to 0), and the
+//         frame count steps by one exactly when vcount turns 480
+//       - a new word arrives once per line: 800 pixel clocks,
+//         LINE_CLKS +/- 1 sys clocks after the previous one
+//   * prints the number of lines, frames and vblank edges seen; the
+//     vblank bit must rise and fall once per frame
+//   * bram_fifo_fpro.sv of sim/vtb replaces the Xilinx fifo macro
+//
+// Run (from Software/):
+//   make -C sim/vtb sync
+//   or: verilator --binary --timing -Wno-fatal --top-module
+//       vtb_sync_status sim/vtb/vtb_sync_status.sv
+//       sim/vtb/bram_fifo_fpro.sv ../Hardware/{chu_vga_sync_core,
+//       line_buffer,vga_sync,frame_counter}.sv -o vtb_sync_status
+//       && obj_dir/vtb_sync_status
+//   or: iverilog -g2012 (same sources) && vvp a.out
+//   * $fatal (non-zero exit status) on any error
+//======================================================================
+`timescale 1ps/1ps
+module vtb_sync_status;
+
+   // constant declaration
+   localparam SYS_PS = 10000;        // 100 MHz
+   localparam PIX_PS = 40014;        // ~25 MHz, drifting against clk_sys
+   localparam VD = 480;
+   localparam VT = 525;
+   localparam LINE_CLKS = (800 * PIX_PS + SYS_PS / 2) / SYS_PS;
+   localparam FRAMES = 3;
+   // signal declaration
+   logic clk_sys = 0, clk_25M = 0, reset = 1;
+   logic [31:0] rd_data, last;
+   logic hsync, vsync;
+   logic [11:0] rgb;
+   logic si_ready;
+   int errors = 0, lines = 0, frames = 0, rose = 0, fell = 0;
+   int clks = 0, last_clks = 0;
+   bit seen = 0;
+
+   // clocks
+   always #(SYS_PS / 2) clk_sys = ~clk_sys;
+   always #(PIX_PS / 2) clk_25M = ~clk_25M;
+
+   // device under test; video stream idle (the raster runs regardless)
+   chu_vga_sync_core #(.CD(12)) dut (
+    .clk_sys(clk_sys),
+    .clk_25M(clk_25M),
+    .reset(reset),
+    .cs(1'b0),
+    .write(1'b0),
+    .addr(14'h0),
+    .wr_data(32'h0),
+    .rd_data(rd_data),
+    .si_data(13'h0),
+    .si_valid(1'b0),
+    .si_ready(si_ready),
+    .hsync(hsync),
+    .vsync(vsync),
+    .rgb(rgb)
+   );
+
+   function automatic void error(string what);
+      errors++;
+      if (errors <= 10)
+         $display("%t: %s (status %h, previous %h)", $time, what, rd_data, last);
+   endfunction
+
+   // checks on every sys clock
+   always @(posedge clk_sys) begin
+      if (!reset) begin
+         clks++;
+         if (rd_data[11] != (rd_data[10:0] >= VD))
+            error("vblank bit does not match vcount");
+         if (rd_data[15:12] != 0 || rd_data[10:0] >= VT)
+            error("status word out of range");
+         if (seen && rd_data != last) begin
+            lines++;
+            if (rd_data[10:0] != ((last[10:0] == VT - 1) ? 0 : last[10:0] + 1))
+               error("vcount skipped a line");
+            if (rd_data[10:0] == VD) begin
+               frames++;
+               if (rd_data[31:16] != last[31:16] + 16'd1)
+                  error("frame count did not step at vblank");
+            end
+            else if (rd_data[31:16] != last[31:16])
+               error("frame count changed outside vblank start");
+            if (lines > 1 && (clks - last_clks < LINE_CLKS - 1
+                  || clks - last_clks > LINE_CLKS + 1))
+               error("status word not updated once per line");
+            rose += (rd_data[11] && !last[11]);
+            fell += (!rd_data[11] && last[11]);
+            last_clks = clks;
+         end
+         if (rd_data != last && !seen && rd_data != 0) begin
+            seen = 1;       // first line word after reset
+            last_clks = clks;
+         end
+         last <= rd_data;
+      end
+      else
+         last <= 0;
+   end
+
+   initial begin
+      #(7 * SYS_PS + 1234) reset = 0;
+      wait (frames == FRAMES);
+      repeat (LINE_CLKS * 50) @(posedge clk_sys);
+      $display("sync status: %0d lines, %0d frames, vblank rose %0d fell %0d, %0d errors",
+            lines, frames, rose, fell, errors);
+      if (rose != FRAMES || fell != FRAMES)
+         error("vblank bit did not toggle once per frame");
+      if (errors > 0)
+         $fatal(1, "sync status: FAILED");
+      $finish;
+   end
+
+endmodule
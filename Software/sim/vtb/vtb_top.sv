@@ -0,0 +1,69 @@
+//======================================================================
+// Description: verilator top of the video co-simulation (vtb_video.cpp)
+// Design:
+//   * the video half of mcs_top_complete: mcs bridge + video_sys_daisy
+//   * the MicroBlaze io bus is driven by the C++ harness, one access
+//     per io_read()/io_write() of the firmware drivers
+//   * the mmio subsystem is not instantiated; the harness answers
+//     mmio accesses (timer) from its own model
+//   * clocks are driven by the harness: clk_sys 100 MHz, clk_25M on
+//     every 4th rising edge of clk_sys (same mmcm in hardware)
+//======================================================================
+`include "chu_io_map.svh"
+module vtb_top 
+   (
+    input  logic clk_sys,
+    input  logic clk_25M,
+    input  logic reset_sys,
+    // uBlaze MCS I/O bus
+    input  logic io_read_strobe, 
+    input  logic io_write_strobe, 
+    input  logic [31:0] io_address, 
+    input  logic [31:0] io_write_data, 
+    output logic [31:0] io_read_data, 
+    // to vga monitor
+    output logic hsync, vsync,
+    output logic [11:0] rgb 
+   );
+
+   // signal declaration
+   logic fp_video_cs, fp_mmio_cs, fp_wr, fp_rd;
+   logic [20:0] fp_addr;
+   logic [31:0] fp_wr_data, fp_rd_data, video_rd_data;
+
+   // instantiate bridge
+   chu_mcs_bridge #(.BRG_BASE(32'hc000_0000)) bridge_unit (
+    .io_addr_strobe(1'b0),
+    .io_read_strobe(io_read_strobe), 
+    .io_write_strobe(io_write_strobe), 
+    .io_byte_enable(4'b1111), 
+    .io_address(io_address), 
+    .io_write_data(io_write_data), 
+    .io_read_data(io_read_data), 
+    .io_ready(), 
+    .fp_video_cs(fp_video_cs),
+    .fp_mmio_cs(fp_mmio_cs), 
+    .fp_wr(fp_wr),
+    .fp_rd(fp_rd),
+    .fp_addr(fp_addr),
+    .fp_wr_data(fp_wr_data),
+    .fp_rd_data(fp_rd_data)
+    );   
+   // read data: video subsystem only (mmio reads answered by the harness)
+   assign fp_rd_data = fp_video_cs ? video_rd_data : 32'h0;
+
+   // instantiated video subsystem
+   video_sys_daisy #(.CD(12), .VRAM_DATA_WIDTH(9)) video_sys_unit (
+     .clk_sys(clk_sys),
+     .clk_25M(clk_25M),
+     .reset_sys(reset_sys),
+     .video_cs(fp_video_cs),
+     .video_wr(fp_wr),
+     .video_addr(fp_addr),
+     .video_wr_data(fp_wr_data),
+     .video_rd_data(video_rd_data),
+     .vsync(vsync),
+     .hsync(hsync),
+     .rgb(rgb)
+   );
+endmodule
@@ -0,0 +1,400 @@
+/*****************************************************************//**
+ * @file vtb_video.cpp
+ *
+ * @brief verilator co-simulation of the video subsystem
+ *
+ * Description:
+ *  - runs the firmware video drivers (vga_core, rle_sprite, raster,
+ *    osd_canvas) against the verilated RTL of the video half of the
+ *    design (vtb_top.sv: mcs bridge + video_sys_daisy)
+ *  - every io_read()/io_write() of a driver is one io bus transaction
+ *    on the RTL: one cycle of strobe, then idle to ACCESS_CLKS sys
+ *    clocks in all, about what the MicroBlaze takes per access
+ *  - every access is mirrored to the virtual bus (sim_bus.cpp) with
+ *    the same cost, so its video state and timer stay in step with
+ *    the RTL; mmio reads (timer) are answered by the virtual bus
+ *  - the vga output is sampled at every clk_25M edge into 640x480
+ *    frames, aligned on the falling edges of hsync/vsync
+ *  - a few scenes (boot, game art, frame buffer drawing, sprites at
+ *    the edges) are compared pixel by pixel with SimVideo, the
+ *    reference compositor of the host simulation; --png writes both
+ *    images of each scene
+ *  - the reference starts from the bitstream contents of the rams;
+ *    words of a .mem file wider than its ram (goalpost_map.mem) are
+ *    cut to the ram width by $readmemh and by SimVideo::load_rams
+ *  - the powerup core sits in video slot 8, so the slot decode of
+ *    chu_video_controller.sv must be 4 bits wide
+ *  - --frames N: benchmark, moves the sprites once per vblank for N
+ *    frames and prints simulated frames and sys clocks per second
+ *
+ * Build and run (Verilator 5, sim/vtb/Makefile; separate program, not
+ * part of the game):
+ *   make -C sim/vtb [THREADS=N]    build obj_dir_t<N>/vtb_video
+ *   make -C sim/vtb run            scenes, output in vtb_video.log
+ *   make -C sim/vtb bench [THREADS=N] [FRAMES=N]
+ *                                  frames/s per model, vtb_bench.log
+ *  - the Makefile holds the verilator line: RTL of vtb_top.sv and
+ *    the video half of Hardware/, the drivers above, sim_bus.cpp and
+ *    sim_video.cpp, built as gnu++14 (verilated code needs C++14)
+ *  - bram_fifo_fpro.sv of sim/vtb replaces the one in Hardware/,
+ *    which instantiates the Xilinx FIFO_DUALCLOCK_MACRO
+ *  - THREADS=N passes --threads N to verilator (default 1); the
+ *    design is small, so more than 2-4 threads rarely pays off
+ *  - runs from Hardware/ (the rams $readmem their .mem files from the
+ *    working directory)
+ *  - exit status 1 if a scene differs from the reference or the sync
+ *    pulses are not where vga_sync.sv puts them
+ *
+ * Options:
+ *   --hw DIR      .mem files for the reference (default .)
+ *   --png DIR     write <scene>_rtl.png and <scene>_ref.png
+ *   --frames N    benchmark frames (default 60; 0: none)
+ *
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "verilated.h"
+#include "Vvtb_top.h"
+#include "vga_core.h"
+#include "raster.h"
+#include "osd_canvas.h"
+#include "rle_sprite.h"
+#include "sprite_art.h"
+#include "sim_bus.h"
+#include "sim_video.h"
+
+static const int ACCESS_CLKS = 10;       // sys clocks per io access
+static const int HALF_NS = 5;            // clk_sys: 100 MHz
+static const int H_TOTAL = 800, H_SYNC = 656;    // vga_sync.sv
+static const int V_TOTAL = 525, V_SYNC = 490;
+static const int W = SimVideo::W, H = SimVideo::H;
+static const uint32_t VIDEO_SPACE = 0x00800000;  // bridge: video + frame
+
+/**********************************************************************
+ * verilated design
+ *********************************************************************/
+static VerilatedContext *ctx;
+static Vvtb_top *top;
+static uint64_t sys_clks;
+static int hx, vy;                       // raster position of the output
+static bool h_seen, v_seen;
+static int prev_hs, prev_vs;
+static uint32_t sync_errors;
+static uint64_t frames_done;
+static uint16_t scan[W * H];             // frame being captured
+static uint16_t shot[W * H];             // last complete frame
+
+// sample the vga output at a clk_25M rising edge
+static void vga_sample() {
+   int hs = top->hsync, vs = top->vsync;
+
+   if (prev_hs && !hs) {                 // hsync falls at x = H_SYNC
+      if (h_seen && hx != H_SYNC)
+         sync_errors++;
+      hx = H_SYNC;
+      h_seen = true;
+   }
+   if (prev_vs && !vs) {                 // vsync falls at line V_SYNC
+      if (v_seen && vy != V_SYNC)
+         sync_errors++;
+      vy = V_SYNC;
+      v_seen = true;
+   }
+   prev_hs = hs;
+   prev_vs = vs;
+   if (h_seen && v_seen && hx < W && vy < H) {
+      scan[vy * W + hx] = (uint16_t) top->rgb;
+      if (hx == W - 1 && vy == H - 1) {
+         memcpy(shot, scan, sizeof(shot));
+         frames_done++;
+      }
+   }
+   if (++hx == H_TOTAL) {
+      hx = 0;
+      if (++vy == V_TOTAL)
+         vy = 0;
+   }
+}
+
+// one clk_sys period; clk_25M follows every 4th one
+static void clock_sys() {
+   int phase = (int) (sys_clks & 3);
+
+   top->clk_sys = 1;
+   if (phase == 0)
+      top->clk_25M = 1;
+   if (phase == 2)
+      top->clk_25M = 0;
+   top->eval();
+   ctx->timeInc(HALF_NS);
+   if (phase == 0)
+      vga_sample();
+   top->clk_sys = 0;
+   top->eval();
+   ctx->timeInc(HALF_NS);
+   sys_clks++;
+}
+
+// built on the first access: driver constructors write the cores
+// during static initialization, before main()
+static Vvtb_top *dut() {
+   int i;
+
+   if (top)
+      return (top);
+   ctx = new VerilatedContext;
+   top = new Vvtb_top(ctx);
+   top->reset_sys = 1;
+   top->io_read_strobe = 0;
+   top->io_write_strobe = 0;
+   for (i = 0; i < 16; i++)
+      clock_sys();
+   top->reset_sys = 0;
+   clock_sys();
+   sim_bus().set_cost(ACCESS_CLKS, 0);
+   return (top);
+}
+
+// one strobe cycle, then idle to ACCESS_CLKS; returns the read data
+// sampled while the strobe is high
+static uint32_t io_cycle(uint32_t addr, uint32_t data, bool wr) {
+   uint32_t rd;
+   int i;
+
+   dut();
+   top->io_address = addr;
+   top->io_write_data = data;
+   top->io_write_strobe = wr;
+   top->io_read_strobe = !wr;
+   top->eval();
+   rd = top->io_read_data;
+   clock_sys();
+   top->io_write_strobe = 0;
+   top->io_read_strobe = 0;
+   for (i = 1; i < ACCESS_CLKS; i++)
+      clock_sys();
+   return (rd);
+}
+
+static bool video_addr(uint32_t addr) {
+   return (((addr - BRIDGE_BASE) & VIDEO_SPACE) != 0);
+}
+
+uint32_t vtb_io_read(uint32_t addr) {
+   uint32_t rd = io_cycle(addr, 0, false);
+   uint32_t model = sim_bus().read(addr);
+
+   return (video_addr(addr) ? rd : model);
+}
+
+void vtb_io_write(uint32_t addr, uint32_t data) {
+   io_cycle(addr, data, true);
+   sim_bus().write(addr, data);
+}
+
+// idle time, in whole microseconds so the virtual bus keeps up
+static void idle_frames(int n) {
+   uint64_t end = frames_done + n;
+   int i;
+
+   dut();
+   while (frames_done < end) {
+      for (i = 0; i < SYS_CLK_FREQ; i++)
+         clock_sys();
+      sim_bus().advance_us(1);
+   }
+}
+
+/**********************************************************************
+ * drivers (as instantiated by main_big_head_soccer.cpp)
+ *********************************************************************/
+static SpriteCore player1(get_sprite_addr(BRIDGE_BASE, V3_PLAYER1), 1024);
+static SpriteCore player2(get_sprite_addr(BRIDGE_BASE, V4_PLAYER2), 1024);
+static SpriteCore ball(get_sprite_addr(BRIDGE_BASE, V2_BALL), 256);
+static SpriteCore goalpost1(get_sprite_addr(BRIDGE_BASE, V6_GOALPOST1), 512);
+static SpriteCore goalpost2(get_sprite_addr(BRIDGE_BASE, V5_GOALPOST2), 512);
+static SpriteCore powerup(get_sprite_addr(BRIDGE_BASE, V8_POWERUP), 256);
+static GpvCore bar(get_sprite_addr(BRIDGE_BASE, V7_BAR));
+static OsdCore osd(get_sprite_addr(BRIDGE_BASE, V1_OSD));
+static OsdCanvas hud(&osd);
+static SyncCore vsync(get_sprite_addr(BRIDGE_BASE, V0_SYNC));
+static FrameCore frame(FRAME_BASE);
+static Raster raster(&frame);
+
+/**********************************************************************
+ * scenes
+ *********************************************************************/
+static const char *png_dir = 0;
+static int failed = 0;
+
+// compare the next complete frame with the reference
+static void check(const char *name, SimVideo &ref) {
+   char path[256];
+   const uint16_t *p;
+   int i, diff = 0, first = -1;
+
+   idle_frames(2);         // the first may have started before the writes
+   ref.render();
+   p = ref.pixels();
+   for (i = 0; i < W * H; i++) {
+      if (shot[i] != p[i]) {
+         if (first < 0)
+            first = i;
+         diff++;
+      }
+   }
+   printf("%-8s %6d pixels differ", name, diff);
+   if (first >= 0)
+      printf(" (first at %d,%d: rtl %03x, ref %03x)", first % W, first / W,
+            shot[first], p[first]);
+   printf("\n");
+   if (png_dir) {
+      snprintf(path, sizeof(path), "%s/%s_rtl.png", png_dir, name);
+      SimVideo::write_png(path, shot);
+      snprintf(path, sizeof(path), "%s/%s_ref.png", png_dir, name);
+      ref.write_png(path);
+   }
+   if (diff)
+      failed++;
+}
+
+static void scene_game() {
+   rle_upload(&ball, BALL_ART);
+   rle_upload(&goalpost1, GOALPOST_ART);
+   rle_upload(&goalpost2, GOALPOST_ART);
+   rle_upload(&player1, PLAYER1_ART);
+   rle_upload(&player2, PLAYER2_ART);
+   rle_upload(&powerup, POWERUP_ART);
+   bar.bypass(0);
+   frame.bypass(1);
+   goalpost1.move_xy(0, 336);
+   goalpost2.move_xy(616, 336);
+   player1.move_xy(120, 384);
+   player2.move_xy(480, 384);
+   ball.move_xy(312, 200);
+   powerup.move_xy(300, 96);
+   osd.set_color(0xfff, 0);
+   hud.clear();
+   hud.put_str(30, 1, "P1");
+   hud.put_uint(33, 1, 3, 2, '0');
+   hud.put_str(36, 1, "-");
+   hud.put_uint(38, 1, 12, 2, '0');
+   hud.put_str(41, 1, "P2");
+   hud.put_mmss(37, 3, 83);
+   hud.flush();
+}
+
+static void scene_pitch() {
+   static const uint32_t flag[8 * 8] = {
+      0x1c0, 0x1c0, 0x1c0, 0x1c0, 0x007, 0x007, 0x007, 0x007,
+      0x1c0, 0x000, 0x000, 0x1c0, 0x007, 0x000, 0x000, 0x007,
+      0x1c0, 0x000, 0x000, 0x1c0, 0x007, 0x000, 0x000, 0x007,
+      0x1c0, 0x1c0, 0x1c0, 0x1c0, 0x007, 0x007, 0x007, 0x007,
+      0x038, 0x038, 0x038, 0x038, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+      0x038, 0x000, 0x000, 0x038, 0x1ff, 0x000, 0x000, 0x1ff,
+      0x038, 0x000, 0x000, 0x038, 0x1ff, 0x000, 0x000, 0x1ff,
+      0x038, 0x038, 0x038, 0x038, 0x1ff, 0x1ff, 0x1ff, 0x1ff
+   };
+   int i;
+
+   bar.bypass(1);
+   frame.bypass(0);
+   raster.clear(frame_color(0x060));
+   for (i = 0; i < 8; i++)
+      raster.fill_rect(i * 80, 0, 40, 480, frame_color(0x080));
+   raster.rect(8, 8, 624, 464, frame_color(0xfff));
+   raster.vspan(320, 8, 464, frame_color(0xfff));
+   raster.fill_circle(320, 240, 48, frame_color(0xfff));
+   raster.fill_circle(320, 240, 46, frame_color(0x060));
+   raster.blit(100, 100, flag, 8, 8);
+   raster.blit(120, 100, flag, 8, 8, 0);
+   frame.plot_line(0, 479, 639, 0, frame_color(0xf00));
+   player1.wr_ctrl(2);                     // kick frame
+   osd.set_color(0xff0, 0x008);
+   osd.wr_char(2, 28, 'R', 1);
+   osd.wr_char(3, 28, 'T', 0);
+   osd.wr_char(4, 28, 'L', 1);
+}
+
+static void scene_edges() {
+   ball.move_xy(632, 472);                 // clipped at the right/bottom
+   player2.move_xy(620, 100);
+   player1.move_xy(-10, 200);              // negative: wraps off screen
+   goalpost1.move_xy(0, 450);
+   goalpost2.bypass(1);
+   powerup.move_xy(639, 479);
+   osd.bypass(1);
+}
+
+/**********************************************************************
+ * benchmark
+ *********************************************************************/
+static double seconds() {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (t.tv_sec + t.tv_nsec * 1e-9);
+}
+
+static void bench(int frames) {
+   uint64_t f0 = frames_done, c0 = sys_clks;
+   double t0 = seconds(), dt;
+   int i, x = 0;
+
+   vsync.start();
+   for (i = 0; i < frames; i++) {
+      vsync.wait_vblank(0);
+      x = (x + 4) % W;
+      ball.move_xy(x, 200 + (x & 63));
+      player1.move_xy(W - x, 384);
+      player2.move_xy(x / 2, 384);
+   }
+   dt = seconds() - t0;
+   printf("%d frames in %.2f s (%d model threads): %.1f frames/s, %.2f M sys clocks/s\n",
+         (int) (frames_done - f0), dt, (int) ctx->threads(),
+         (frames_done - f0) / dt, (sys_clks - c0) / dt * 1e-6);
+}
+
+int main(int argc, char **argv) {
+   const char *hw_dir = ".";
+   char path[256];
+   int i, frames = 60;
+
+   for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "--hw") == 0 && i + 1 < argc)
+         hw_dir = argv[++i];
+      else if (strcmp(argv[i], "--png") == 0 && i + 1 < argc)
+         png_dir = argv[++i];
+      else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+         frames = atoi(argv[++i]);
+   }
+   dut();
+   ctx->commandArgs(argc, argv);
+
+   // the reference starts from the same bitstream contents
+   SimVideo ref(&sim_bus());
+   snprintf(path, sizeof(path), "%s/font.mem", hw_dir);
+   if (!ref.load_font(path) || SimVideo::load_rams(&sim_bus(), hw_dir) == 0) {
+      printf("cannot read the .mem files in %s\n", hw_dir);
+      return (1);
+   }
+
+   check("boot", ref);
+   scene_game();
+   check("game", ref);
+   scene_pitch();
+   check("pitch", ref);
+   scene_edges();
+   check("edges", ref);
+   if (frames > 0)
+      bench(frames);
+   if (sync_errors)
+      printf("%u sync pulses out of place\n", (unsigned) sync_errors);
+   top->final();
+   delete top;
+   delete ctx;
+   return ((failed > 0 || sync_errors > 0) ? 1 : 0);
+}
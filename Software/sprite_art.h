@@ -0,0 +1,160 @@
+/*****************************************************************//**
+ * @file sprite_art.h
+ *
+ * @brief sprite art as run-length-encoded arrays (see rle_sprite.h)
+ *
+ * Generated by sim/mem2rle from the .mem files in Hardware/; do not edit.
+ *
+ ********************************************************************/
+
+#ifndef _SPRITE_ART_H_INCLUDED
+#define _SPRITE_ART_H_INCLUDED
+
+#include "rle_sprite.h"
+
+/* ../Hardware/player1_map.mem: 2048 pixels, 518 run bytes */
+constexpr uint8_t PLAYER1_RLE[] = {
+   0x78, 0x51, 0x50, 0x51, 0x0b, 0x0c, 0x23, 0x01, 0x50, 0x01, 0x04, 0x0b,
+   0x04, 0x13, 0x04, 0x1b, 0x04, 0x2b, 0x01, 0x40, 0x11, 0x13, 0x04, 0x13,
+   0x04, 0x13, 0x0c, 0x23, 0x0c, 0x09, 0x30, 0x01, 0x04, 0x13, 0x0c, 0x13,
+   0x04, 0x0b, 0x0c, 0x2b, 0x0c, 0x03, 0x01, 0x20, 0x11, 0x04, 0x13, 0x0c,
+   0x0b, 0x0c, 0x0b, 0x0c, 0x23, 0x0c, 0x0b, 0x09, 0x18, 0x01, 0x03, 0x0c,
+   0x13, 0x04, 0x5d, 0x0b, 0x0c, 0x13, 0x01, 0x18, 0x01, 0x03, 0x04, 0xa5,
+   0x13, 0x01, 0x08, 0x11, 0xb5, 0x13, 0x19, 0x25, 0x31, 0x2d, 0x31, 0x25,
+   0x09, 0x0c, 0x15, 0x01, 0x0a, 0x0c, 0x02, 0x01, 0x2d, 0x01, 0x02, 0x0c,
+   0x0a, 0x01, 0x15, 0x0c, 0x11, 0x04, 0x15, 0x09, 0x02, 0x0c, 0x02, 0x01,
+   0x2d, 0x01, 0x02, 0x0c, 0x02, 0x09, 0x15, 0x04, 0x09, 0x00, 0x09, 0x1d,
+   0x29, 0x15, 0x01, 0x0d, 0x29, 0x1d, 0x09, 0x10, 0x01, 0x65, 0x01, 0x5d,
+   0x01, 0x18, 0x01, 0x55, 0x11, 0x5d, 0x01, 0x18, 0x01, 0xcd, 0x01, 0x18,
+   0x01, 0xcd, 0x01, 0x18, 0x09, 0x35, 0x01, 0x3d, 0x01, 0x35, 0x09, 0x20,
+   0x01, 0x35, 0x49, 0x35, 0x01, 0x28, 0x19, 0x8d, 0x19, 0x40, 0x19, 0x5d,
+   0x19, 0x70, 0x01, 0x5d, 0x01, 0x88, 0x09, 0x4d, 0x09, 0x90, 0x59, 0x90,
+   0x09, 0x3e, 0x01, 0xa0, 0x01, 0x16, 0x19, 0x06, 0x09, 0xa0, 0x01, 0x2e,
+   0x01, 0x0e, 0x21, 0x80, 0x01, 0x26, 0x01, 0x16, 0x01, 0x06, 0x01, 0x06,
+   0x11, 0x70, 0x01, 0x1e, 0x01, 0x4e, 0x01, 0x70, 0x01, 0x16, 0x01, 0x56,
+   0x01, 0x70, 0x81, 0x70, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00,
+   0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0xa8, 0x51, 0x50,
+   0x51, 0x1b, 0x0e, 0x13, 0x01, 0x50, 0x01, 0x13, 0x06, 0x13, 0x06, 0x03,
+   0x0e, 0x1b, 0x06, 0x13, 0x09, 0x38, 0x11, 0x13, 0x06, 0x13, 0x06, 0x0b,
+   0x06, 0x1b, 0x06, 0x13, 0x06, 0x09, 0x30, 0x01, 0x1b, 0x0e, 0x0b, 0x0e,
+   0x0b, 0x06, 0x1b, 0x06, 0x13, 0x06, 0x09, 0x20, 0x11, 0x1b, 0x06, 0x13,
+   0x06, 0x13, 0x06, 0x1b, 0x06, 0x03, 0x01, 0x0e, 0x11, 0x18, 0x01, 0x03,
+   0x06, 0x1b, 0x06, 0x15, 0x06, 0x15, 0x06, 0x1d, 0x1e, 0x11, 0x06, 0x18,
+   0x01, 0x03, 0x1e, 0x05, 0x06, 0x15, 0x06, 0x15, 0x0e, 0x15, 0x0e, 0x0d,
+   0x09, 0x0e, 0x08, 0x09, 0x06, 0x1d, 0x06, 0x05, 0x06, 0x05, 0x0e, 0x25,
+   0x0e, 0x0d, 0x06, 0x1d, 0x0e, 0x19, 0x05, 0x16, 0x0d, 0x16, 0x01, 0x06,
+   0x01, 0x2d, 0x01, 0x06, 0x01, 0x06, 0x11, 0x05, 0x06, 0x15, 0x09, 0x0c,
+   0x05, 0x3e, 0x01, 0x2d, 0x01, 0x3e, 0x05, 0x0c, 0x11, 0x04, 0x15, 0x09,
+   0x02, 0x0e, 0x02, 0x01, 0x2d, 0x01, 0x02, 0x0e, 0x02, 0x09, 0x15, 0x04,
+   0x09, 0x00, 0x09, 0x1d, 0x29, 0x15, 0x01, 0x0d, 0x29, 0x1d, 0x09, 0x10,
+   0x01, 0x65, 0x01, 0x5d, 0x01, 0x18, 0x01, 0x55, 0x11, 0x5d, 0x01, 0x18,
+   0x01, 0xcd, 0x01, 0x18, 0x01, 0xcd, 0x01, 0x18, 0x09, 0xbd, 0x09, 0x20,
+   0x01, 0x2d, 0x59, 0x2d, 0x01, 0x28, 0x19, 0x15, 0x01, 0x4e, 0x01, 0x15,
+   0x19, 0x40, 0x19, 0x05, 0x49, 0x05, 0x19, 0x70, 0x01, 0x5d, 0x01, 0x88,
+   0x09, 0x4d, 0x09, 0x10, 0x29, 0x48, 0x81, 0x1e, 0x01, 0x48, 0x09, 0x4e,
+   0x01, 0x06, 0x01, 0x06, 0x01, 0x1e, 0x01, 0x50, 0x01, 0x4e, 0x01, 0x06,
+   0x01, 0x2e, 0x01, 0x50, 0x01, 0x16, 0x19, 0x4e, 0x11, 0x50, 0x09, 0x26,
+   0x01, 0x4e, 0x01, 0x00, 0x01, 0x58, 0x01, 0x1e, 0x01, 0x46, 0x11, 0x68,
+   0x01, 0x16, 0x01, 0x1e, 0x31, 0x00, 0x01, 0x68, 0x49, 0x00, 0x01, 0x00,
+   0x01, 0x00, 0x01, 0x78, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00,
+   0x01, 0x50
+};
+constexpr RleSprite PLAYER1_ART = { PLAYER1_RLE, 518, 2048 };
+
+/* ../Hardware/player2_map.mem: 2048 pixels, 595 run bytes */
+constexpr uint8_t PLAYER2_RLE[] = {
+   0x20, 0x51, 0xa0, 0x01, 0x13, 0x0d, 0x13, 0x05, 0x51, 0x48, 0x09, 0x0b,
+   0x0d, 0x1b, 0x0d, 0x23, 0x1d, 0x01, 0x40, 0x09, 0x13, 0x05, 0x23, 0x05,
+   0x23, 0x0d, 0x13, 0x11, 0x30, 0x01, 0x1b, 0x05, 0x23, 0x05, 0x23, 0x0d,
+   0x1b, 0x05, 0x01, 0x28, 0x09, 0x05, 0x03, 0x15, 0x23, 0x05, 0x23, 0x0d,
+   0x1b, 0x05, 0x11, 0x18, 0x01, 0x0d, 0x03, 0x0d, 0x0b, 0x5d, 0x13, 0x0d,
+   0x03, 0x05, 0x01, 0x18, 0x01, 0x05, 0x0b, 0x9d, 0x0b, 0x05, 0x01, 0x08,
+   0x11, 0xd5, 0x11, 0x25, 0x31, 0x2d, 0x31, 0x25, 0x09, 0x0c, 0x15, 0x01,
+   0x0a, 0x0c, 0x02, 0x01, 0x2d, 0x01, 0x02, 0x0c, 0x0a, 0x01, 0x15, 0x0c,
+   0x11, 0x04, 0x15, 0x09, 0x02, 0x0c, 0x02, 0x01, 0x2d, 0x01, 0x02, 0x0c,
+   0x02, 0x09, 0x15, 0x04, 0x09, 0x00, 0x09, 0x1d, 0x29, 0x0d, 0x01, 0x15,
+   0x29, 0x1d, 0x09, 0x10, 0x01, 0x5d, 0x01, 0x65, 0x01, 0x18, 0x01, 0x5d,
+   0x11, 0x55, 0x01, 0x18, 0x01, 0xcd, 0x01, 0x18, 0x01, 0xcd, 0x01, 0x18,
+   0x09, 0x2d, 0x01, 0x4d, 0x01, 0x2d, 0x09, 0x20, 0x01, 0x2d, 0x59, 0x2d,
+   0x01, 0x28, 0x19, 0x8d, 0x19, 0x40, 0x19, 0x5d, 0x19, 0x70, 0x01, 0x5d,
+   0x01, 0x88, 0x09, 0x4d, 0x09, 0x90, 0x59, 0xa8, 0x01, 0x02, 0x0e, 0x0a,
+   0x0e, 0x0a, 0x01, 0xa0, 0x09, 0x0e, 0x09, 0x0e, 0x0a, 0x01, 0x80, 0x29,
+   0x06, 0x01, 0x0a, 0x01, 0x06, 0x0a, 0x01, 0x70, 0x11, 0x02, 0x01, 0x06,
+   0x02, 0x01, 0x06, 0x01, 0x0a, 0x01, 0x06, 0x0a, 0x01, 0x70, 0x01, 0x06,
+   0x0a, 0x0e, 0x02, 0x01, 0x06, 0x01, 0x0a, 0x01, 0x06, 0x0a, 0x01, 0x70,
+   0x01, 0x06, 0x0a, 0x0e, 0x02, 0x01, 0x0e, 0x09, 0x0e, 0x0a, 0x01, 0x70,
+   0x81, 0x70, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00,
+   0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x68, 0x51, 0xa0, 0x01, 0x13,
+   0x0e, 0x1b, 0x51, 0x48, 0x09, 0x13, 0x06, 0x1b, 0x0e, 0x03, 0x06, 0x13,
+   0x06, 0x13, 0x01, 0x40, 0x09, 0x06, 0x13, 0x06, 0x1b, 0x06, 0x0b, 0x06,
+   0x13, 0x06, 0x13, 0x11, 0x30, 0x01, 0x03, 0x06, 0x13, 0x06, 0x1b, 0x06,
+   0x0b, 0x0e, 0x0b, 0x0e, 0x1b, 0x01, 0x28, 0x09, 0x03, 0x0e, 0x03, 0x0e,
+   0x1b, 0x06, 0x13, 0x06, 0x13, 0x06, 0x1b, 0x11, 0x18, 0x06, 0x13, 0x16,
+   0x03, 0x1d, 0x06, 0x15, 0x06, 0x15, 0x06, 0x1b, 0x06, 0x03, 0x01, 0x18,
+   0x0e, 0x0b, 0x0d, 0x0e, 0x15, 0x0e, 0x15, 0x06, 0x15, 0x06, 0x05, 0x1e,
+   0x03, 0x01, 0x08, 0x11, 0x0e, 0x1d, 0x06, 0x0d, 0x0e, 0x25, 0x0e, 0x05,
+   0x06, 0x05, 0x06, 0x1d, 0x06, 0x11, 0x15, 0x06, 0x05, 0x11, 0x06, 0x01,
+   0x06, 0x01, 0x2d, 0x01, 0x06, 0x01, 0x1e, 0x05, 0x16, 0x05, 0x09, 0x0c,
+   0x05, 0x3e, 0x01, 0x2d, 0x01, 0x1e, 0x02, 0x16, 0x05, 0x0c, 0x11, 0x04,
+   0x15, 0x09, 0x02, 0x0e, 0x02, 0x01, 0x2d, 0x01, 0x02, 0x0e, 0x02, 0x09,
+   0x15, 0x04, 0x09, 0x00, 0x09, 0x1d, 0x29, 0x0d, 0x01, 0x15, 0x29, 0x1d,
+   0x09, 0x10, 0x01, 0x5d, 0x01, 0x65, 0x01, 0x18, 0x01, 0x5d, 0x11, 0x55,
+   0x01, 0x18, 0x01, 0xcd, 0x01, 0x18, 0x01, 0xcd, 0x01, 0x18, 0x09, 0xbd,
+   0x09, 0x20, 0x01, 0x2d, 0x59, 0x2d, 0x01, 0x28, 0x19, 0x15, 0x01, 0x4a,
+   0x01, 0x15, 0x19, 0x40, 0x19, 0x05, 0x49, 0x05, 0x19, 0x70, 0x01, 0x5d,
+   0x01, 0x40, 0x29, 0x10, 0x09, 0x4d, 0x09, 0x40, 0x01, 0x0a, 0x06, 0x02,
+   0x81, 0x48, 0x01, 0x0a, 0x06, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x0e,
+   0x0a, 0x0e, 0x0a, 0x0e, 0x02, 0x01, 0x48, 0x01, 0x0a, 0x06, 0x0a, 0x06,
+   0x01, 0x02, 0x01, 0x0e, 0x02, 0x01, 0x0e, 0x09, 0x0e, 0x02, 0x01, 0x48,
+   0x11, 0x06, 0x0a, 0x0e, 0x0a, 0x0e, 0x02, 0x01, 0x06, 0x01, 0x0a, 0x01,
+   0x06, 0x02, 0x01, 0x48, 0x01, 0x00, 0x01, 0x06, 0x0a, 0x0e, 0x0a, 0x0e,
+   0x02, 0x01, 0x06, 0x01, 0x00, 0x02, 0x01, 0x06, 0x02, 0x01, 0x58, 0x11,
+   0x02, 0x0e, 0x0a, 0x0e, 0x02, 0x01, 0x06, 0x01, 0x0a, 0x01, 0x06, 0x02,
+   0x01, 0x58, 0x01, 0x00, 0x31, 0x06, 0x02, 0x01, 0x0e, 0x09, 0x0e, 0x09,
+   0x68, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x51, 0xa8, 0x01, 0x00, 0x01,
+   0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x58
+};
+constexpr RleSprite PLAYER2_ART = { PLAYER2_RLE, 595, 2048 };
+
+/* ../Hardware/soccerball.mem: 256 pixels, 75 run bytes */
+constexpr uint8_t BALL_RLE[] = {
+   0x18, 0x3a, 0x38, 0x3a, 0x28, 0x0a, 0x09, 0x1a, 0x09, 0x0a, 0x18, 0x0a,
+   0x09, 0x1a, 0x09, 0x0a, 0x08, 0x0a, 0x09, 0x0a, 0x19, 0x0a, 0x09, 0x1a,
+   0x09, 0x0a, 0x19, 0x0a, 0x09, 0x2a, 0x09, 0x1b, 0x09, 0x3a, 0x09, 0x1b,
+   0x09, 0x3a, 0x09, 0x1b, 0x09, 0x3a, 0x09, 0x1b, 0x09, 0x2a, 0x09, 0x0a,
+   0x19, 0x0a, 0x09, 0x1a, 0x09, 0x0a, 0x19, 0x0a, 0x09, 0x0a, 0x08, 0x0a,
+   0x09, 0x1a, 0x09, 0x0a, 0x18, 0x0a, 0x09, 0x1a, 0x09, 0x0a, 0x28, 0x3a,
+   0x38, 0x3a, 0x18
+};
+constexpr RleSprite BALL_ART = { BALL_RLE, 75, 256 };
+
+/* ../Hardware/powerup_map.mem: 256 pixels, 55 run bytes */
+constexpr uint8_t POWERUP_RLE[] = {
+   0x81, 0x6a, 0x09, 0x1a, 0x23, 0x22, 0x09, 0x12, 0x3b, 0x12, 0x09, 0x0a,
+   0x0b, 0x22, 0x0b, 0x12, 0x09, 0x0a, 0x0b, 0x22, 0x0b, 0x12, 0x09, 0x42,
+   0x0b, 0x12, 0x09, 0x32, 0x1b, 0x12, 0x09, 0x2a, 0x1b, 0x1a, 0x09, 0x2a,
+   0x0b, 0x2a, 0x09, 0x2a, 0x0b, 0x2a, 0x09, 0x6a, 0x09, 0x2a, 0x0b, 0x2a,
+   0x09, 0x2a, 0x0b, 0x2a, 0x09, 0x6a, 0x81
+};
+constexpr RleSprite POWERUP_ART = { POWERUP_RLE, 55, 256 };
+
+/* ../Hardware/goalpost_map.mem: 640 pixels, 157 run bytes */
+constexpr uint8_t GOALPOST_RLE[] = {
+   0x41, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a, 0x09, 0x2a,
+   0x41
+};
+constexpr RleSprite GOALPOST_ART = { GOALPOST_RLE, 157, 640 };
+
+#endif  // _SPRITE_ART_H_INCLUDED
@@ -0,0 +1,108 @@
+/*****************************************************************//**
+ * @file tick_div.h
+ *
+ * @brief division-free conversion of timer ticks to us/ms
+ *
+ * Description:
+ *  - RecipDiv<D>::div(x) = floor(x / D) for a 32-bit x, computed as
+ *    (x * MUL) >> SHIFT; MUL/SHIFT are derived from D at compile time
+ *  - the pair is accepted only if 2^SHIFT <= MUL*D <= 2^SHIFT + 2^(SHIFT-32)
+ *    (Granlund-Montgomery bound); then the result equals exact division
+ *    for every one of the 2^32 inputs, checked by the compiler
+ *  - RecipDiv<D>::div64(x) splits a wider dividend into 32-bit halves:
+ *    with x = hi*2^32 + lo and 2^32 = D*Q + R,
+ *    x / D = hi*Q + lo/D + (hi*R + lo%D)/D;
+ *    exact as long as hi <= MAX_HI (last dividend below 2^32)
+ *  - TickToUs (D = SYS_CLK_FREQ) and UsToMs (D = 1000) cover the
+ *    48-bit timer counter
+ *
+ ********************************************************************/
+
+#ifndef _TICK_DIV_H_INCLUDED
+#define _TICK_DIV_H_INCLUDED
+
+#include <inttypes.h>
+#include "chu_io_map.h"      /* to obtain system clock rate  */
+
+/**
+ * reciprocal ceil(2^s / d)
+ */
+constexpr uint64_t recip_mul(uint32_t d, int s) {
+   return ((((uint64_t) 1 << s) + d - 1) / d);
+}
+
+/**
+ * true if (x * recip_mul(d, s)) >> s is exact for all 32-bit x
+ */
+constexpr bool recip_exact(uint32_t d, int s) {
+   return (recip_mul(d, s) * d - ((uint64_t) 1 << s) <= ((uint64_t) 1 << (s - 32)));
+}
+
+/**
+ * smallest shift (from s up) with an exact 32-bit reciprocal
+ * @return shift; -1 if the reciprocal needs 33 bits
+ */
+constexpr int recip_shift(uint32_t d, int s) {
+   return (s > 63 || recip_mul(d, s) > 0xffffffffULL) ? -1 :
+          recip_exact(d, s) ? s : recip_shift(d, s + 1);
+}
+
+/**
+ * exact unsigned division by the constant D without a divide
+ *
+ */
+template<uint32_t D>
+struct RecipDiv {
+   static constexpr int SHIFT = recip_shift(D, 32);
+   static constexpr uint32_t MUL = (uint32_t) recip_mul(D, (SHIFT < 0) ? 32 : SHIFT);
+   static constexpr uint32_t Q = (uint32_t) (((uint64_t) 1 << 32) / D);
+   static constexpr uint32_t R = (uint32_t) (((uint64_t) 1 << 32) % D);
+   /* largest upper word accepted by div64() */
+   static constexpr uint32_t MAX_HI = (R == 0) ? 0xffffffffUL : (0xffffffffUL - (D - 1)) / R;
+
+   static_assert(SHIFT > 0, "divisor has no 32-bit reciprocal");
+
+   /**
+    * floor(x / D)
+    * @param x 32-bit dividend
+    */
+   static inline uint32_t div(uint32_t x) {
+      return ((uint32_t) (((uint64_t) x * MUL) >> SHIFT));
+   }
+
+   /**
+    * floor(x / D)
+    * @param x dividend; upper word at most MAX_HI
+    */
+   static inline uint64_t div64(uint64_t x) {
+      uint32_t hi = (uint32_t) (x >> 32);
+      uint32_t lo = (uint32_t) x;
+      uint32_t q = div(lo);
+
+      return ((uint64_t) hi * Q + q + div(hi * R + (lo - q * D)));
+   }
+};
+
+typedef RecipDiv<SYS_CLK_FREQ> TickToUs;
+typedef RecipDiv<1000> UsToMs;
+
+/* the timer counter is 48 bits; microseconds fit in 42 bits */
+static_assert(TickToUs::MAX_HI >= 0xffff, "48-bit tick count out of range");
+static_assert(UsToMs::MAX_HI >= (0xffffUL / SYS_CLK_FREQ) + 1, "us count out of range");
+
+/**
+ * convert a 32-bit tick count (or tick difference) to microseconds
+ */
+static inline uint32_t ticks_to_us(uint32_t t) {
+   return (TickToUs::div(t));
+}
+
+/**
+ * convert microseconds to ticks
+ * @note the result wraps above 2^32 ticks (~42 s at 100 MHz)
+ */
+static inline uint32_t us_to_ticks(uint32_t us) {
+   return (us * SYS_CLK_FREQ);
+}
+
+#endif  // _TICK_DIV_H_INCLUDED
@@ -8,6 +8,7 @@
  ********************************************************************/
 
 #include "timer_core.h"
+#include "tick_div.h"
 
 TimerCore::TimerCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
@@ -41,24 +42,40 @@ void TimerCore::clear() {
 }
 
 uint64_t TimerCore::read_tick() {
-   uint64_t upper, lower;
+   uint32_t upper, lower;
 
-   lower = (uint64_t) io_read(base_addr, COUNTER_LOWER_REG);
-   upper = (uint64_t) io_read(base_addr, COUNTER_UPPER_REG);
-   return ((upper << 32) | lower);
+   // retry if the lower word rolled over between the upper reads
+   do {
+      upper = io_read(base_addr, COUNTER_UPPER_REG);
+      lower = io_read(base_addr, COUNTER_LOWER_REG);
+   } while (io_read(base_addr, COUNTER_UPPER_REG) != upper);
+   return (((uint64_t) upper << 32) | lower);
+}
+
+uint32_t TimerCore::read_tick32() {
+   return (io_read(base_addr, COUNTER_LOWER_REG));
 }
 
 uint64_t TimerCore::read_time() {
    // elapsed time in microsecond (SYS_CLK_FREQ in MHz)
-   return (read_tick() / SYS_CLK_FREQ);
+   return (TickToUs::div64(read_tick()));
 }
 
 void TimerCore::sleep(uint64_t us) {
-   uint64_t start_time, now;
+   uint64_t start_tick, ticks;
+   uint32_t start32;
 
-   start_time = read_time();
+   // compare clock ticks; no division in the polling loop
+   ticks = us * SYS_CLK_FREQ;
+   if (ticks <= 0xffffffffULL) {
+      // 32-bit wrap-safe difference: one bus read per poll
+      start32 = read_tick32();
+      while ((uint32_t) (read_tick32() - start32) < (uint32_t) ticks) {
+      }
+      return;
+   }
+   start_tick = read_tick();
    // busy waiting
-   do {
-      now = read_time();
-   } while ((now - start_time) < us);
+   while ((read_tick() - start_tick) < ticks) {
+   }
 }
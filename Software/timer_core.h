@@ -69,13 +69,25 @@ public:
    /**
     * read current timing counter value (# clocks elapsed from last clear)
     *
+    * @note upper word is read before and after the lower word, so a
+    *  carry between the two reads cannot tear the 48-bit value
+    *
     */
    uint64_t read_tick();
 
+   /**
+    * read lower 32 bits of timing counter (single bus read)
+    *
+    * @note wraps every 2^32 clocks; use for differences only
+    *
+    */
+   uint32_t read_tick32();
+
    /**
     * read current time (microseconds elapsed from last clear)
     *
     * @note time is derived from SYS_CLK_FREQ in chu_io_map.h
+    *  by reciprocal multiplication (tick_div.h)
     *
     */
    uint64_t read_time();
@@ -23,6 +23,11 @@ void UartCore::set_baud_rate(int baud) {
 
    dvsr = SYS_CLK_FREQ*1000000 / 16 / baud - 1;
    io_write(base_addr, DVSR_REG, dvsr);
+   baud_rate = baud;
+}
+
+int UartCore::get_baud_rate() {
+   return (baud_rate);
 }
 
 int UartCore::rx_fifo_empty() {
@@ -57,6 +57,13 @@ public:
     */
    void set_baud_rate(int baud);
 
+   /**
+    * read the baud rate last set
+    *
+    * @return baud rate
+    */
+   int get_baud_rate();
+
    /**
     * check whether uart receiver fifo is empty
     *
@@ -22,10 +22,101 @@ void GpvCore::wr_mem(int addr, uint32_t data) {
    io_write(base_addr, addr, data);
 }
 
+void GpvCore::wr_mem_span(int addr, const uint32_t *data, int n) {
+   io_write_block(base_addr, addr, data, n);
+}
+
 void GpvCore::bypass(int by) {
    io_write(base_addr, BYPASS_REG, (uint32_t ) by);
 }
 
+/**********************************************************************
+ * Sync core methods
+ *********************************************************************/
+SyncCore::SyncCore(uint32_t core_base_addr) {
+   base_addr = core_base_addr;
+   last_frame = 0;
+   started = false;
+   n_frames = 0;
+   n_skipped = 0;
+}
+SyncCore::~SyncCore() {
+}
+
+uint32_t SyncCore::read_status() {
+   return (io_read(base_addr, STATUS_REG));
+}
+
+int SyncCore::vcount() {
+   return ((int) (read_status() & VCOUNT_FIELD));
+}
+
+bool SyncCore::in_vblank() {
+   return ((read_status() & VBLANK_FIELD) != 0);
+}
+
+uint16_t SyncCore::frame_count() {
+   return ((uint16_t) (read_status() >> FRAME_SHIFT));
+}
+
+bool SyncCore::probe() {
+   uint32_t s0, s1;
+   uint16_t diff;
+
+   s0 = read_status();
+   sleep_us(2 * FRAME_US);
+   s1 = read_status();
+   // 2 frames (3 if the first read was just before blanking)
+   diff = (uint16_t) ((s1 >> FRAME_SHIFT) - (s0 >> FRAME_SHIFT));
+   if (diff < 1 || diff > 3)
+      return (false);
+   return ((s1 & VCOUNT_FIELD) < V_TOTAL);
+}
+
+void SyncCore::start() {
+   started = false;
+   n_frames = 0;
+   n_skipped = 0;
+}
+
+void SyncCore::resync() {
+   started = false;
+}
+
+bool SyncCore::wait_vblank(void (*idle)()) {
+   uint32_t start = now_tick32();
+   uint32_t s;
+   uint16_t frame;
+   int line;
+
+   while (now_tick32() - start < 2 * FRAME_US * SYS_CLK_FREQ) {
+      s = read_status();
+      line = (int) (s & VCOUNT_FIELD);
+      frame = (uint16_t) (s >> FRAME_SHIFT);
+      if ((s & VBLANK_FIELD) && line < V_TOTAL - V_GUARD
+            && (!started || frame != last_frame)) {
+         if (started)
+            n_skipped += (uint16_t) (frame - last_frame - 1);
+         last_frame = frame;
+         started = true;
+         n_frames++;
+         return (true);
+      }
+      // idle only while the hook cannot run into the blanking window
+      if (idle && !(s & VBLANK_FIELD) && line < V_DISPLAY - IDLE_LINES)
+         idle();
+   }
+   return (false);
+}
+
+void SyncCore::report(UartCore *port) {
+   port->disp("vsync: frames ");
+   port->disp((int) n_frames);
+   port->disp(" skipped ");
+   port->disp((int) n_skipped);
+   port->disp("\n\r");
+}
+
 /**********************************************************************
  * Sprite core methods
  *********************************************************************/
@@ -40,6 +131,10 @@ void SpriteCore::wr_mem(int addr, uint32_t color) {
    io_write(base_addr, addr, color);
 }
 
+void SpriteCore::wr_mem_span(int addr, const uint32_t *data, int n) {
+   io_write_block(base_addr, addr, data, n);
+}
+
 void SpriteCore::bypass(int by) {
    io_write(base_addr, BYPASS_REG, (uint32_t ) by);
 }
@@ -54,12 +149,60 @@ void SpriteCore::wr_ctrl(int32_t cmd) {
    io_write(base_addr, SPRITE_CTRL_REG, cmd);
 }
 
+/**********************************************************************
+ * Sprite batch methods
+ *********************************************************************/
+SpriteBatch::SpriteBatch() {
+   n_entries = 0;
+}
+SpriteBatch::~SpriteBatch() {
+}
+
+void SpriteBatch::stage(SpriteCore *sprite, int x, int y) {
+   Entry *e;
+   int i;
+
+   for (i = 0; i < n_entries; i++) {
+      if (entry[i].sprite == sprite)
+         break;
+   }
+   if (i == n_entries) {
+      if (n_entries == MAX_SPRITES)
+         return;
+      entry[i].sprite = sprite;
+      entry[i].valid = false;
+      n_entries++;
+   }
+   e = &entry[i];
+   e->x = x;
+   e->y = y;
+}
+
+int SpriteBatch::commit() {
+   Entry *e;
+   int i, moved = 0;
+
+   for (i = 0; i < n_entries; i++) {
+      e = &entry[i];
+      if (e->valid && e->x == e->cx && e->y == e->cy)
+         continue;
+      e->sprite->move_xy(e->x, e->y);
+      e->cx = e->x;
+      e->cy = e->y;
+      e->valid = true;
+      moved++;
+   }
+   return (moved);
+}
+
 
 /**********************************************************************
  * OSD core methods
  *********************************************************************/
 OsdCore::OsdCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   tile_valid = 0;
+   fg_clr = bg_clr = 0xffffffff;  // force the first color write
    set_color(0x0f0, CHROMA_KEY_COLOR);  // green on black
 }
 OsdCore::~OsdCore() {
@@ -67,33 +210,79 @@ OsdCore::~OsdCore() {
 // not used
 
 void OsdCore::set_color(uint32_t fg_color, uint32_t bg_color) {
-   io_write(base_addr, FG_CLR_REG, fg_color);
-   io_write(base_addr, BG_CLR_REG, bg_color);
+   if (fg_color != fg_clr) {
+      io_write(base_addr, FG_CLR_REG, fg_color);
+      fg_clr = fg_color;
+   }
+   if (bg_color != bg_clr) {
+      io_write(base_addr, BG_CLR_REG, bg_color);
+      bg_clr = bg_color;
+   }
 }
 
 void OsdCore::wr_char(uint8_t x, uint8_t y, char ch, int reverse) {
    uint32_t ch_offset;
-   uint32_t data;
+   uint8_t data;
 
    ch_offset = (y << 7) + (x & 0x07f);   // offset is concatenation of y and x
    if (reverse == 1)
-      data = (uint32_t)(ch | 0x80);
+      data = (uint8_t)(ch | 0x80);
    else
-      data = (uint32_t) ch;
-   io_write(base_addr, ch_offset, data);
+      data = (uint8_t) ch;
+   // skip the bus write if the tile already holds this char
+   if (x < CHAR_X_MAX && y < CHAR_Y_MAX) {
+      if (tile_valid && tile[y][x] == data)
+         return;
+      tile[y][x] = data;
+   }
+   io_write(base_addr, ch_offset, (uint32_t) data);
    return;
 }
 
+void OsdCore::wr_span(uint8_t x, uint8_t y, const uint8_t *codes, int n) {
+   uint32_t row_offset;
+   int i;
+
+   if (x >= CHAR_X_MAX || y >= CHAR_Y_MAX)
+      return;
+   if (n > CHAR_X_MAX - x)
+      n = CHAR_X_MAX - x;
+   row_offset = (y << 7) + x;
+   for (i = 0; i < n; i++) {
+      if (tile_valid && tile[y][x + i] == codes[i])
+         continue;
+      tile[y][x + i] = codes[i];
+      io_write(base_addr, row_offset + i, (uint32_t) codes[i]);
+   }
+}
+
 void OsdCore::clr_screen() {
-   int x, y;
+   int x, y, first, last;
 
-   for (x = 0; x < CHAR_X_MAX; x++)
-      for (y = 0; y < CHAR_Y_MAX; y++) {
-         wr_char(x, y, NULL_CHAR);
+   for (y = 0; y < CHAR_Y_MAX; y++) {
+      // blank the span between the first and last non-blank tiles
+      first = 0;
+      last = CHAR_X_MAX - 1;
+      if (tile_valid) {
+         while (first < CHAR_X_MAX && tile[y][first] == NULL_CHAR)
+            first++;
+         while (last > first && tile[y][last] == NULL_CHAR)
+            last--;
       }
+      if (first >= CHAR_X_MAX)
+         continue;
+      io_fill_block(base_addr, (y << 7) + first, (uint32_t) NULL_CHAR, last - first + 1);
+      for (x = first; x <= last; x++)
+         tile[y][x] = NULL_CHAR;
+   }
+   tile_valid = 1;
    return;
 }
 
+void OsdCore::invalidate() {
+   tile_valid = 0;
+}
+
 void OsdCore::bypass(int by) {
    io_write(base_addr, BYPASS_REG, (uint32_t ) by);
 }
@@ -116,14 +305,16 @@ void FrameCore::wr_pix(int x, int y, int color) {
    return;
 }
 
-void FrameCore::clr_screen(int color) {
-   int x, y;
+void FrameCore::wr_pix_span(int x, int y, const uint32_t *data, int n) {
+   io_write_block(base_addr, HMAX * y + x, data, n);
+}
 
-   for (x = 0; x < HMAX; x++)
-      for (y = 0; y < VMAX; y++) {
-         wr_pix(x, y, color);
-      }
-   return;
+void FrameCore::wr_pix_fill(int x, int y, int color, int n) {
+   io_fill_block(base_addr, HMAX * y + x, (uint32_t) color, n);
+}
+
+void FrameCore::clr_screen(int color) {
+   io_fill_block(base_addr, 0, (uint32_t) color, HMAX * VMAX);
 }
 
 void FrameCore::bypass(int by) {
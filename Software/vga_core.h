@@ -41,6 +41,15 @@ public:
     */
    void wr_mem(int addr, uint32_t color);
 
+   /**
+    * write a block of 32-bit words to memory module of a video core
+    * @param addr offset address of the first word
+    * @param data source buffer
+    * @param n number of words
+    *
+    */
+   void wr_mem_span(int addr, const uint32_t *data, int n);
+
    /**
     * enable/disable core bypass
     * @param by 1: bypass current core; 0: not bypass
@@ -52,6 +61,122 @@ private:
    uint32_t base_addr;
 };
 
+/**********************************************************************
+ * Sync Core
+ *********************************************************************/
+/**
+ * vga sync core (video slot #0) status driver
+ *
+ * status register (read only):
+ *  - bit 10..0: raster line (0..V_TOTAL-1)
+ *  - bit 11: vertical blanking (line >= V_DISPLAY)
+ *  - bit 31..16: frame count, incremented when blanking starts
+ *
+ * @note the line buffer runs ~1.6 lines ahead of the raster, so the
+ *  first 2 lines of a frame are generated before blanking starts;
+ *  a write made in blanking shows from line 2 of the next frame
+ *
+ */
+class SyncCore {
+public:
+   /**
+    * register map
+    *
+    */
+   enum {
+      STATUS_REG = 0     /**< raster status register */
+   };
+   /**
+    * field masks and raster constants (640x480 at 25 MHz)
+    *
+    */
+   enum {
+      VCOUNT_FIELD = 0x000007ff,
+      VBLANK_FIELD = 0x00000800,
+      FRAME_SHIFT = 16,
+      V_DISPLAY = 480,   /**< visible lines */
+      V_TOTAL = 525,     /**< lines per frame */
+      V_GUARD = 2,       /**< lines kept free at the end of blanking */
+      IDLE_LINES = 32,   /**< no idle hook this close to blanking */
+      FRAME_US = 16800   /**< 800 x 525 pixels at 25 MHz */
+   };
+   /* methods */
+   SyncCore(uint32_t core_base_addr);
+   ~SyncCore();                  // not used
+
+   /**
+    * read the raw status register
+    * @return status word
+    */
+   uint32_t read_status();
+
+   /**
+    * current raster line
+    * @return line (0..V_TOTAL-1)
+    */
+   int vcount();
+
+   /**
+    * check vertical blanking
+    * @return true while the raster is in vertical blanking
+    */
+   bool in_vblank();
+
+   /**
+    * frame count (16-bit, wraps)
+    * @return number of vertical blanking periods started
+    */
+   uint16_t frame_count();
+
+   /**
+    * check that the status register is present and the raster runs
+    * @return true if the frame count advances at the frame rate
+    *
+    * @note takes about 2 frames; an older bitstream without the
+    *  status register fails the check
+    */
+   bool probe();
+
+   /**
+    * clear statistics and forget the last frame
+    */
+   void start();
+
+   /**
+    * forget the last frame (after a known stall such as a pause
+    * screen); statistics are kept
+    */
+   void resync();
+
+   /**
+    * wait for a vertical blanking period not yet returned
+    * @param idle hook called while waiting (0: none); not called
+    *        within IDLE_LINES of blanking so the window is not missed
+    * @return true in blanking with V_GUARD lines or more left;
+    *         false on a timeout (2 frames)
+    *
+    * @note frames skipped since the previous call are counted
+    */
+   bool wait_vblank(void (*idle)());
+
+   /* statistics */
+   uint32_t frames() const { return n_frames; }    /**< blanking waits met */
+   uint32_t skipped() const { return n_skipped; }  /**< frames passed over */
+
+   /**
+    * print frame/skip count over a uart core
+    * @param port uart core
+    */
+   void report(UartCore *port);
+
+private:
+   uint32_t base_addr;
+   uint16_t last_frame;   // frame count of the last wait_vblank()
+   bool started;
+   uint32_t n_frames;
+   uint32_t n_skipped;
+};
+
 /**********************************************************************
  * Sprite Core
  *********************************************************************/
@@ -93,6 +218,15 @@ public:
     */
    void wr_mem(int addr, uint32_t color);
 
+   /**
+    * write a block of 32-bit words to memory module of a video core
+    * @param addr offset address of the first word
+    * @param data source buffer
+    * @param n number of words
+    *
+    */
+   void wr_mem_span(int addr, const uint32_t *data, int n);
+
    /**
     * move sprite to a location
     * @param x x-coordinate of sprite origin
@@ -121,6 +255,56 @@ private:
    int size;   // sprite memory size
 };
 
+/**
+ * batched sprite position commit
+ *
+ *  - stage() records a position; commit() writes the staged positions
+ *    back to back, so a commit made in vertical blanking (see
+ *    SyncCore::wait_vblank()) moves all sprites on the same frame
+ *  - positions equal to the last committed one are not written
+ *
+ * @note all moves of a staged sprite must go through the batch
+ */
+class SpriteBatch {
+public:
+   /**
+    * symbolic constants
+    *
+    */
+   enum {
+      MAX_SPRITES = 8
+   };
+   /* methods */
+   SpriteBatch();
+   ~SpriteBatch();                  // not used
+
+   /**
+    * stage the position of a sprite
+    * @param sprite sprite core
+    * @param x x-coordinate of sprite origin
+    * @param y y-coordinate of sprite origin
+    *
+    * @note ignored when MAX_SPRITES other sprites are staged
+    */
+   void stage(SpriteCore *sprite, int x, int y);
+
+   /**
+    * write the staged positions that changed
+    * @return number of sprites moved
+    */
+   int commit();
+
+private:
+   struct Entry {
+      SpriteCore *sprite;
+      int x, y;           // staged
+      int cx, cy;         // committed
+      bool valid;         // cx/cy hold the register values
+   };
+   Entry entry[MAX_SPRITES];
+   int n_entries;
+};
+
 /**********************************************************************
  * OSD Core
  *********************************************************************/
@@ -177,12 +361,31 @@ public:
     */
    void wr_char(uint8_t x, uint8_t y, char ch, int reverse = 0);
 
+   /**
+    * write a run of tiles on one row
+    * @param x x-coordinate of the first tile
+    * @param y y-coordinate of the row
+    * @param codes tile codes (char, bit 7 set for reversed display)
+    * @param n number of tiles (clipped at CHAR_X_MAX)
+    *
+    * @note only tiles that differ from tile RAM are written
+    */
+   void wr_span(uint8_t x, uint8_t y, const uint8_t *codes, int n);
+
    /**
     * clear tile RAM (by writing NULL_CHAR to all tiles)
     *
+    * @note only tiles that are not already blank are written
     */
    void clr_screen();
 
+   /**
+    * forget the tile RAM shadow copy
+    *
+    * @note next clr_screen() rewrites every tile
+    */
+   void invalidate();
+
    /**
     * enable/disable core bypass
     * @param by 1: bypass current core; 0: not bypass
@@ -191,6 +394,10 @@ public:
    void bypass(int by);
 private:
    uint32_t base_addr;
+   uint32_t fg_clr, bg_clr;   // current color registers
+   /* shadow copy of tile RAM; MMIO writes are skipped for unchanged tiles */
+   uint8_t tile[CHAR_Y_MAX][CHAR_X_MAX];
+   int tile_valid;            // 0 until tile RAM content is known
 };
 
 /**********************************************************************
@@ -230,10 +437,33 @@ public:
     */
    void wr_pix(int x, int y, int color);
 
+   /**
+    * write a horizontal run of pixels
+    * @param x x-coordinate of the first pixel
+    * @param y y-coordinate of the row
+    * @param data pixel colors
+    * @param n number of pixels
+    *
+    */
+   void wr_pix_span(int x, int y, const uint32_t *data, int n);
+
+   /**
+    * write a run of pixels of one color
+    * @param x x-coordinate of the first pixel
+    * @param y y-coordinate of the row
+    * @param color pixel color
+    * @param n number of pixels
+    *
+    * @note rows are stored back to back (HMAX*y + x), so a run longer
+    *       than the rest of the row continues on the next rows
+    */
+   void wr_pix_fill(int x, int y, int color, int n);
+
    /**
     * clear frame buffer (fill the frame with a specific color)
     * @param color color to fill the frame
     *
+    * @note one block fill over the whole buffer, in address order
     */
    void clr_screen(int color);
 